@@ -0,0 +1,144 @@
+// Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
+
+#pragma once
+
+#include "core/error.hpp"
+
+namespace ionengine::core
+{
+    // Default allocator of make_ref
+    struct heap_allocator
+    {
+        auto allocate(size_t const size, size_t const alignment) -> void*
+        {
+            return ::operator new(size, std::align_val_t(alignment));
+        }
+
+        auto deallocate(void* ptr, size_t const size, size_t const alignment) -> void
+        {
+            ::operator delete(ptr, size, std::align_val_t(alignment));
+        }
+    };
+
+    // Free list of equally sized blocks, carved from chunks that are only returned on destruction. The block size is
+    // fixed by the first allocation, so one pool serves one type and larger requests throw. Allocation and
+    // deallocation may happen on different threads.
+    class pool_allocator
+    {
+      public:
+        pool_allocator(size_t const blocks_per_chunk = 64) : blocks_per_chunk(blocks_per_chunk)
+        {
+        }
+
+        ~pool_allocator()
+        {
+            for (auto const chunk : chunks)
+            {
+                ::operator delete(chunk, std::align_val_t(block_alignment));
+            }
+        }
+
+        pool_allocator(pool_allocator const&) = delete;
+
+        auto operator=(pool_allocator const&) -> pool_allocator& = delete;
+
+        auto allocate(size_t const size, size_t const alignment) -> void*
+        {
+            std::lock_guard lock(mutex);
+            if (block_size == 0)
+            {
+                block_alignment = std::max(alignment, alignof(free_block));
+                block_size = std::max(size, sizeof(free_block));
+                block_size = (block_size + block_alignment - 1) / block_alignment * block_alignment;
+            }
+            if (size > block_size || alignment > block_alignment)
+            {
+                throw core::runtime_error("Pool allocator block is smaller than the requested size");
+            }
+
+            if (!free_list)
+            {
+                auto const chunk = static_cast<std::byte*>(
+                    ::operator new(block_size * blocks_per_chunk, std::align_val_t(block_alignment)));
+                chunks.emplace_back(chunk);
+                for (size_t const i : std::views::iota(0u, blocks_per_chunk))
+                {
+                    free_list = new (chunk + i * block_size) free_block{.next = free_list};
+                }
+            }
+
+            free_block* const block = free_list;
+            free_list = block->next;
+            return block;
+        }
+
+        auto deallocate(void* ptr, size_t const, size_t const) -> void
+        {
+            std::lock_guard lock(mutex);
+            free_list = new (ptr) free_block{.next = free_list};
+        }
+
+      private:
+        struct free_block
+        {
+            free_block* next;
+        };
+
+        std::mutex mutex;
+        size_t blocks_per_chunk;
+        size_t block_size = 0;
+        size_t block_alignment = 0;
+        std::vector<std::byte*> chunks;
+        free_block* free_list = nullptr;
+    };
+
+    // Bump allocator for objects that live no longer than a frame. Deallocation only counts the objects still
+    // alive, the memory is reclaimed all at once by reset().
+    class frame_allocator
+    {
+      public:
+        frame_allocator(size_t const capacity) : capacity(capacity), offset(0), live_count(0)
+        {
+            buffer = static_cast<std::byte*>(::operator new(capacity, std::align_val_t(alignof(std::max_align_t))));
+        }
+
+        ~frame_allocator()
+        {
+            ::operator delete(buffer, std::align_val_t(alignof(std::max_align_t)));
+        }
+
+        frame_allocator(frame_allocator const&) = delete;
+
+        auto operator=(frame_allocator const&) -> frame_allocator& = delete;
+
+        auto allocate(size_t const size, size_t const alignment) -> void*
+        {
+            size_t const aligned_offset = (offset + alignment - 1) / alignment * alignment;
+            if (aligned_offset + size > capacity)
+            {
+                throw core::runtime_error("Frame allocator is out of memory");
+            }
+
+            offset = aligned_offset + size;
+            ++live_count;
+            return buffer + aligned_offset;
+        }
+
+        auto deallocate(void*, size_t const, size_t const) -> void
+        {
+            --live_count;
+        }
+
+        auto reset() -> void
+        {
+            assert(live_count == 0 && "objects allocated in the frame are still alive");
+            offset = 0;
+        }
+
+      private:
+        std::byte* buffer;
+        size_t capacity;
+        size_t offset;
+        size_t live_count;
+    };
+} // namespace ionengine::core
@@ -0,0 +1,237 @@
+// Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
+
+#pragma once
+
+namespace ionengine::core
+{
+    // Output stream buffer that hands filled chunks to a background thread. One chunk is written to the file while
+    // the other is being filled, so serialization does not wait on the disk. Seeking back to patch already written
+    // bytes is supported; every seek submits the current chunk.
+    class async_filebuf : public std::basic_streambuf<uint8_t>
+    {
+      public:
+        async_filebuf(size_t const chunk_size = 1024 * 1024)
+        {
+            for (auto& buffer : buffers)
+            {
+                buffer.resize(chunk_size);
+            }
+        }
+
+        ~async_filebuf()
+        {
+            close();
+        }
+
+        async_filebuf(async_filebuf const&) = delete;
+
+        auto operator=(async_filebuf const&) -> async_filebuf& = delete;
+
+        auto open(std::filesystem::path const& file_path) -> bool
+        {
+#ifdef _WIN32
+            file = ::_wfopen(file_path.c_str(), L"wb");
+#else
+            file = std::fopen(file_path.c_str(), "wb");
+#endif
+            if (!file)
+            {
+                return false;
+            }
+
+            is_failed = false;
+            is_stopped = false;
+            file_offset = 0;
+            chunk_offset = 0;
+            current_buffer = 0;
+            setp(buffers[current_buffer].data(), buffers[current_buffer].data() + buffers[current_buffer].size());
+
+            thread = std::thread([this]() { write_chunks(); });
+            return true;
+        }
+
+        auto is_open() const -> bool
+        {
+            return file;
+        }
+
+        // Writes the remaining chunk and waits for the background thread. Returns false if any write failed.
+        auto close() -> bool
+        {
+            if (!file)
+            {
+                return false;
+            }
+
+            submit_chunk();
+            {
+                std::unique_lock lock(mutex);
+                is_stopped = true;
+            }
+            condition.notify_all();
+            thread.join();
+
+            bool const is_closed = std::fclose(file) == 0;
+            file = nullptr;
+            return is_closed && !is_failed;
+        }
+
+      protected:
+        auto overflow(int_type const value) -> int_type override
+        {
+            if (!submit_chunk())
+            {
+                return traits_type::eof();
+            }
+
+            if (!traits_type::eq_int_type(value, traits_type::eof()))
+            {
+                *pptr() = traits_type::to_char_type(value);
+                pbump(1);
+            }
+            return traits_type::not_eof(value);
+        }
+
+        auto xsputn(char_type const* data, std::streamsize const size) -> std::streamsize override
+        {
+            std::streamsize written = 0;
+            while (written < size)
+            {
+                if (pptr() == epptr() && !submit_chunk())
+                {
+                    break;
+                }
+
+                std::streamsize const count = std::min<std::streamsize>(epptr() - pptr(), size - written);
+                std::memcpy(pptr(), data + written, count);
+                pbump(static_cast<int32_t>(count));
+                written += count;
+            }
+            return written;
+        }
+
+        auto sync() -> int32_t override
+        {
+            if (!submit_chunk())
+            {
+                return -1;
+            }
+
+            std::unique_lock lock(mutex);
+            condition.wait(lock, [this]() { return !pending_chunk.has_value(); });
+            return is_failed ? -1 : 0;
+        }
+
+        auto seekoff(off_type const offset, std::ios_base::seekdir const direction,
+                     std::ios_base::openmode const which) -> pos_type override
+        {
+            if (direction == std::ios_base::cur)
+            {
+                return seekpos(chunk_offset + (pptr() - pbase()) + offset, which);
+            }
+            else if (direction == std::ios_base::beg)
+            {
+                return seekpos(offset, which);
+            }
+            return pos_type(off_type(-1));
+        }
+
+        auto seekpos(pos_type const position, std::ios_base::openmode const which) -> pos_type override
+        {
+            if (!file || !(which & std::ios_base::out))
+            {
+                return pos_type(off_type(-1));
+            }
+
+            uint64_t const target = static_cast<uint64_t>(off_type(position));
+            if (target != chunk_offset + (pptr() - pbase()))
+            {
+                if (!submit_chunk())
+                {
+                    return pos_type(off_type(-1));
+                }
+                chunk_offset = target;
+            }
+            return position;
+        }
+
+      private:
+        struct chunk
+        {
+            uint32_t buffer;
+            uint64_t offset;
+            size_t size;
+        };
+
+        std::FILE* file = nullptr;
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::array<std::vector<uint8_t>, 2> buffers;
+        uint32_t current_buffer = 0;
+        uint64_t chunk_offset = 0;
+        uint64_t file_offset = 0;
+        std::optional<chunk> pending_chunk;
+        bool is_stopped = false;
+        bool is_failed = false;
+
+        // Hands the filled part of the current buffer to the writer and continues in the other one
+        auto submit_chunk() -> bool
+        {
+            size_t const size = pptr() - pbase();
+            if (size > 0)
+            {
+                std::unique_lock lock(mutex);
+                condition.wait(lock, [this]() { return !pending_chunk.has_value(); });
+                if (is_failed)
+                {
+                    return false;
+                }
+
+                pending_chunk = chunk{.buffer = current_buffer, .offset = chunk_offset, .size = size};
+                lock.unlock();
+                condition.notify_all();
+
+                chunk_offset += size;
+                current_buffer = (current_buffer + 1) % buffers.size();
+            }
+            setp(buffers[current_buffer].data(), buffers[current_buffer].data() + buffers[current_buffer].size());
+            return true;
+        }
+
+        auto write_chunks() -> void
+        {
+            while (true)
+            {
+                std::unique_lock lock(mutex);
+                condition.wait(lock, [this]() { return pending_chunk.has_value() || is_stopped; });
+                if (!pending_chunk.has_value())
+                {
+                    break;
+                }
+
+                chunk const next_chunk = pending_chunk.value();
+                lock.unlock();
+
+                bool is_written = true;
+                if (next_chunk.offset != file_offset)
+                {
+#ifdef _WIN32
+                    is_written = ::_fseeki64(file, static_cast<int64_t>(next_chunk.offset), SEEK_SET) == 0;
+#else
+                    is_written = ::fseeko(file, static_cast<off_t>(next_chunk.offset), SEEK_SET) == 0;
+#endif
+                }
+                is_written = is_written &&
+                             std::fwrite(buffers[next_chunk.buffer].data(), 1, next_chunk.size, file) == next_chunk.size;
+                file_offset = next_chunk.offset + next_chunk.size;
+
+                lock.lock();
+                is_failed = is_failed || !is_written;
+                pending_chunk.reset();
+                lock.unlock();
+                condition.notify_all();
+            }
+        }
+    };
+} // namespace ionengine::core
@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include "core/cpu.hpp"
+
 namespace ionengine::core
 {
     // https://github.com/matheusgomes28/base64pp
@@ -42,125 +44,357 @@ namespace ionengine::core
             return {b64_char1, b64_char2, b64_char3, b64_char4};
         }
 
-        inline bool is_valid_base64_char(char c)
+        // Encodes whole triplets and the padded tail
+        inline auto encode_scalar(uint8_t const* source, size_t const size, char* output) -> void
         {
-            auto const decode_byte = decode_table[c];
-            return decode_byte != 0x64;
+            size_t i = 0;
+            for (; i + 3 <= size; i += 3)
+            {
+                auto const base64_chars = encode_tripplet(source[i], source[i + 1], source[i + 2]);
+                std::memcpy(output, base64_chars.data(), 4);
+                output += 4;
+            }
+
+            if (size - i == 2)
+            {
+                auto const base64_chars = encode_tripplet(source[i], source[i + 1], 0x00);
+                output[0] = base64_chars[0];
+                output[1] = base64_chars[1];
+                output[2] = base64_chars[2];
+                output[3] = '=';
+            }
+            else if (size - i == 1)
+            {
+                auto const base64_chars = encode_tripplet(source[i], 0x00, 0x00);
+                output[0] = base64_chars[0];
+                output[1] = base64_chars[1];
+                output[2] = '=';
+                output[3] = '=';
+            }
         }
 
-        inline bool is_valid_base64_str(std::string_view const encoded_str)
+        // Decodes unpadded characters. Returns false on a character outside of the alphabet.
+        inline auto decode_scalar(char const* source, size_t const size, uint8_t* output) -> bool
         {
-            if ((encoded_str.size() % 4) == 1)
+            size_t i = 0;
+            for (; i + 4 <= size; i += 4)
             {
-                return false;
+                uint32_t const a = decode_table[static_cast<uint8_t>(source[i])];
+                uint32_t const b = decode_table[static_cast<uint8_t>(source[i + 1])];
+                uint32_t const c = decode_table[static_cast<uint8_t>(source[i + 2])];
+                uint32_t const d = decode_table[static_cast<uint8_t>(source[i + 3])];
+                if ((a | b | c | d) & 0x40)
+                {
+                    return false;
+                }
+
+                uint32_t const concat_bytes = (a << 18) | (b << 12) | (c << 6) | d;
+                output[0] = (concat_bytes >> 16) & 0xff;
+                output[1] = (concat_bytes >> 8) & 0xff;
+                output[2] = concat_bytes & 0xff;
+                output += 3;
             }
 
-            if (!std::all_of(std::begin(encoded_str), std::end(encoded_str) - 2,
-                             [](char c) { return is_valid_base64_char(c); }))
+            if (size - i >= 2)
             {
-                return false;
+                uint32_t const a = decode_table[static_cast<uint8_t>(source[i])];
+                uint32_t const b = decode_table[static_cast<uint8_t>(source[i + 1])];
+                uint32_t const c = size - i == 3 ? decode_table[static_cast<uint8_t>(source[i + 2])] : 0;
+                if ((a | b | c) & 0x40)
+                {
+                    return false;
+                }
+
+                uint32_t const concat_bytes = (a << 18) | (b << 12) | (c << 6);
+                output[0] = (concat_bytes >> 16) & 0xff;
+                if (size - i == 3)
+                {
+                    output[1] = (concat_bytes >> 8) & 0xff;
+                }
             }
+            return true;
+        }
+
+#ifdef IONENGINE_CPU_X86
+        // http://0x80.pl/notesen/2016-01-12-sse-base64-encoding.html
+        IONENGINE_TARGET("ssse3")
+        inline auto encode_indices_ssse3(__m128i input) -> __m128i
+        {
+            input = _mm_shuffle_epi8(input, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+
+            __m128i const t0 = _mm_and_si128(input, _mm_set1_epi32(0x0fc0fc00));
+            __m128i const t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+            __m128i const t2 = _mm_and_si128(input, _mm_set1_epi32(0x003f03f0));
+            __m128i const t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+            __m128i const indices = _mm_or_si128(t1, t3);
+
+            __m128i result = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+            __m128i const less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+            result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
 
-            auto const last = std::rbegin(encoded_str);
-            if (!is_valid_base64_char(*std::next(last)))
+            __m128i const shift_lut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                                    '/' - 63, 'A', 0, 0);
+            result = _mm_shuffle_epi8(shift_lut, result);
+            return _mm_add_epi8(result, indices);
+        }
+
+        // Returns the number of source bytes encoded, always a multiple of 12
+        IONENGINE_TARGET("ssse3")
+        inline auto encode_ssse3(uint8_t const* source, size_t const size, char* output) -> size_t
+        {
+            size_t i = 0;
+            for (; i + 16 <= size; i += 12)
             {
-                return (*std::next(last) == '=') && (*last == '=');
+                __m128i const input = _mm_loadu_si128(reinterpret_cast<__m128i const*>(source + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output), encode_indices_ssse3(input));
+                output += 16;
             }
+            return i;
+        }
+
+        IONENGINE_TARGET("avx2")
+        inline auto encode_avx2(uint8_t const* source, size_t const size, char* output) -> size_t
+        {
+            size_t i = 0;
+            for (; i + 28 <= size; i += 24)
+            {
+                __m256i input = _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<__m128i const*>(source + i)));
+                input = _mm256_inserti128_si256(
+                    input, _mm_loadu_si128(reinterpret_cast<__m128i const*>(source + i + 12)), 1);
+
+                input = _mm256_shuffle_epi8(input, _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+                                                                   10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+
+                __m256i const t0 = _mm256_and_si256(input, _mm256_set1_epi32(0x0fc0fc00));
+                __m256i const t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+                __m256i const t2 = _mm256_and_si256(input, _mm256_set1_epi32(0x003f03f0));
+                __m256i const t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+                __m256i const indices = _mm256_or_si256(t1, t3);
+
+                __m256i result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+                __m256i const less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+                result = _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
 
-            return is_valid_base64_char(*last) || (*last == '=');
+                __m256i const shift_lut = _mm256_setr_epi8(
+                    'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                    '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0, 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+                result = _mm256_add_epi8(_mm256_shuffle_epi8(shift_lut, result), indices);
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(output), result);
+                output += 32;
+            }
+            return i;
         }
 
-        inline std::array<uint8_t, 3> decode_quad(char const a, char const b, char const c, char const d)
+        // https://github.com/aklomp/base64. Returns the number of characters decoded, always a multiple of 16. Stops
+        // at the first block that contains a character outside of the alphabet and leaves it to the scalar path.
+        IONENGINE_TARGET("ssse3")
+        inline auto decode_ssse3(char const* source, size_t const size, uint8_t* output,
+                                 size_t const output_size) -> size_t
         {
-            uint32_t const concat_bytes =
-                (decode_table[a] << 18) | (decode_table[b] << 12) | (decode_table[c] << 6) | decode_table[d];
+            __m128i const lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13,
+                                                 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+            __m128i const lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10,
+                                                 0x10, 0x10, 0x10, 0x10, 0x10);
+            __m128i const lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+            __m128i const mask_2f = _mm_set1_epi8(0x2f);
+
+            size_t i = 0;
+            size_t written = 0;
+            for (; i + 16 <= size && written + 16 <= output_size; i += 16)
+            {
+                __m128i input = _mm_loadu_si128(reinterpret_cast<__m128i const*>(source + i));
+
+                __m128i const hi_nibbles = _mm_and_si128(_mm_srli_epi32(input, 4), mask_2f);
+                __m128i const lo_nibbles = _mm_and_si128(input, mask_2f);
+                __m128i const hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+                __m128i const lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+                if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0)
+                {
+                    break;
+                }
 
-            uint8_t const byte1 = (concat_bytes >> 16) & 0b1111'1111;
-            uint8_t const byte2 = (concat_bytes >> 8) & 0b1111'1111;
-            uint8_t const byte3 = concat_bytes & 0b1111'1111;
-            return {byte1, byte2, byte3};
+                __m128i const eq_2f = _mm_cmpeq_epi8(input, mask_2f);
+                __m128i const roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles));
+                input = _mm_add_epi8(input, roll);
+
+                __m128i const merged = _mm_maddubs_epi16(input, _mm_set1_epi32(0x01400140));
+                __m128i result = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+                result = _mm_shuffle_epi8(result, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + written), result);
+                written += 12;
+            }
+            return i;
         }
+
+        IONENGINE_TARGET("avx2")
+        inline auto decode_avx2(char const* source, size_t const size, uint8_t* output,
+                                size_t const output_size) -> size_t
+        {
+            __m256i const lut_lo = _mm256_setr_epi8(
+                0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A, 0x15,
+                0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+            __m256i const lut_hi = _mm256_setr_epi8(
+                0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+            __m256i const lut_roll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16,
+                                                      19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+            __m256i const mask_2f = _mm256_set1_epi8(0x2f);
+
+            size_t i = 0;
+            size_t written = 0;
+            for (; i + 32 <= size && written + 32 <= output_size; i += 32)
+            {
+                __m256i input = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(source + i));
+
+                __m256i const hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(input, 4), mask_2f);
+                __m256i const lo_nibbles = _mm256_and_si256(input, mask_2f);
+                __m256i const hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+                __m256i const lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+                if (!_mm256_testz_si256(lo, hi))
+                {
+                    break;
+                }
+
+                __m256i const eq_2f = _mm256_cmpeq_epi8(input, mask_2f);
+                __m256i const roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles));
+                input = _mm256_add_epi8(input, roll);
+
+                __m256i const merged = _mm256_maddubs_epi16(input, _mm256_set1_epi32(0x01400140));
+                __m256i result = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+                result = _mm256_shuffle_epi8(result, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1,
+                                                                      -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                                                                      -1, -1, -1, -1));
+                result = _mm256_permutevar8x32_epi32(result, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1));
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + written), result);
+                written += 24;
+            }
+            return i;
+        }
+#endif
     } // namespace internal
 
     namespace base64
     {
-        inline std::string encode(std::span<uint8_t const> const source)
+        inline auto encoded_size(size_t const size) -> size_t
         {
-            auto const size = source.size();
-            auto const full_tripples = size / 3;
-
-            std::string output;
-            output.reserve((full_tripples + 2) * 4);
+            return (size + 2) / 3 * 4;
+        }
 
-            for (size_t const i : std::views::iota(0u, full_tripples))
+        // Size of the decoded bytes, or std::nullopt if the length or padding of the source is malformed
+        inline auto decoded_size(std::string_view const source) -> std::optional<size_t>
+        {
+            size_t size = source.size();
+            if (size % 4 == 1)
             {
-                auto const tripplet = source.subspan(i * 3, 3);
-                auto const base64_chars = internal::encode_tripplet(tripplet[0], tripplet[1], tripplet[2]);
-                std::copy(std::begin(base64_chars), std::end(base64_chars), std::back_inserter(output));
+                return std::nullopt;
             }
 
-            if (auto const remaining_chars = size - full_tripples * 3; remaining_chars == 2)
+            if (size >= 2 && source[size - 2] == '=')
             {
-                auto const last_two = source.last(2);
-                auto const base64_chars = internal::encode_tripplet(last_two[0], last_two[1], 0x00);
-
-                output.push_back(base64_chars[0]);
-                output.push_back(base64_chars[1]);
-                output.push_back(base64_chars[2]);
-                output.push_back('=');
+                if (source[size - 1] != '=')
+                {
+                    return std::nullopt;
+                }
+                size -= 2;
             }
-            else if (remaining_chars == 1)
+            else if (size >= 1 && source[size - 1] == '=')
             {
-                auto const base64_chars = internal::encode_tripplet(source.back(), 0x00, 0x00);
+                size -= 1;
+            }
 
-                output.push_back(base64_chars[0]);
-                output.push_back(base64_chars[1]);
-                output.push_back('=');
-                output.push_back('=');
+            if (size % 4 == 1)
+            {
+                return std::nullopt;
             }
-            return output;
+            return size / 4 * 3 + (size % 4 == 0 ? 0 : size % 4 - 1);
         }
 
-        inline std::optional<std::vector<std::uint8_t>> decode(std::string_view source)
+        // Writes encoded_size(source.size()) characters into output and returns their count
+        inline auto encode(std::span<uint8_t const> const source, std::span<char> const output) -> size_t
         {
-            if (source.size() == 0)
+            size_t const size = encoded_size(source.size());
+            assert(output.size() >= size && "output is smaller than the encoded size");
+
+            size_t encoded = 0;
+#ifdef IONENGINE_CPU_X86
+            auto const& features = get_cpu_features();
+            if (features.avx2)
             {
-                return std::nullopt;
+                encoded = internal::encode_avx2(source.data(), source.size(), output.data());
+            }
+            else if (features.ssse3)
+            {
+                encoded = internal::encode_ssse3(source.data(), source.size(), output.data());
             }
+#endif
+            internal::encode_scalar(source.data() + encoded, source.size() - encoded,
+                                    output.data() + encoded / 3 * 4);
+            return size;
+        }
 
-            if (!internal::is_valid_base64_str(source))
+        inline std::string encode(std::span<uint8_t const> const source)
+        {
+            std::string output(encoded_size(source.size()), '\0');
+            encode(source, output);
+            return output;
+        }
+
+        // Decodes into a caller-provided buffer. Returns the number of bytes written, or std::nullopt if the source
+        // is not valid base64 or the buffer is too small.
+        inline auto decode(std::string_view const source, std::span<uint8_t> const output) -> std::optional<size_t>
+        {
+            auto const size = decoded_size(source);
+            if (!size.has_value() || output.size() < size.value())
             {
                 return std::nullopt;
             }
 
-            auto const unpadded_source = source.substr(0, source.find_first_of('='));
-            auto const full_quadruples = unpadded_source.size() / 4;
+            size_t const unpadded_size = size.value() / 3 * 4 + (size.value() % 3 == 0 ? 0 : size.value() % 3 + 1);
 
-            std::vector<std::uint8_t> decoded_bytes;
-            decoded_bytes.reserve(((full_quadruples + 2) * 3) / 4);
-
-            for (size_t const i : std::views::iota(0u, full_quadruples))
+            size_t decoded = 0;
+#ifdef IONENGINE_CPU_X86
+            auto const& features = get_cpu_features();
+            if (features.avx2)
+            {
+                decoded = internal::decode_avx2(source.data(), unpadded_size, output.data(), size.value());
+            }
+            else if (features.ssse3)
             {
-                auto const quad = unpadded_source.substr(i * 4, 4);
-                auto const bytes = internal::decode_quad(quad[0], quad[1], quad[2], quad[3]);
-                std::copy(std::begin(bytes), std::end(bytes), std::back_inserter(decoded_bytes));
+                decoded = internal::decode_ssse3(source.data(), unpadded_size, output.data(), size.value());
             }
+#endif
+            if (!internal::decode_scalar(source.data() + decoded, unpadded_size - decoded,
+                                         output.data() + decoded / 4 * 3))
+            {
+                return std::nullopt;
+            }
+            return size.value();
+        }
 
-            if (auto const last_quad = unpadded_source.substr(full_quadruples * 4); last_quad.size() == 0)
+        inline std::optional<std::vector<std::uint8_t>> decode(std::string_view const source)
+        {
+            if (source.size() == 0)
             {
-                return decoded_bytes;
+                return std::nullopt;
             }
-            else if ((last_quad.size() == 2) || (last_quad[2] == '='))
+
+            auto const size = decoded_size(source);
+            if (!size.has_value())
             {
-                auto const bytes = internal::decode_quad(last_quad[0], last_quad[1], 'A', 'A');
-                decoded_bytes.push_back(bytes[0]);
+                return std::nullopt;
             }
-            else
+
+            std::vector<uint8_t> decoded_bytes(size.value());
+            if (!decode(source, decoded_bytes).has_value())
             {
-                auto const bytes = internal::decode_quad(last_quad[0], last_quad[1], last_quad[2], 'A');
-                std::copy_n(std::begin(bytes), 2, std::back_inserter(decoded_bytes));
+                return std::nullopt;
             }
             return decoded_bytes;
         }
     } // namespace base64
-} // namespace ionengine::core
\ No newline at end of file
+} // namespace ionengine::core
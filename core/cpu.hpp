@@ -0,0 +1,87 @@
+// Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
+
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define IONENGINE_CPU_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <immintrin.h>
+#endif
+
+// Enables instruction sets for a single function, so that it can be selected at runtime without building the whole
+// project for them. MSVC accepts the intrinsics without it.
+#if defined(IONENGINE_CPU_X86) && !defined(_MSC_VER)
+#define IONENGINE_TARGET(features) __attribute__((target(features)))
+#else
+#define IONENGINE_TARGET(features)
+#endif
+
+namespace ionengine::core
+{
+    struct cpu_features
+    {
+        bool ssse3;
+        bool sse41;
+        bool pclmul;
+        bool avx2;
+    };
+
+    namespace internal
+    {
+#ifdef IONENGINE_CPU_X86
+        inline auto cpuid(uint32_t const leaf, uint32_t const subleaf) -> std::array<uint32_t, 4>
+        {
+            std::array<uint32_t, 4> registers{};
+#ifdef _MSC_VER
+            ::__cpuidex(reinterpret_cast<int32_t*>(registers.data()), leaf, subleaf);
+#else
+            __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+            return registers;
+        }
+
+        inline auto xgetbv() -> uint64_t
+        {
+#ifdef _MSC_VER
+            return ::_xgetbv(0);
+#else
+            uint32_t eax, edx;
+            __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+            return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+        }
+#endif
+    } // namespace internal
+
+    // Instruction sets available on the running processor, queried once
+    inline auto get_cpu_features() -> cpu_features const&
+    {
+        static cpu_features const features = [] {
+            cpu_features features{};
+#ifdef IONENGINE_CPU_X86
+            uint32_t const max_leaf = internal::cpuid(0, 0)[0];
+            if (max_leaf >= 1)
+            {
+                auto const leaf1 = internal::cpuid(1, 0);
+                features.ssse3 = leaf1[2] & (1u << 9);
+                features.sse41 = leaf1[2] & (1u << 19);
+                features.pclmul = leaf1[2] & (1u << 1);
+
+                // AVX registers also have to be saved by the operating system
+                bool const is_avx_enabled =
+                    (leaf1[2] & (1u << 27)) && (leaf1[2] & (1u << 28)) && (internal::xgetbv() & 0x6) == 0x6;
+                if (is_avx_enabled && max_leaf >= 7)
+                {
+                    features.avx2 = internal::cpuid(7, 0)[1] & (1u << 5);
+                }
+            }
+#endif
+            return features;
+        }();
+        return features;
+    }
+} // namespace ionengine::core
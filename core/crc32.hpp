@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include "core/cpu.hpp"
+
 namespace ionengine::core
 {
     // https://stackoverflow.com/questions/2111667/compile-time-string-hashing
@@ -37,7 +39,139 @@ namespace ionengine::core
             0x40df0b66, 0x37d83bf0, 0xa9bcae53, 0xdebb9ec5, 0x47b2cf7f, 0x30b5ffe9, 0xbdbdf21c, 0xcabac28a, 0x53b39330,
             0x24b4a3a6, 0xbad03605, 0xcdd70693, 0x54de5729, 0x23d967bf, 0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94,
             0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d};
-    }
+
+        // Tables for slicing-by-16. Entry [k][i] is the CRC of byte i followed by k zero bytes.
+        inline constexpr auto crc_slicing_table = [] {
+            std::array<std::array<uint32_t, 256>, 16> table{};
+            for (size_t i = 0; i < 256; ++i)
+            {
+                table[0][i] = crc_table[i];
+            }
+            for (size_t k = 1; k < table.size(); ++k)
+            {
+                for (size_t i = 0; i < 256; ++i)
+                {
+                    table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xff];
+                }
+            }
+            return table;
+        }();
+
+        inline auto load_le32(uint8_t const* source) -> uint32_t
+        {
+            uint32_t value;
+            std::memcpy(&value, source, sizeof(uint32_t));
+            if constexpr (std::endian::native == std::endian::big)
+            {
+                value = std::byteswap(value);
+            }
+            return value;
+        }
+
+        // Works on the inverted CRC state
+        inline auto crc32_slicing(uint8_t const* data, size_t size, uint32_t crc) -> uint32_t
+        {
+            auto const& table = crc_slicing_table;
+            while (size >= 16)
+            {
+                uint32_t const one = load_le32(data) ^ crc;
+                uint32_t const two = load_le32(data + 4);
+                uint32_t const three = load_le32(data + 8);
+                uint32_t const four = load_le32(data + 12);
+                crc = table[15][one & 0xff] ^ table[14][(one >> 8) & 0xff] ^ table[13][(one >> 16) & 0xff] ^
+                      table[12][one >> 24] ^ table[11][two & 0xff] ^ table[10][(two >> 8) & 0xff] ^
+                      table[9][(two >> 16) & 0xff] ^ table[8][two >> 24] ^ table[7][three & 0xff] ^
+                      table[6][(three >> 8) & 0xff] ^ table[5][(three >> 16) & 0xff] ^ table[4][three >> 24] ^
+                      table[3][four & 0xff] ^ table[2][(four >> 8) & 0xff] ^ table[1][(four >> 16) & 0xff] ^
+                      table[0][four >> 24];
+                data += 16;
+                size -= 16;
+            }
+            while (size > 0)
+            {
+                crc = (crc >> 8) ^ table[0][(crc ^ *data) & 0xff];
+                ++data;
+                --size;
+            }
+            return crc;
+        }
+
+#ifdef IONENGINE_CPU_X86
+        IONENGINE_TARGET("pclmul")
+        inline auto crc32_fold(__m128i const value, __m128i const next, __m128i const constants) -> __m128i
+        {
+            __m128i const low = _mm_clmulepi64_si128(value, constants, 0x00);
+            __m128i const high = _mm_clmulepi64_si128(value, constants, 0x11);
+            return _mm_xor_si128(_mm_xor_si128(high, next), low);
+        }
+
+        // Folding with carry-less multiplication, as in Chromium's zlib (crc32_simd.c). Works on the inverted CRC
+        // state and needs at least 64 bytes, size has to be a multiple of 16.
+        IONENGINE_TARGET("pclmul,sse4.1")
+        inline auto crc32_pclmul(uint8_t const* data, size_t size, uint32_t const crc) -> uint32_t
+        {
+            __m128i x1 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data));
+            __m128i x2 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + 16));
+            __m128i x3 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + 32));
+            __m128i x4 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + 48));
+            x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int32_t>(crc)));
+            data += 64;
+            size -= 64;
+
+            // Fold four blocks of 128 bits in parallel
+            __m128i x0 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+            while (size >= 64)
+            {
+                __m128i const x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+                __m128i const x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+                __m128i const x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+                __m128i const x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+                x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+                x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+                x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+                x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+                x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<__m128i const*>(data)));
+                x2 = _mm_xor_si128(_mm_xor_si128(x2, x6),
+                                   _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + 16)));
+                x3 = _mm_xor_si128(_mm_xor_si128(x3, x7),
+                                   _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + 32)));
+                x4 = _mm_xor_si128(_mm_xor_si128(x4, x8),
+                                   _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + 48)));
+                data += 64;
+                size -= 64;
+            }
+
+            // Fold into 128 bits, then the remaining blocks of 16 bytes
+            x0 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+            x1 = crc32_fold(x1, x2, x0);
+            x1 = crc32_fold(x1, x3, x0);
+            x1 = crc32_fold(x1, x4, x0);
+            while (size >= 16)
+            {
+                x1 = crc32_fold(x1, _mm_loadu_si128(reinterpret_cast<__m128i const*>(data)), x0);
+                data += 16;
+                size -= 16;
+            }
+
+            // Fold 128 bits to 64 bits
+            __m128i const mask = _mm_setr_epi32(~0, 0, ~0, 0);
+            x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+            x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+            x0 = _mm_set_epi64x(0, 0x0163cd6124);
+            x2 = _mm_srli_si128(x1, 4);
+            x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), x0, 0x00);
+            x1 = _mm_xor_si128(x1, x2);
+
+            // Barrett reduction to 32 bits
+            x0 = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+            x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), x0, 0x10);
+            x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask), x0, 0x00);
+            x1 = _mm_xor_si128(x1, x2);
+            return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+        }
+#endif
+    } // namespace internal
 
     constexpr auto crc32(std::string_view source) -> uint32_t
     {
@@ -46,4 +180,25 @@ namespace ionengine::core
             crc = (crc >> 8) ^ internal::crc_table[(crc ^ c) & 0xff];
         return crc ^ 0xffffffff;
     }
-} // namespace ionengine::core
\ No newline at end of file
+
+    // CRC32 of a byte range. Passing the result of a previous call as crc continues the checksum over
+    // consecutive ranges.
+    inline auto crc32(std::span<uint8_t const> const source, uint32_t const crc = 0) -> uint32_t
+    {
+        uint8_t const* data = source.data();
+        size_t size = source.size();
+        uint32_t state = ~crc;
+
+#ifdef IONENGINE_CPU_X86
+        auto const& features = get_cpu_features();
+        if (size >= 64 && features.pclmul && features.sse41)
+        {
+            size_t const folded_size = size & ~size_t(15);
+            state = internal::crc32_pclmul(data, folded_size, state);
+            data += folded_size;
+            size -= folded_size;
+        }
+#endif
+        return ~internal::crc32_slicing(data, size, state);
+    }
+} // namespace ionengine::core
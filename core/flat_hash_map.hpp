@@ -0,0 +1,149 @@
+// Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
+
+#pragma once
+
+namespace ionengine::core
+{
+    // Open addressing hash map with linear probing over a single array of slots. A control byte per slot keeps seven
+    // bits of the hash, so most probes are rejected without comparing keys. Elements are only inserted, the map is
+    // meant for building lookup tables such as welding vertices. Key and Value have to be default constructible, and
+    // Hasher has to mix all bits of its result.
+    template <typename Key, typename Value, typename Hasher = std::hash<Key>, typename Equal = std::equal_to<Key>>
+    class flat_hash_map
+    {
+      public:
+        flat_hash_map(size_t const capacity = 0)
+        {
+            reserve(capacity);
+        }
+
+        auto size() const -> size_t
+        {
+            return count;
+        }
+
+        auto empty() const -> bool
+        {
+            return count == 0;
+        }
+
+        // Makes room for the count of elements without rehashing
+        auto reserve(size_t const capacity) -> void
+        {
+            size_t slot_count = 16;
+            while (slot_count * max_load_numerator / max_load_denominator < capacity)
+            {
+                slot_count *= 2;
+            }
+
+            if (slot_count > slots.size())
+            {
+                rehash(slot_count);
+            }
+        }
+
+        auto clear() -> void
+        {
+            std::fill(controls.begin(), controls.end(), empty_control);
+            count = 0;
+        }
+
+        // Inserts the value if the key is missing, returns the stored value and whether it was inserted
+        auto try_emplace(Key const& key, Value const& value) -> std::pair<Value&, bool>
+        {
+            if (slots.empty() || (count + 1) * max_load_denominator > slots.size() * max_load_numerator)
+            {
+                rehash(std::max<size_t>(slots.size() * 2, 16));
+            }
+
+            uint64_t const hash = Hasher()(key);
+            uint8_t const control = to_control(hash);
+            size_t const mask = slots.size() - 1;
+            for (size_t index = hash & mask;; index = (index + 1) & mask)
+            {
+                if (controls[index] == empty_control)
+                {
+                    controls[index] = control;
+                    slots[index] = slot{.key = key, .value = value};
+                    ++count;
+                    return {slots[index].value, true};
+                }
+                if (controls[index] == control && Equal()(slots[index].key, key))
+                {
+                    return {slots[index].value, false};
+                }
+            }
+        }
+
+        auto find(Key const& key) -> Value*
+        {
+            return const_cast<Value*>(static_cast<flat_hash_map const&>(*this).find(key));
+        }
+
+        auto find(Key const& key) const -> Value const*
+        {
+            if (count == 0)
+            {
+                return nullptr;
+            }
+
+            uint64_t const hash = Hasher()(key);
+            uint8_t const control = to_control(hash);
+            size_t const mask = slots.size() - 1;
+            for (size_t index = hash & mask; controls[index] != empty_control; index = (index + 1) & mask)
+            {
+                if (controls[index] == control && Equal()(slots[index].key, key))
+                {
+                    return &slots[index].value;
+                }
+            }
+            return nullptr;
+        }
+
+      private:
+        struct slot
+        {
+            Key key;
+            Value value;
+        };
+
+        static constexpr uint8_t empty_control = 0;
+        static constexpr size_t max_load_numerator = 7;
+        static constexpr size_t max_load_denominator = 8;
+
+        std::vector<uint8_t> controls;
+        std::vector<slot> slots;
+        size_t count = 0;
+
+        // The top bit marks an occupied slot, the rest comes from the bits not used for the index
+        static auto to_control(uint64_t const hash) -> uint8_t
+        {
+            return static_cast<uint8_t>(0x80 | (hash >> 57));
+        }
+
+        auto rehash(size_t const slot_count) -> void
+        {
+            std::vector<uint8_t> old_controls(slot_count, empty_control);
+            std::vector<slot> old_slots(slot_count);
+            std::swap(controls, old_controls);
+            std::swap(slots, old_slots);
+
+            size_t const mask = slot_count - 1;
+            for (size_t const i : std::views::iota(0u, old_slots.size()))
+            {
+                if (old_controls[i] == empty_control)
+                {
+                    continue;
+                }
+
+                size_t index = Hasher()(old_slots[i].key) & mask;
+                while (controls[index] != empty_control)
+                {
+                    index = (index + 1) & mask;
+                }
+                controls[index] = old_controls[i];
+                slots[index] = std::move(old_slots[i]);
+            }
+        }
+    };
+} // namespace ionengine::core
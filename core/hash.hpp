@@ -0,0 +1,66 @@
+// Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
+
+#pragma once
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace ionengine::core
+{
+    namespace internal
+    {
+        // Constants of wyhash, https://github.com/wangyi-fudan/wyhash
+        inline constexpr uint64_t hash_secret0 = 0xa0761d6478bd642full;
+        inline constexpr uint64_t hash_secret1 = 0xe7037ed1a0b428dbull;
+        inline constexpr uint64_t hash_secret2 = 0x8ebc6af09c88c6e3ull;
+    } // namespace internal
+
+    // 64x64 to 128 bit multiplication folded back to 64 bits, the mixing step of wyhash
+    inline auto hash_mix(uint64_t const lhs, uint64_t const rhs) -> uint64_t
+    {
+#if defined(__SIZEOF_INT128__)
+        unsigned __int128 const product = static_cast<unsigned __int128>(lhs) * rhs;
+        return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        uint64_t high;
+        uint64_t const low = ::_umul128(lhs, rhs, &high);
+        return low ^ high;
+#else
+        uint64_t const lhs_high = lhs >> 32, lhs_low = static_cast<uint32_t>(lhs);
+        uint64_t const rhs_high = rhs >> 32, rhs_low = static_cast<uint32_t>(rhs);
+        uint64_t const high_high = lhs_high * rhs_high, high_low = lhs_high * rhs_low;
+        uint64_t const low_high = lhs_low * rhs_high, low_low = lhs_low * rhs_low;
+        uint64_t const middle = (low_low >> 32) + static_cast<uint32_t>(high_low) + static_cast<uint32_t>(low_high);
+        uint64_t const low = (middle << 32) | static_cast<uint32_t>(low_low);
+        uint64_t const high = high_high + (high_low >> 32) + (low_high >> 32) + (middle >> 32);
+        return low ^ high;
+#endif
+    }
+
+    // Combines a hash with another value, the order of the values matters
+    inline auto hash_combine(uint64_t const seed, uint64_t const value) -> uint64_t
+    {
+        return hash_mix(seed ^ internal::hash_secret0, value ^ internal::hash_secret1);
+    }
+
+    // Hash of float values that agrees with their operator==, so 0.0f and -0.0f hash the same
+    inline auto hash_floats(std::span<float const> const values) -> uint64_t
+    {
+        auto const to_bits = [](float const value) -> uint64_t {
+            return value == 0.0f ? 0 : std::bit_cast<uint32_t>(value);
+        };
+
+        uint64_t hash = internal::hash_secret2 ^ values.size();
+        size_t i = 0;
+        for (; i + 1 < values.size(); i += 2)
+        {
+            hash = hash_combine(hash, to_bits(values[i]) | (to_bits(values[i + 1]) << 32));
+        }
+        if (i < values.size())
+        {
+            hash = hash_combine(hash, to_bits(values[i]));
+        }
+        return hash_mix(hash ^ internal::hash_secret0, values.size() ^ internal::hash_secret2);
+    }
+} // namespace ionengine::core
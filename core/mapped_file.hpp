@@ -0,0 +1,188 @@
+// Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
+
+#pragma once
+
+#include "core/error.hpp"
+#include "core/ref_ptr.hpp"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ionengine::core
+{
+    // Read-only view of a whole file mapped into the address space. Pages are served straight from the page cache.
+    class mapped_file : public ref_counted_object
+    {
+      public:
+        mapped_file(std::filesystem::path const& file_path)
+        {
+#ifdef _WIN32
+            file = ::CreateFileW(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                 FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+            {
+                throw core::runtime_error("An error occurred while opening a file");
+            }
+
+            LARGE_INTEGER file_size;
+            if (!::GetFileSizeEx(file, &file_size))
+            {
+                ::CloseHandle(file);
+                throw core::runtime_error("An error occurred while opening a file");
+            }
+            size = static_cast<size_t>(file_size.QuadPart);
+
+            if (size > 0)
+            {
+                mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (!mapping)
+                {
+                    ::CloseHandle(file);
+                    throw core::runtime_error("An error occurred while mapping a file");
+                }
+
+                ptr = reinterpret_cast<uint8_t const*>(::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                if (!ptr)
+                {
+                    ::CloseHandle(mapping);
+                    ::CloseHandle(file);
+                    throw core::runtime_error("An error occurred while mapping a file");
+                }
+            }
+#else
+            int32_t const fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd == -1)
+            {
+                throw core::runtime_error("An error occurred while opening a file");
+            }
+
+            struct stat file_stat;
+            if (::fstat(fd, &file_stat) == -1)
+            {
+                ::close(fd);
+                throw core::runtime_error("An error occurred while opening a file");
+            }
+            size = static_cast<size_t>(file_stat.st_size);
+
+            if (size > 0)
+            {
+                void* memory = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (memory == MAP_FAILED)
+                {
+                    ::close(fd);
+                    throw core::runtime_error("An error occurred while mapping a file");
+                }
+
+                ::madvise(memory, size, MADV_SEQUENTIAL);
+                ptr = reinterpret_cast<uint8_t const*>(memory);
+            }
+
+            // The mapping keeps its own reference to the file
+            ::close(fd);
+#endif
+        }
+
+        ~mapped_file()
+        {
+#ifdef _WIN32
+            if (ptr)
+            {
+                ::UnmapViewOfFile(ptr);
+                ::CloseHandle(mapping);
+            }
+            ::CloseHandle(file);
+#else
+            if (ptr)
+            {
+                ::munmap(const_cast<uint8_t*>(ptr), size);
+            }
+#endif
+        }
+
+        mapped_file(mapped_file const&) = delete;
+
+        auto operator=(mapped_file const&) -> mapped_file& = delete;
+
+        auto data() const -> std::span<uint8_t const>
+        {
+            return std::span<uint8_t const>(ptr, size);
+        }
+
+      private:
+#ifdef _WIN32
+        HANDLE file;
+        HANDLE mapping = nullptr;
+#endif
+        uint8_t const* ptr = nullptr;
+        size_t size = 0;
+    };
+
+    // Byte payload of an asset file. Either owns its bytes or views a range of a mapped file, which it keeps alive.
+    class blob
+    {
+      public:
+        blob() = default;
+
+        blob(std::vector<uint8_t>&& bytes) : storage(std::move(bytes))
+        {
+        }
+
+        blob(ref_ptr<mapped_file> mapping, std::span<uint8_t const> const bytes) : mapping(mapping), view(bytes)
+        {
+        }
+
+        auto data() const -> uint8_t const*
+        {
+            return mapping ? view.data() : storage.data();
+        }
+
+        auto size() const -> size_t
+        {
+            return mapping ? view.size() : storage.size();
+        }
+
+        auto empty() const -> bool
+        {
+            return size() == 0;
+        }
+
+        auto begin() const -> uint8_t const*
+        {
+            return data();
+        }
+
+        auto end() const -> uint8_t const*
+        {
+            return data() + size();
+        }
+
+        auto is_mapped() const -> bool
+        {
+            return mapping;
+        }
+
+        operator std::span<uint8_t const>() const
+        {
+            return std::span<uint8_t const>(data(), size());
+        }
+
+        auto operator==(blob const& other) const -> bool
+        {
+            return std::ranges::equal(*this, other);
+        }
+
+      private:
+        std::vector<uint8_t> storage;
+        ref_ptr<mapped_file> mapping;
+        std::span<uint8_t const> view;
+    };
+} // namespace ionengine::core
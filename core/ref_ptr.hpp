@@ -2,56 +2,169 @@
 
 #pragma once
 
+#include "core/allocator.hpp"
+
+#ifdef _MSC_VER
+#define IONENGINE_NOINLINE __declspec(noinline)
+#else
+#define IONENGINE_NOINLINE __attribute__((noinline))
+#endif
+
 namespace ionengine::core
 {
-    class ref_counted_object
+    // Reference count shared between threads
+    struct atomic_ref_count
+    {
+        using counter_type = std::atomic<uint32_t>;
+
+        static auto increment(counter_type& counter) -> uint32_t
+        {
+            return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+
+        static auto decrement(counter_type& counter) -> uint32_t
+        {
+            return counter.fetch_sub(1, std::memory_order_acq_rel) - 1;
+        }
+
+        static auto increment_if_nonzero(counter_type& counter) -> bool
+        {
+            uint32_t count = counter.load(std::memory_order_relaxed);
+            while (count != 0)
+            {
+                if (counter.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel,
+                                                  std::memory_order_relaxed))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        static auto load(counter_type const& counter) -> uint32_t
+        {
+            return counter.load(std::memory_order_relaxed);
+        }
+    };
+
+    // Plain reference count for objects that never leave the thread that created them
+    struct local_ref_count
+    {
+        using counter_type = uint32_t;
+
+        static auto increment(counter_type& counter) -> uint32_t
+        {
+            return ++counter;
+        }
+
+        static auto decrement(counter_type& counter) -> uint32_t
+        {
+            return --counter;
+        }
+
+        static auto increment_if_nonzero(counter_type& counter) -> bool
+        {
+            if (counter == 0)
+            {
+                return false;
+            }
+            ++counter;
+            return true;
+        }
+
+        static auto load(counter_type const& counter) -> uint32_t
+        {
+            return counter;
+        }
+    };
+
+    // Counters of an object created by make_ref, allocated in front of the object itself. The storage outlives the
+    // object while weak references to it remain.
+    template <typename Policy>
+    struct basic_control_block
+    {
+        typename Policy::counter_type ref_count;
+        // Weak references, plus one held by the strong references together
+        typename Policy::counter_type weak_count;
+        void (*deallocate)(basic_control_block*);
+
+        auto release_weak() -> void
+        {
+            // The decrement orders the last accesses of other threads before the storage is freed
+            if (Policy::decrement(weak_count) == 0)
+            {
+                deallocate(this);
+            }
+        }
+    };
+
+    template <typename Policy>
+    class basic_ref_counted_object
     {
       public:
-        ref_counted_object() : ref_count(0)
+        using policy_type = Policy;
+        using control_block_type = basic_control_block<Policy>;
+
+        basic_ref_counted_object() : ref_count(0), control(nullptr)
         {
         }
 
-        virtual ~ref_counted_object() = default;
+        virtual ~basic_ref_counted_object() = default;
 
-        ref_counted_object(ref_counted_object const& other) : ref_count(other.ref_count.load())
+        // A copy is a new object, it does not share counters with the source
+        basic_ref_counted_object(basic_ref_counted_object const&) : ref_count(0), control(nullptr)
         {
         }
 
-        ref_counted_object(ref_counted_object&& other) : ref_count(other.ref_count.load())
+        basic_ref_counted_object(basic_ref_counted_object&&) : ref_count(0), control(nullptr)
         {
         }
 
-        auto operator=(ref_counted_object const& other) -> ref_counted_object&
+        auto operator=(basic_ref_counted_object const&) -> basic_ref_counted_object&
         {
-            ref_count = other.ref_count.load();
             return *this;
         }
 
-        auto operator=(ref_counted_object&& other) -> ref_counted_object&
+        auto operator=(basic_ref_counted_object&&) -> basic_ref_counted_object&
         {
-            ref_count = other.ref_count.load();
             return *this;
         }
 
         auto add_ref() -> uint32_t
         {
-            return ++ref_count;
+            return Policy::increment(control ? control->ref_count : ref_count);
         }
 
         auto release() -> uint32_t
         {
-            return --ref_count;
+            return Policy::decrement(control ? control->ref_count : ref_count);
         }
 
         auto use_count() -> uint32_t
         {
-            return ref_count;
+            return Policy::load(control ? control->ref_count : ref_count);
+        }
+
+        // Set by make_ref. Objects allocated otherwise keep their counter inline and cannot be weakly referenced.
+        auto get_control_block() const -> control_block_type*
+        {
+            return control;
+        }
+
+        auto attach_control_block(control_block_type* const block) -> void
+        {
+            control = block;
         }
 
       private:
-        std::atomic<uint32_t> ref_count;
+        typename Policy::counter_type ref_count;
+        control_block_type* control;
     };
 
+    using ref_counted_object = basic_ref_counted_object<atomic_ref_count>;
+
+    using local_ref_counted_object = basic_ref_counted_object<local_ref_count>;
+
     template <typename Type>
     struct base_deleter
     {
@@ -61,12 +174,18 @@ namespace ionengine::core
         }
     };
 
+    template <typename Type>
+    class weak_ptr;
+
     template <typename Type, typename Deleter = base_deleter<Type>>
     class ref_ptr
     {
         template <typename Derived, typename DerivedDeleter>
         friend class ref_ptr;
 
+        template <typename Derived>
+        friend class weak_ptr;
+
       public:
         ref_ptr() : ptr(nullptr)
         {
@@ -86,30 +205,61 @@ namespace ionengine::core
             add_ref();
         }
 
-        template <typename Derived, typename DerivedDeleter = BaseDeleter<Derived>>
-        ref_ptr(ref_ptr<Derived, DerivedDeleter> other) : ptr(static_cast<Type*>(other.ptr))
+        template <typename Derived, typename DerivedDeleter = base_deleter<Derived>>
+        ref_ptr(ref_ptr<Derived, DerivedDeleter> const& other) : ptr(static_cast<Type*>(other.ptr))
         {
             add_ref();
         }
 
+        template <typename Derived, typename DerivedDeleter = base_deleter<Derived>>
+        ref_ptr(ref_ptr<Derived, DerivedDeleter>&& other) : ptr(static_cast<Type*>(other.ptr))
+        {
+            other.ptr = nullptr;
+        }
+
         ref_ptr(ref_ptr const& other) : ptr(other.ptr)
         {
             add_ref();
         }
 
+        ref_ptr(ref_ptr&& other) noexcept : ptr(other.ptr)
+        {
+            other.ptr = nullptr;
+        }
+
         auto operator=(ref_ptr const& other) -> ref_ptr&
         {
             copy_ref(other.ptr);
             return *this;
         }
 
-        template <typename Derived, typename DerivedDeleter = BaseDeleter<Derived>>
-        auto operator=(ref_ptr<Derived, DerivedDeleter> other) -> ref_ptr&
+        auto operator=(ref_ptr&& other) noexcept -> ref_ptr&
+        {
+            if (this != &other)
+            {
+                release_ref();
+                ptr = other.ptr;
+                other.ptr = nullptr;
+            }
+            return *this;
+        }
+
+        template <typename Derived, typename DerivedDeleter = base_deleter<Derived>>
+        auto operator=(ref_ptr<Derived, DerivedDeleter> const& other) -> ref_ptr&
         {
             copy_ref(static_cast<Type*>(other.ptr));
             return *this;
         }
 
+        template <typename Derived, typename DerivedDeleter = base_deleter<Derived>>
+        auto operator=(ref_ptr<Derived, DerivedDeleter>&& other) -> ref_ptr&
+        {
+            release_ref();
+            ptr = static_cast<Type*>(other.ptr);
+            other.ptr = nullptr;
+            return *this;
+        }
+
         auto operator->() const -> Type*
         {
             assert(ptr != nullptr && "ref_ptr is null");
@@ -140,6 +290,15 @@ namespace ionengine::core
         }
 
       private:
+        struct adopt_tag
+        {
+        };
+
+        // Takes over a reference that is already counted
+        ref_ptr(Type* ptr, adopt_tag) : ptr(ptr)
+        {
+        }
+
         auto copy_ref(Type* other) -> void
         {
             if (ptr != other)
@@ -165,65 +324,221 @@ namespace ionengine::core
                 uint32_t const count = ptr->release();
                 if (count == 0)
                 {
-                    Deleter()(ptr);
+                    // Objects from make_ref share their storage with the control block, which is released last
+                    if (auto const control = ptr->get_control_block())
+                    {
+                        std::destroy_at(ptr);
+                        control->release_weak();
+                    }
+                    else
+                    {
+                        delete_object(ptr);
+                    }
                 }
             }
         }
 
+        // Kept out of release_ref, otherwise the delete is inlined into the make_ref path and GCC warns about freeing
+        // storage that was not allocated by new
+        IONENGINE_NOINLINE static auto delete_object(Type* ptr) -> void
+        {
+            Deleter()(ptr);
+        }
+
         Type* ptr;
     };
 
+    // Non-owning reference to an object created by make_ref. lock() returns a null ref_ptr once the object has been
+    // destroyed. The dereference operators do not touch any counter and are only valid while the caller knows the
+    // object is alive.
     template <typename Type>
     class weak_ptr
     {
+        template <typename Derived>
+        friend class weak_ptr;
+
       public:
-        weak_ptr() : ptr(nullptr)
+        using control_block_type = typename Type::control_block_type;
+
+        weak_ptr() : ptr(nullptr), control(nullptr)
         {
         }
 
-        weak_ptr(std::nullptr_t) : ptr(nullptr)
+        weak_ptr(std::nullptr_t) : ptr(nullptr), control(nullptr)
         {
         }
 
-        weak_ptr(ref_ptr<Type> const& ptr) : ptr(ptr.get())
+        ~weak_ptr()
         {
+            release_weak();
         }
 
-        weak_ptr(weak_ptr const& other) : ptr(other.ptr)
+        template <typename Derived, typename DerivedDeleter>
+        weak_ptr(ref_ptr<Derived, DerivedDeleter> const& other)
+            : ptr(static_cast<Type*>(other.ptr)), control(other.ptr ? other.ptr->get_control_block() : nullptr)
         {
+            assert((!ptr || control) && "weak_ptr requires an object created by make_ref");
+            add_weak();
+        }
+
+        weak_ptr(weak_ptr const& other) : ptr(other.ptr), control(other.control)
+        {
+            add_weak();
+        }
+
+        weak_ptr(weak_ptr&& other) noexcept : ptr(other.ptr), control(other.control)
+        {
+            other.ptr = nullptr;
+            other.control = nullptr;
+        }
+
+        template <typename Derived>
+        weak_ptr(weak_ptr<Derived> const& other) : ptr(static_cast<Type*>(other.ptr)), control(other.control)
+        {
+            add_weak();
         }
 
         auto operator=(weak_ptr const& other) -> weak_ptr&
         {
-            ptr = other.ptr;
+            if (this != &other)
+            {
+                release_weak();
+                ptr = other.ptr;
+                control = other.control;
+                add_weak();
+            }
+            return *this;
+        }
+
+        auto operator=(weak_ptr&& other) noexcept -> weak_ptr&
+        {
+            if (this != &other)
+            {
+                release_weak();
+                ptr = other.ptr;
+                control = other.control;
+                other.ptr = nullptr;
+                other.control = nullptr;
+            }
             return *this;
         }
 
-        auto operator->() -> ref_ptr<Type>
+        auto lock() const -> ref_ptr<Type>
+        {
+            if (control && Type::policy_type::increment_if_nonzero(control->ref_count))
+            {
+                return ref_ptr<Type>(ptr, typename ref_ptr<Type>::adopt_tag{});
+            }
+            return nullptr;
+        }
+
+        auto expired() const -> bool
         {
-            assert(ptr != nullptr && "weak_ptr is null");
+            return !control || Type::policy_type::load(control->ref_count) == 0;
+        }
+
+        auto operator->() const -> Type*
+        {
+            assert(!expired() && "weak_ptr is expired");
             return ptr;
         }
 
-        auto get() const -> ref_ptr<Type>
+        auto get() const -> Type*
         {
-            assert(ptr != nullptr && "weak_ptr is null");
+            assert(!expired() && "weak_ptr is expired");
             return ptr;
         }
 
         operator bool() const
         {
-            return ptr != nullptr;
+            return !expired();
         }
 
       private:
         Type* ptr;
+        control_block_type* control;
+
+        auto add_weak() -> void
+        {
+            if (control)
+            {
+                Type::policy_type::increment(control->weak_count);
+            }
+        }
+
+        auto release_weak() -> void
+        {
+            if (control)
+            {
+                control->release_weak();
+            }
+        }
     };
 
+    namespace internal
+    {
+        template <typename Type, typename Allocator>
+        struct ref_storage
+        {
+            typename Type::control_block_type control;
+            Allocator* allocator;
+            alignas(Type) std::byte object[sizeof(Type)];
+        };
+
+        template <typename Type, typename Deleter, typename Allocator, typename... Args>
+        inline auto construct_ref(Allocator& allocator, Args&&... args) -> ref_ptr<Type, Deleter>
+        {
+            using control_block_type = typename Type::control_block_type;
+            using storage_type = ref_storage<Type, Allocator>;
+
+            auto storage = new (allocator.allocate(sizeof(storage_type), alignof(storage_type))) storage_type;
+            storage->control.ref_count = 0;
+            storage->control.weak_count = 1;
+            storage->control.deallocate = [](control_block_type* control) {
+                auto storage = reinterpret_cast<storage_type*>(control);
+                Allocator* allocator = storage->allocator;
+                std::destroy_at(storage);
+                allocator->deallocate(storage, sizeof(storage_type), alignof(storage_type));
+            };
+            storage->allocator = &allocator;
+
+            Type* ptr;
+            try
+            {
+                ptr = new (storage->object) Type(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                std::destroy_at(storage);
+                allocator.deallocate(storage, sizeof(storage_type), alignof(storage_type));
+                throw;
+            }
+            ptr->attach_control_block(&storage->control);
+            return ref_ptr<Type, Deleter>(ptr);
+        }
+
+        inline heap_allocator default_allocator;
+    } // namespace internal
+
+    // Allocates the control block and the object together. A custom Deleter owns the object's memory, so such objects
+    // are allocated on their own, keep the inline counter and cannot be weakly referenced.
     template <typename Type, typename Deleter = base_deleter<Type>, typename... Args>
     inline auto make_ref(Args&&... args) -> ref_ptr<Type, Deleter>
     {
-        Type* ptr = new Type(std::forward<Args>(args)...);
-        return ref_ptr<Type, Deleter>(ptr);
+        if constexpr (std::is_same_v<Deleter, base_deleter<Type>>)
+        {
+            return internal::construct_ref<Type, Deleter>(internal::default_allocator, std::forward<Args>(args)...);
+        }
+        else
+        {
+            return ref_ptr<Type, Deleter>(new Type(std::forward<Args>(args)...));
+        }
+    }
+
+    // Same, with the storage taken from allocator, which has to outlive the object and its weak references
+    template <typename Type, typename Allocator, typename... Args>
+    inline auto make_ref(std::allocator_arg_t, Allocator& allocator, Args&&... args) -> ref_ptr<Type>
+    {
+        return internal::construct_ref<Type, base_deleter<Type>>(allocator, std::forward<Args>(args)...);
     }
-} // namespace ionengine::core
\ No newline at end of file
+} // namespace ionengine::core
@@ -2,8 +2,11 @@
 
 #pragma once
 
+#include "core/async_file.hpp"
 #include "core/base64.hpp"
+#include "core/crc32.hpp"
 #include "core/error.hpp"
+#include "core/mapped_file.hpp"
 #include <simdjson.h>
 
 namespace ionengine::core
@@ -46,6 +49,18 @@ namespace ionengine::core
         }
     }
 
+    // Revisions of the binary archive layout. Asset files select one from their magic before reading the rest.
+    namespace archive_revision
+    {
+        // Strings are terminated with '\0'
+        inline uint32_t constexpr v10 = 10;
+        // Strings are prefixed with their length
+        inline uint32_t constexpr v11 = 11;
+        // Blobs carry a CRC32 of their bytes
+        inline uint32_t constexpr v12 = 12;
+        inline uint32_t constexpr latest = v12;
+    } // namespace archive_revision
+
     template <typename Type>
     struct serializable_enum
     {
@@ -53,29 +68,88 @@ namespace ionengine::core
         auto operator()(Archive& archive);
     };
 
-    class serialize_oenum
+    namespace internal
     {
-      public:
-        serialize_oenum(std::string_view const source) : source(source)
+        template <typename Type>
+        struct enum_field
         {
-        }
+            std::string_view name;
+            Type value;
+        };
 
         template <typename Type>
-        auto field(Type const& element, std::string_view const json_name) -> void
+        class enum_recorder
+        {
+          public:
+            enum_recorder(std::vector<enum_field<Type>>& fields) : fields(&fields)
+            {
+            }
+
+            auto field(Type const& element, std::string_view const json_name) -> void
+            {
+                fields->emplace_back(enum_field<Type>{.name = json_name, .value = element});
+            }
+
+          private:
+            std::vector<enum_field<Type>>* fields;
+        };
+
+        // Name table of an enum, recorded once from its serializable_enum specialization. Names are expected to be
+        // string literals.
+        template <typename Type>
+        auto enum_table() -> std::span<enum_field<Type> const>
+        {
+            static std::vector<enum_field<Type>> const fields = [] {
+                std::vector<enum_field<Type>> fields;
+                enum_recorder<Type> recorder(fields);
+                serializable_enum<Type> target;
+                target(recorder);
+                return fields;
+            }();
+            return fields;
+        }
+    } // namespace internal
+
+    template <typename Type>
+    auto enum_from_string(std::string_view const source) -> std::optional<Type>
+    {
+        for (auto const& field : internal::enum_table<Type>())
+        {
+            if (field.name == source)
+            {
+                return field.value;
+            }
+        }
+        return std::nullopt;
+    }
+
+    template <typename Type>
+    auto enum_to_string(Type const element) -> std::optional<std::string_view>
+    {
+        for (auto const& field : internal::enum_table<Type>())
+        {
+            if (field.value == element)
+            {
+                return field.name;
+            }
+        }
+        return std::nullopt;
+    }
+
+    class serialize_oenum
+    {
+      public:
+        serialize_oenum(std::string_view const source) : source(source)
         {
-            enum_fields[std::string(json_name)] = static_cast<uint32_t>(element);
         }
 
         template <typename Type>
         auto operator()(Type& object) -> size_t
         {
-            serializable_enum<Type> target;
-            target(*this);
-
-            auto result = enum_fields.find(std::string(source));
-            if (result != enum_fields.end())
+            auto result = enum_from_string<Type>(source);
+            if (result.has_value())
             {
-                object = static_cast<Type>(result->second);
+                object = result.value();
                 return 1;
             }
             else
@@ -86,12 +160,12 @@ namespace ionengine::core
 
       private:
         std::string_view source;
-        std::unordered_map<std::string, uint32_t> enum_fields;
     };
 
     class serialize_ijson;
     class serialize_ojson;
     class serialize_iarchive;
+    class serialize_imapped;
     class serialize_oarchive;
 
     namespace internal
@@ -146,12 +220,112 @@ namespace ionengine::core
         {
         };
 
+        struct archive_probe
+        {
+            template <typename... Args>
+            auto property(Args&&...) -> void
+            {
+            }
+
+            template <typename... Archives, typename Type>
+            auto with(Type&&) -> void
+            {
+            }
+
+            auto revision(uint32_t) -> void
+            {
+            }
+        };
+
+        template <typename Type>
+        concept has_archive_functor = requires(Type& object, archive_probe& archive) { object(archive); };
+
+        // Types whose binary representation is their object representation, so sequences of them can be read and
+        // written as one contiguous block instead of element by element
+        template <typename Type>
+        struct is_trivially_serializable
+            : std::bool_constant<(std::is_arithmetic_v<Type> || std::is_enum_v<Type>) ||
+                                 (std::is_class_v<Type> && std::is_trivially_copyable_v<Type> &&
+                                  !has_archive_functor<Type> && !is_std_array<Type>::value)>
+        {
+        };
+
+        template <typename T, std::size_t N>
+        struct is_trivially_serializable<std::array<T, N>> : is_trivially_serializable<T>
+        {
+        };
+
         template <typename Type>
         auto from_json(serialize_ijson& input, simdjson::ondemand::value it, Type& element) -> void;
 
+        // Property of a serializable struct as declared by its operator(). The offset is relative to the object.
+        struct json_field
+        {
+            uint32_t hash;
+            std::string_view name;
+            size_t offset;
+            bool is_optional;
+            void (*decode)(serialize_ijson& input, simdjson::ondemand::value it, void* element);
+        };
+
+        class json_field_recorder
+        {
+          public:
+            json_field_recorder(uint8_t const* object, size_t const object_size, std::vector<json_field>& fields)
+                : object(object), object_size(object_size), fields(&fields)
+            {
+            }
+
+            template <typename Type>
+            auto property(Type& element, std::string_view const json_name) -> void
+            {
+                size_t const offset = reinterpret_cast<uint8_t const*>(&element) - object;
+                if (offset + sizeof(Type) > object_size)
+                {
+                    throw core::runtime_error("A serializable property must be a member of the object");
+                }
+
+                fields->emplace_back(json_field{.hash = crc32(json_name),
+                                                .name = json_name,
+                                                .offset = offset,
+                                                .is_optional = is_std_optional<Type>::value,
+                                                .decode = [](serialize_ijson& input, simdjson::ondemand::value it,
+                                                             void* element) {
+                                                    from_json(input, it, *static_cast<Type*>(element));
+                                                }});
+            }
+
+          private:
+            uint8_t const* object;
+            size_t object_size;
+            std::vector<json_field>* fields;
+        };
+
+        // Field table of a serializable struct, recorded once from its operator(). Property names are expected to be
+        // string literals.
+        template <typename Type>
+        auto json_fields() -> std::span<json_field const>
+        {
+            static std::vector<json_field> const fields = [] {
+                std::vector<json_field> fields;
+                Type prototype{};
+                json_field_recorder recorder(reinterpret_cast<uint8_t const*>(&prototype), sizeof(Type), fields);
+                prototype(recorder);
+
+                if (fields.size() > 64)
+                {
+                    throw core::runtime_error("A serializable object cannot have more than 64 properties");
+                }
+                return fields;
+            }();
+            return fields;
+        }
+
         template <typename Type>
         auto to_json(serialize_ojson& output, std::string_view const jsonName, Type const& element) -> void;
 
+        inline size_t constexpr blob_chunk_size = 64 * 1024;
+
         template <typename Type>
         auto from_binary(serialize_iarchive& input, Type& element) -> void;
 
@@ -165,37 +339,104 @@ namespace ionengine::core
         friend auto internal::from_json(serialize_ijson& input, simdjson::ondemand::value it, Type& element) -> void;
 
       public:
-        serialize_ijson(std::basic_istream<uint8_t>& stream) : stream(&stream)
+        serialize_ijson(std::basic_istream<uint8_t>& stream)
         {
             json_data = std::string(std::istreambuf_iterator<uint8_t>(stream.rdbuf()), {});
-            document = parser.iterate(json_data, json_data.size() + simdjson::SIMDJSON_PADDING);
+            json_data.reserve(json_data.size() + simdjson::SIMDJSON_PADDING);
+            parse(simdjson::padded_string_view(json_data.data(), json_data.size(), json_data.capacity()));
         }
 
-        template <typename Type>
-        auto property(Type& element, std::string_view const json_name) -> void
+        // Parses the document in place. The view has to stay valid while the archive is used.
+        serialize_ijson(simdjson::padded_string_view const json_view)
         {
-            internal::from_json(*this, document[json_name], element);
-        }
-
-        template <typename Type>
-        auto field(Type const& element, std::string_view const json_name) -> void
-        {
-            enum_fields[std::string(json_name)] = static_cast<uint32_t>(element);
+            parse(json_view);
         }
 
         template <typename Type>
         auto operator()(Type& object) -> size_t
         {
-            object(*this);
-            return stream->tellg();
+            simdjson::ondemand::object root;
+            auto error = document.get_object().get(root);
+            if (error != simdjson::SUCCESS)
+            {
+                throw core::runtime_error("An error occurred while deserializing a document");
+            }
+
+            read_object(root, object);
+            return json_size;
         }
 
       private:
         std::string json_data;
+        size_t json_size;
         simdjson::ondemand::parser parser;
-        simdjson::ondemand::document_stream::iterator::value_type document;
-        std::basic_istream<uint8_t>* stream;
-        std::unordered_map<std::string, uint32_t> enum_fields;
+        simdjson::ondemand::document document;
+
+        auto parse(simdjson::padded_string_view const json_view) -> void
+        {
+            json_size = json_view.size();
+
+            auto error = parser.iterate(json_view).get(document);
+            if (error != simdjson::SUCCESS)
+            {
+                throw core::runtime_error("An error occurred while deserializing a document");
+            }
+        }
+
+        // Walks the JSON object once and dispatches every key through the field table of the type
+        template <typename Type>
+        auto read_object(simdjson::ondemand::object& object, Type& element) -> void
+        {
+            auto const fields = internal::json_fields<Type>();
+            uint64_t found_fields = 0;
+            size_t cursor = 0;
+
+            for (auto result : object)
+            {
+                simdjson::ondemand::field field;
+                auto error = std::move(result).get(field);
+                if (error != simdjson::SUCCESS)
+                {
+                    throw core::runtime_error("An error occurred while deserializing a field");
+                }
+
+                std::string_view const key = field.escaped_key();
+                uint32_t const hash = crc32(key);
+
+                auto is_match = [&](size_t const index) {
+                    return !(found_fields & (1ull << index)) && fields[index].hash == hash &&
+                           fields[index].name == key;
+                };
+
+                // Keys are usually stored in declaration order, so the next field is checked first
+                size_t index = cursor;
+                if (index >= fields.size() || !is_match(index))
+                {
+                    index = 0;
+                    while (index < fields.size() && !is_match(index))
+                    {
+                        ++index;
+                    }
+                }
+
+                if (index == fields.size())
+                {
+                    continue;
+                }
+
+                found_fields |= 1ull << index;
+                cursor = index + 1;
+                fields[index].decode(*this, field.value(), reinterpret_cast<uint8_t*>(&element) + fields[index].offset);
+            }
+
+            for (size_t const i : std::views::iota(0u, fields.size()))
+            {
+                if (!(found_fields & (1ull << i)) && !fields[i].is_optional)
+                {
+                    throw core::runtime_error("An error occurred while deserializing a field");
+                }
+            }
+        }
     };
 
     namespace internal
@@ -227,14 +468,15 @@ namespace ionengine::core
             }
             else if constexpr (std::is_floating_point_v<Type>)
             {
-                simdjson::ondemand::number value;
-                auto error = it.get_number().get(value);
+                // Whole numbers are written without a fractional part, so they have to be accepted as well
+                double value;
+                auto error = it.get_double().get(value);
                 if (error != simdjson::SUCCESS)
                 {
                     throw core::runtime_error("An error occurred while deserializing a field");
                 }
 
-                element = static_cast<Type>(value.get_double());
+                element = static_cast<Type>(value);
             }
             else if constexpr (std::is_same_v<Type,
                                               std::basic_string<char, std::char_traits<char>, std::allocator<char>>>)
@@ -250,9 +492,6 @@ namespace ionengine::core
             }
             else if constexpr (std::is_scoped_enum_v<Type>)
             {
-                serializable_enum<Type> object;
-                object(input);
-
                 std::string_view value;
                 auto error = it.get_string().get(value);
                 if (error != simdjson::SUCCESS)
@@ -260,13 +499,29 @@ namespace ionengine::core
                     throw core::runtime_error("An error occurred while deserializing a field");
                 }
 
-                auto result = input.enum_fields.find(std::string(value));
-                if (result == input.enum_fields.end())
+                auto result = enum_from_string<Type>(value);
+                if (!result.has_value())
+                {
+                    throw core::runtime_error("An error occurred while deserializing a field");
+                }
+
+                element = result.value();
+            }
+            else if constexpr (std::is_same_v<Type, blob>)
+            {
+                std::string_view value;
+                auto error = it.get_string().get(value);
+                if (error != simdjson::SUCCESS)
                 {
                     throw core::runtime_error("An error occurred while deserializing a field");
                 }
 
-                element = static_cast<Type>(result->second);
+                auto result = base64::decode(value);
+                if (!result.has_value())
+                {
+                    throw core::runtime_error("An error occurred while deserializing a field");
+                }
+                element = std::move(result.value());
             }
             else if constexpr (is_std_vector<Type>::value)
             {
@@ -295,13 +550,11 @@ namespace ionengine::core
                         throw core::runtime_error("An error occurred while deserializing a field");
                     }
 
-                    element.resize(elements.count_elements());
-
-                    uint32_t i = 0;
+                    // Counting elements up front would skip over every nested value a second time
+                    element.clear();
                     for (auto e : elements)
                     {
-                        from_json(input, e.value(), element[i]);
-                        ++i;
+                        from_json(input, e.value(), element.emplace_back());
                     }
                 }
             }
@@ -360,16 +613,13 @@ namespace ionengine::core
                     }
                     else if constexpr (std::is_scoped_enum_v<typename Type::key_type>)
                     {
-                        serializable_enum<typename Type::key_type> object;
-                        object(input);
-
-                        auto result = input.enum_fields.find(std::string(key));
-                        if (result == input.enum_fields.end())
+                        auto result = enum_from_string<typename Type::key_type>(key);
+                        if (!result.has_value())
                         {
                             throw core::runtime_error("An error occurred while deserializing a field");
                         }
 
-                        element[static_cast<Type::key_type>(result->second)] = std::move(inserted_value);
+                        element[result.value()] = std::move(inserted_value);
                     }
                     else
                     {
@@ -395,20 +645,8 @@ namespace ionengine::core
                     throw core::runtime_error("An error occurred while deserializing a field");
                 }
 
-                std::string_view value;
-                error = object.raw_json().get(value);
-                if (error != simdjson::SUCCESS)
-                {
-                    throw core::runtime_error("An error occurred while deserializing a field");
-                }
-
-                std::basic_spanstream<uint8_t> temp_stream(
-                    std::span<uint8_t>(reinterpret_cast<uint8_t*>(const_cast<char*>(value.data())), value.size()));
-                serialize_ijson archive(temp_stream);
-                if (!(archive(element) > 0))
-                {
-                    throw core::runtime_error("An error occurred while deserializing a field");
-                }
+                // Nested objects are decoded in place from the parent document
+                input.read_object(object, element);
             }
         }
     } // namespace internal
@@ -422,7 +660,6 @@ namespace ionengine::core
       public:
         serialize_ojson(std::basic_ostream<uint8_t>& stream) : stream(&stream)
         {
-            json_chunk << "{";
         }
 
         template <typename Type>
@@ -432,27 +669,102 @@ namespace ionengine::core
         }
 
         template <typename Type>
-        auto field(Type const& element, std::string_view const json_name) -> void
+        auto operator()(Type const& object) -> size_t
         {
-            enum_fields[static_cast<uint32_t>(element)] = std::string(json_name);
+            json_buffer.clear();
+            write_object(object);
+
+            stream->write(reinterpret_cast<uint8_t const*>(json_buffer.data()), json_buffer.size());
+            return stream->tellp();
         }
 
+      private:
+        std::string json_buffer;
+        bool is_first_field = true;
+        std::basic_ostream<uint8_t>* stream;
+
         template <typename Type>
-        auto operator()(Type const& object) -> size_t
+        auto write_object(Type const& object) -> void
         {
+            bool const parent_first_field = std::exchange(is_first_field, true);
+            json_buffer += '{';
             const_cast<Type&>(object)(*this);
+            json_buffer += '}';
+            is_first_field = parent_first_field;
+        }
 
-            std::string raw_json = json_chunk.str();
-            raw_json = raw_json.substr(0, raw_json.size() - 1) + "}";
+        auto write_key(std::string_view const json_name) -> void
+        {
+            if (!is_first_field)
+            {
+                json_buffer += ',';
+            }
+            is_first_field = false;
 
-            stream->write(reinterpret_cast<uint8_t const*>(raw_json.data()), raw_json.size());
-            return stream->tellp();
+            write_string(json_name);
+            json_buffer += ':';
         }
 
-      private:
-        std::stringstream json_chunk;
-        std::basic_ostream<uint8_t>* stream;
-        std::unordered_map<uint32_t, std::string> enum_fields;
+        auto write_string(std::string_view const value) -> void
+        {
+            json_buffer += '"';
+            size_t last = 0;
+            for (size_t const i : std::views::iota(0u, value.size()))
+            {
+                char const c = value[i];
+                if (c != '"' && c != '\\' && static_cast<uint8_t>(c) >= 0x20)
+                {
+                    continue;
+                }
+
+                json_buffer.append(value.data() + last, i - last);
+                switch (c)
+                {
+                    case '"':
+                        json_buffer += "\\\"";
+                        break;
+                    case '\\':
+                        json_buffer += "\\\\";
+                        break;
+                    case '\n':
+                        json_buffer += "\\n";
+                        break;
+                    case '\r':
+                        json_buffer += "\\r";
+                        break;
+                    case '\t':
+                        json_buffer += "\\t";
+                        break;
+                    default: {
+                        std::array<char, 7> escaped;
+                        std::snprintf(escaped.data(), escaped.size(), "\\u%04x", static_cast<uint8_t>(c));
+                        json_buffer.append(escaped.data(), 6);
+                        break;
+                    }
+                }
+                last = i + 1;
+            }
+            json_buffer.append(value.data() + last, value.size() - last);
+            json_buffer += '"';
+        }
+
+        // Encodes straight into the buffer, base64 characters never need escaping
+        auto write_base64(std::span<uint8_t const> const value) -> void
+        {
+            size_t const offset = json_buffer.size();
+            json_buffer.resize(offset + base64::encoded_size(value.size()) + 2);
+            json_buffer[offset] = '"';
+            base64::encode(value, std::span<char>(json_buffer.data() + offset + 1, json_buffer.size() - offset - 2));
+            json_buffer.back() = '"';
+        }
+
+        template <typename Type>
+        auto write_number(Type const value) -> void
+        {
+            std::array<char, 32> chars;
+            auto const result = std::to_chars(chars.data(), chars.data() + chars.size(), value);
+            json_buffer.append(chars.data(), result.ptr);
+        }
     };
 
     namespace internal
@@ -460,168 +772,129 @@ namespace ionengine::core
         template <typename Type>
         auto to_json(serialize_ojson& output, std::string_view const json_name, Type const& element) -> void
         {
-            if constexpr (is_std_vector<Type>::value)
+            if constexpr (is_std_unique_ptr<Type>::value)
             {
+                to_json(output, json_name, *element);
+            }
+            else
+            {
+                // Array elements and map values are written without a key
                 if (!json_name.empty())
                 {
-                    output.json_chunk << "\"" << json_name << "\":";
+                    output.write_key(json_name);
                 }
 
-                if constexpr (std::is_same_v<typename Type::value_type, uint8_t>)
+                if constexpr (is_std_vector<Type>::value)
                 {
-                    std::string const encoded_string = base64::encode(element);
-                    output.json_chunk << "\"" << encoded_string << "\"";
+                    if constexpr (std::is_same_v<typename Type::value_type, uint8_t>)
+                    {
+                        output.write_base64(element);
+                    }
+                    else
+                    {
+                        output.json_buffer += '[';
+                        bool is_first = true;
+                        for (auto const& e : element)
+                        {
+                            if (!is_first)
+                            {
+                                output.json_buffer += ',';
+                            }
+                            to_json(output, "", e);
+                            is_first = false;
+                        }
+                        output.json_buffer += ']';
+                    }
                 }
-                else
+                else if constexpr (is_std_array<Type>::value)
                 {
-                    output.json_chunk << "[";
+                    output.json_buffer += '[';
                     bool is_first = true;
                     for (auto const& e : element)
                     {
                         if (!is_first)
                         {
-                            output.json_chunk << ",";
+                            output.json_buffer += ',';
                         }
                         to_json(output, "", e);
                         is_first = false;
                     }
-                    output.json_chunk << "]";
-                }
-
-                if (!json_name.empty())
-                {
-                    output.json_chunk << ",";
-                }
-            }
-            else if constexpr (is_std_array<Type>::value)
-            {
-                if (!json_name.empty())
-                {
-                    output.json_chunk << "\"" << json_name << "\":";
-                }
-
-                output.json_chunk << "[";
-                bool is_first = true;
-                for (auto const& e : element)
-                {
-                    if (!is_first)
-                    {
-                        output.json_chunk << ",";
-                    }
-                    to_json(output, "", e);
-                    is_first = false;
+                    output.json_buffer += ']';
                 }
-                output.json_chunk << "]";
-
-                if (!json_name.empty())
-                {
-                    output.json_chunk << ",";
-                }
-            }
-            else if constexpr (is_std_unique_ptr<Type>::value)
-            {
-                to_json(output, json_name, *element);
-            }
-            else if constexpr (is_std_unordered_map<Type>::value)
-            {
-                output.json_chunk << "\"" << json_name << "\":{";
-                bool is_first = true;
-                for (auto const& [key, value] : element)
+                else if constexpr (is_std_unordered_map<Type>::value)
                 {
-                    if (!is_first)
+                    bool const parent_first_field = std::exchange(output.is_first_field, true);
+                    output.json_buffer += '{';
+                    for (auto const& [key, value] : element)
                     {
-                        output.json_chunk << ",";
-                    }
-
-                    if constexpr (std::is_integral_v<typename Type::key_type>)
-                    {
-                        output.json_chunk << "\"" << std::to_string(key) << "\":";
-                        to_json(output, "", value);
-                    }
-                    else if constexpr (std::is_scoped_enum_v<typename Type::key_type>)
-                    {
-                        serializable_enum<typename Type::key_type> object;
-                        object(output);
-
-                        auto result = output.enum_fields.find(static_cast<uint32_t>(key));
-                        if (result == output.enum_fields.end())
+                        if constexpr (std::is_integral_v<typename Type::key_type>)
                         {
-                            throw core::runtime_error("An error occurred while serializing a field");
+                            std::array<char, 32> chars;
+                            auto const result = std::to_chars(chars.data(), chars.data() + chars.size(), key);
+                            output.write_key(std::string_view(chars.data(), result.ptr));
                         }
+                        else if constexpr (std::is_scoped_enum_v<typename Type::key_type>)
+                        {
+                            auto result = enum_to_string(key);
+                            if (!result.has_value())
+                            {
+                                throw core::runtime_error("An error occurred while serializing a field");
+                            }
 
-                        output.json_chunk << "\"" << result->second << "\":";
+                            output.write_key(result.value());
+                        }
+                        else
+                        {
+                            output.write_key(key);
+                        }
                         to_json(output, "", value);
                     }
+                    output.json_buffer += '}';
+                    output.is_first_field = parent_first_field;
+                }
+                else if constexpr (is_std_optional<Type>::value)
+                {
+                    if (element.has_value())
+                    {
+                        to_json(output, "", element.value());
+                    }
                     else
                     {
-                        output.json_chunk << "\"" << key << "\":";
-                        to_json(output, "", value);
+                        output.json_buffer += "null";
                     }
-                    is_first = false;
-                }
-                output.json_chunk << "},";
-            }
-            else if constexpr (is_std_optional<Type>::value)
-            {
-                output.json_chunk << "\"" << json_name << "\":";
-                if (element.has_value())
-                {
-                    to_json(output, "", element.value());
                 }
-                else
+                else if constexpr (std::is_integral_v<Type> && !std::is_same_v<Type, bool> ||
+                                   std::is_floating_point_v<Type>)
                 {
-                    output.json_chunk << "null";
-                }
-                output.json_chunk << ",";
-            }
-            else
-            {
-                if (!json_name.empty())
-                {
-                    output.json_chunk << "\"" << json_name << "\":";
-                }
-
-                if constexpr (std::is_integral_v<Type> && !std::is_same_v<Type, bool> || std::is_floating_point_v<Type>)
-                {
-                    output.json_chunk << element;
+                    output.write_number(element);
                 }
                 else if constexpr (std::is_integral_v<Type> && std::is_same_v<Type, bool>)
                 {
-                    output.json_chunk << std::boolalpha << element;
+                    output.json_buffer += element ? "true" : "false";
                 }
                 else if constexpr (std::is_same_v<
                                        Type, std::basic_string<char, std::char_traits<char>, std::allocator<char>>>)
                 {
-                    output.json_chunk << "\"" << element << "\"";
+                    output.write_string(element);
                 }
                 else if constexpr (std::is_scoped_enum_v<Type>)
                 {
-                    serializable_enum<Type> object;
-                    object(output);
-
-                    auto result = output.enum_fields.find(static_cast<uint32_t>(element));
-                    if (result == output.enum_fields.end())
+                    auto result = enum_to_string(element);
+                    if (!result.has_value())
                     {
                         throw core::runtime_error("An error occurred while serializing a field");
                     }
 
-                    output.json_chunk << "\"" << result->second << "\"";
+                    output.write_string(result.value());
                 }
-                else
+                else if constexpr (std::is_same_v<Type, blob>)
                 {
-                    std::basic_stringstream<uint8_t> temp_stream;
-                    serialize_ojson archive(temp_stream);
-                    if (archive(element) > 0)
-                    {
-                        std::basic_string<uint8_t> const raw_json = temp_stream.str();
-                        output.json_chunk
-                            << std::string_view(reinterpret_cast<char const*>(raw_json.data()), raw_json.size());
-                    }
+                    output.write_base64(element);
                 }
-
-                if (!json_name.empty())
+                else
                 {
-                    output.json_chunk << ",";
+                    // Nested objects are written in place into the parent buffer
+                    output.write_object(element);
                 }
             }
         }
@@ -635,6 +908,13 @@ namespace ionengine::core
       public:
         serialize_iarchive(std::basic_istream<uint8_t>& stream) : stream(&stream)
         {
+            std::streampos const offset = stream.tellg();
+            if (offset != std::streampos(-1))
+            {
+                stream.seekg(0, std::ios::end);
+                stream_end = stream.tellg();
+                stream.seekg(offset);
+            }
         }
 
         template <typename Type>
@@ -643,23 +923,53 @@ namespace ionengine::core
             internal::from_binary(*this, element);
         }
 
+        auto revision(uint32_t const revision) -> void
+        {
+            current_revision = revision;
+        }
+
         template <typename OutputArchive, typename InputArchive, typename Type>
         auto with(Type& element) -> void
         {
-            size_t buffer_size;
+            size_t buffer_size = 0;
             stream->read(reinterpret_cast<uint8_t*>(&buffer_size), sizeof(size_t));
 
-            std::vector<uint8_t> buffer(buffer_size);
-            stream->read(buffer.data(), buffer_size);
+            if (stream_end != std::streampos(-1) &&
+                buffer_size > static_cast<size_t>(stream_end - stream->tellg()))
+            {
+                throw core::runtime_error("An error occurred while deserializing a field");
+            }
 
-            std::basic_ispanstream<uint8_t> stream(
-                std::span<uint8_t>(const_cast<uint8_t*>(buffer.data()), buffer.size()), std::ios::binary);
-            auto result = deserialize<Type, InputArchive>(stream);
-            if (result.has_value())
+            // A mapped file is parsed in place when enough of it follows the embedded document to serve as padding
+            if (mapping)
             {
-                element = std::move(result.value());
+                auto const bytes = mapping->data();
+                size_t const offset = stream->tellg();
+                if (bytes.size() - offset - buffer_size >= simdjson::SIMDJSON_PADDING)
+                {
+                    InputArchive archive(simdjson::padded_string_view(
+                        reinterpret_cast<char const*>(bytes.data() + offset), buffer_size, bytes.size() - offset));
+                    if (!(archive(element) > 0))
+                    {
+                        throw core::runtime_error("An error occurred while deserializing a field");
+                    }
+
+                    stream->seekg(buffer_size, std::ios::cur);
+                    return;
+                }
             }
-            else
+
+            std::string buffer;
+            buffer.reserve(buffer_size + simdjson::SIMDJSON_PADDING);
+            buffer.resize(buffer_size);
+            stream->read(reinterpret_cast<uint8_t*>(buffer.data()), buffer_size);
+            if (stream->gcount() != static_cast<std::streamsize>(buffer_size))
+            {
+                throw core::runtime_error("An error occurred while deserializing a field");
+            }
+
+            InputArchive archive(simdjson::padded_string_view(buffer.data(), buffer.size(), buffer.capacity()));
+            if (!(archive(element) > 0))
             {
                 throw core::runtime_error("An error occurred while deserializing a field");
             }
@@ -672,8 +982,33 @@ namespace ionengine::core
             return stream->tellg();
         }
 
+      protected:
+        serialize_iarchive(ref_ptr<mapped_file> const& mapping)
+            : mapping(mapping),
+              mapped_stream(std::make_unique<std::basic_ispanstream<uint8_t>>(
+                  std::span<uint8_t>(const_cast<uint8_t*>(mapping->data().data()), mapping->data().size()),
+                  std::ios::binary))
+        {
+            stream = mapped_stream.get();
+            stream_end = mapping->data().size();
+        }
+
       private:
         std::basic_istream<uint8_t>* stream;
+        std::streampos stream_end = -1;
+        uint32_t current_revision = archive_revision::latest;
+        ref_ptr<mapped_file> mapping;
+        std::unique_ptr<std::basic_ispanstream<uint8_t>> mapped_stream;
+    };
+
+    // Binary input archive over a memory-mapped file. Blob fields are returned as views into the mapping instead of
+    // being copied into heap memory.
+    class serialize_imapped : public serialize_iarchive
+    {
+      public:
+        serialize_imapped(ref_ptr<mapped_file> const& mapping) : serialize_iarchive(mapping)
+        {
+        }
     };
 
     namespace internal
@@ -688,48 +1023,154 @@ namespace ionengine::core
             else if constexpr (std::is_same_v<Type,
                                               std::basic_string<char, std::char_traits<char>, std::allocator<char>>>)
             {
-                std::vector<uint8_t> buffer;
-                uint8_t value = 0x1;
-                while (static_cast<char>(value) != '\0')
+                if (input.current_revision < archive_revision::v11)
+                {
+                    std::basic_string<uint8_t> buffer;
+                    std::getline(*input.stream, buffer, uint8_t('\0'));
+                    if (input.stream->fail() || input.stream->eof())
+                    {
+                        throw core::runtime_error("An error occurred while deserializing a field");
+                    }
+
+                    element.assign(reinterpret_cast<char const*>(buffer.data()), buffer.size());
+                }
+                else
                 {
-                    if (input.stream->eof())
+                    size_t length = 0;
+                    input.stream->read(reinterpret_cast<uint8_t*>(&length), sizeof(size_t));
+
+                    // A corrupted length must not turn into an allocation larger than the input
+                    if (input.stream_end != std::streampos(-1) &&
+                        length > static_cast<size_t>(input.stream_end - input.stream->tellg()))
                     {
                         throw core::runtime_error("An error occurred while deserializing a field");
                     }
-                    input.stream->read(&value, 1);
-                    if (static_cast<char>(value) != '\0')
+
+                    element.resize(length);
+                    input.stream->read(reinterpret_cast<uint8_t*>(element.data()), length);
+                    if (input.stream->gcount() != static_cast<std::streamsize>(length))
+                    {
+                        throw core::runtime_error("An error occurred while deserializing a field");
+                    }
+                }
+            }
+            else if constexpr (std::is_same_v<Type, blob>)
+            {
+                size_t num_elements = 0;
+                input.stream->read(reinterpret_cast<uint8_t*>(&num_elements), sizeof(size_t));
+
+                uint32_t checksum = 0;
+                if (input.current_revision >= archive_revision::v12)
+                {
+                    input.stream->read(reinterpret_cast<uint8_t*>(&checksum), sizeof(uint32_t));
+                }
+
+                if (input.stream_end != std::streampos(-1) &&
+                    num_elements > static_cast<size_t>(input.stream_end - input.stream->tellg()))
+                {
+                    throw core::runtime_error("An error occurred while deserializing a field");
+                }
+
+                // Mapped blobs are not touched while loading, so their checksum is not verified here
+                if (input.mapping)
+                {
+                    auto const bytes = input.mapping->data();
+                    size_t const offset = input.stream->tellg();
+                    if (offset > bytes.size() || num_elements > bytes.size() - offset)
                     {
-                        buffer.emplace_back(value);
+                        throw core::runtime_error("An error occurred while deserializing a field");
                     }
+
+                    element = blob(input.mapping, bytes.subspan(offset, num_elements));
+                    input.stream->seekg(num_elements, std::ios::cur);
                 }
+                else if (input.current_revision >= archive_revision::v12)
+                {
+                    // The checksum is computed on each chunk right after it is read
+                    std::vector<uint8_t> buffer(num_elements);
+                    uint32_t buffer_checksum = 0;
+                    for (size_t offset = 0; offset < num_elements; offset += blob_chunk_size)
+                    {
+                        size_t const chunk_size = std::min(blob_chunk_size, num_elements - offset);
+                        input.stream->read(buffer.data() + offset, chunk_size);
+                        if (input.stream->gcount() != static_cast<std::streamsize>(chunk_size))
+                        {
+                            throw core::runtime_error("An error occurred while deserializing a field");
+                        }
+                        buffer_checksum = crc32(std::span<uint8_t const>(buffer.data() + offset, chunk_size),
+                                                buffer_checksum);
+                    }
 
-                element = std::string(reinterpret_cast<char*>(buffer.data()), buffer.size());
+                    if (buffer_checksum != checksum)
+                    {
+                        throw core::runtime_error("An error occurred while deserializing a field");
+                    }
+                    element = std::move(buffer);
+                }
+                else
+                {
+                    std::vector<uint8_t> buffer(num_elements);
+                    input.stream->read(buffer.data(), num_elements);
+                    if (input.stream->gcount() != static_cast<std::streamsize>(num_elements))
+                    {
+                        throw core::runtime_error("An error occurred while deserializing a field");
+                    }
+                    element = std::move(buffer);
+                }
             }
             else if constexpr (is_std_vector<Type>::value)
             {
                 size_t num_elements = 0;
                 input.stream->read(reinterpret_cast<uint8_t*>(&num_elements), sizeof(size_t));
                 element.resize(num_elements);
-                for (size_t const i : std::views::iota(0u, num_elements))
+
+                if constexpr (is_trivially_serializable<typename Type::value_type>::value &&
+                              !std::is_same_v<typename Type::value_type, bool>)
+                {
+                    std::streamsize const size_in_bytes = num_elements * sizeof(typename Type::value_type);
+                    input.stream->read(reinterpret_cast<uint8_t*>(element.data()), size_in_bytes);
+                    if (input.stream->gcount() != size_in_bytes)
+                    {
+                        throw core::runtime_error("An error occurred while deserializing a field");
+                    }
+                }
+                else
                 {
-                    from_binary(input, element[i]);
+                    for (size_t const i : std::views::iota(0u, num_elements))
+                    {
+                        from_binary(input, element[i]);
+                    }
                 }
             }
             else if constexpr (is_std_array<Type>::value)
             {
-                for (size_t const i : std::views::iota(0u, element.size()))
+                if constexpr (is_trivially_serializable<Type>::value)
+                {
+                    input.stream->read(reinterpret_cast<uint8_t*>(element.data()), sizeof(Type));
+                    if (input.stream->gcount() != sizeof(Type))
+                    {
+                        throw core::runtime_error("An error occurred while deserializing a field");
+                    }
+                }
+                else
                 {
-                    from_binary(input, element[i]);
+                    for (size_t const i : std::views::iota(0u, element.size()))
+                    {
+                        from_binary(input, element[i]);
+                    }
                 }
             }
             else if constexpr (std::is_scoped_enum_v<Type>)
             {
                 input.stream->read(reinterpret_cast<uint8_t*>(&element), sizeof(typename std::underlying_type_t<Type>));
             }
+            else if constexpr (is_trivially_serializable<Type>::value)
+            {
+                input.stream->read(reinterpret_cast<uint8_t*>(&element), sizeof(Type));
+            }
             else
             {
-                serialize_iarchive archive(*input.stream);
-                if (!(archive(element) > 0))
+                if (!(input(element) > 0))
                 {
                     throw core::runtime_error("An error occurred while deserializing a field");
                 }
@@ -753,9 +1194,35 @@ namespace ionengine::core
             internal::to_binary(*this, element);
         }
 
+        auto revision(uint32_t const revision) -> void
+        {
+            current_revision = revision;
+        }
+
         template <typename OutputArchive, typename InputArchive, typename Type>
         auto with(Type const& element) -> void
         {
+            // Reserve the size, serialize straight into the output and patch the size afterwards
+            std::streampos const size_offset = stream->tellp();
+            if (size_offset != std::streampos(-1))
+            {
+                size_t buffer_size = 0;
+                stream->write(reinterpret_cast<uint8_t const*>(&buffer_size), sizeof(size_t));
+
+                OutputArchive archive(*stream);
+                if (!(archive(element) > 0))
+                {
+                    throw core::runtime_error("An error occurred while serializing a field");
+                }
+
+                std::streampos const end_offset = stream->tellp();
+                buffer_size = static_cast<size_t>(end_offset - size_offset) - sizeof(size_t);
+                stream->seekp(size_offset);
+                stream->write(reinterpret_cast<uint8_t const*>(&buffer_size), sizeof(size_t));
+                stream->seekp(end_offset);
+                return;
+            }
+
             std::basic_stringstream<uint8_t> temp_stream;
             if (serialize<Type, OutputArchive>(element, temp_stream) > 0)
             {
@@ -779,6 +1246,7 @@ namespace ionengine::core
 
       private:
         std::basic_ostream<uint8_t>* stream;
+        uint32_t current_revision = archive_revision::latest;
     };
 
     namespace internal
@@ -786,20 +1254,71 @@ namespace ionengine::core
         template <typename Type>
         auto to_binary(serialize_oarchive& output, Type const& element) -> void
         {
-            if constexpr (is_std_vector<Type>::value)
+            if constexpr (std::is_same_v<Type, blob>)
             {
                 size_t const num_elements = element.size();
                 output.stream->write(reinterpret_cast<uint8_t const*>(&num_elements), sizeof(size_t));
-                for (auto const& e : element)
+
+                std::streampos const checksum_offset = output.stream->tellp();
+                if (output.current_revision < archive_revision::v12)
+                {
+                    output.stream->write(element.data(), num_elements);
+                }
+                else if (checksum_offset == std::streampos(-1))
+                {
+                    uint32_t const checksum = crc32(element);
+                    output.stream->write(reinterpret_cast<uint8_t const*>(&checksum), sizeof(uint32_t));
+                    output.stream->write(element.data(), num_elements);
+                }
+                else
                 {
-                    to_binary(output, e);
+                    // The checksum is computed on each chunk right before it is written and patched in afterwards
+                    uint32_t checksum = 0;
+                    output.stream->write(reinterpret_cast<uint8_t const*>(&checksum), sizeof(uint32_t));
+                    for (size_t offset = 0; offset < num_elements; offset += blob_chunk_size)
+                    {
+                        size_t const chunk_size = std::min(blob_chunk_size, num_elements - offset);
+                        checksum = crc32(std::span<uint8_t const>(element.data() + offset, chunk_size), checksum);
+                        output.stream->write(element.data() + offset, chunk_size);
+                    }
+
+                    std::streampos const end_offset = output.stream->tellp();
+                    output.stream->seekp(checksum_offset);
+                    output.stream->write(reinterpret_cast<uint8_t const*>(&checksum), sizeof(uint32_t));
+                    output.stream->seekp(end_offset);
+                }
+            }
+            else if constexpr (is_std_vector<Type>::value)
+            {
+                size_t const num_elements = element.size();
+                output.stream->write(reinterpret_cast<uint8_t const*>(&num_elements), sizeof(size_t));
+
+                if constexpr (is_trivially_serializable<typename Type::value_type>::value &&
+                              !std::is_same_v<typename Type::value_type, bool>)
+                {
+                    output.stream->write(reinterpret_cast<uint8_t const*>(element.data()),
+                                         num_elements * sizeof(typename Type::value_type));
+                }
+                else
+                {
+                    for (auto const& e : element)
+                    {
+                        to_binary(output, e);
+                    }
                 }
             }
             else if constexpr (is_std_array<Type>::value)
             {
-                for (auto const& e : element)
+                if constexpr (is_trivially_serializable<Type>::value)
+                {
+                    output.stream->write(reinterpret_cast<uint8_t const*>(element.data()), sizeof(Type));
+                }
+                else
                 {
-                    to_binary(output, e);
+                    for (auto const& e : element)
+                    {
+                        to_binary(output, e);
+                    }
                 }
             }
             else
@@ -811,19 +1330,31 @@ namespace ionengine::core
                 else if constexpr (std::is_same_v<
                                        Type, std::basic_string<char, std::char_traits<char>, std::allocator<char>>>)
                 {
-                    output.stream->write(reinterpret_cast<uint8_t const*>(element.data()), element.size());
-                    char end_of_string = '\0';
-                    output.stream->write(reinterpret_cast<uint8_t const*>(&end_of_string), sizeof(char));
+                    if (output.current_revision < archive_revision::v11)
+                    {
+                        output.stream->write(reinterpret_cast<uint8_t const*>(element.data()), element.size());
+                        char end_of_string = '\0';
+                        output.stream->write(reinterpret_cast<uint8_t const*>(&end_of_string), sizeof(char));
+                    }
+                    else
+                    {
+                        size_t const length = element.size();
+                        output.stream->write(reinterpret_cast<uint8_t const*>(&length), sizeof(size_t));
+                        output.stream->write(reinterpret_cast<uint8_t const*>(element.data()), length);
+                    }
                 }
                 else if constexpr (std::is_scoped_enum_v<Type>)
                 {
                     auto value = static_cast<typename std::underlying_type_t<Type>>(element);
                     output.stream->write(reinterpret_cast<uint8_t const*>(&value), sizeof(Type));
                 }
+                else if constexpr (is_trivially_serializable<Type>::value)
+                {
+                    output.stream->write(reinterpret_cast<uint8_t const*>(&element), sizeof(Type));
+                }
                 else
                 {
-                    serialize_oarchive archive(*output.stream);
-                    if (!(archive(element) > 0))
+                    if (!(output(element) > 0))
                     {
                         throw core::runtime_error("An error occurred while serializing a field");
                     }
@@ -863,22 +1394,41 @@ namespace ionengine::core
     template <typename Type, typename Archive>
     auto from_file(std::filesystem::path const& file_path) -> std::optional<Type>
     {
-        std::basic_ifstream<uint8_t> stream(file_path, std::ios::binary);
-        if (!stream.is_open())
+        if constexpr (std::is_same_v<Archive, serialize_imapped>)
         {
-            return std::nullopt;
+            ref_ptr<mapped_file> mapping;
+            try
+            {
+                mapping = make_ref<mapped_file>(file_path);
+            }
+            catch (core::runtime_error const&)
+            {
+                return std::nullopt;
+            }
+            return deserialize<Type, Archive>(mapping);
+        }
+        else
+        {
+            std::basic_ifstream<uint8_t> stream(file_path, std::ios::binary);
+            if (!stream.is_open())
+            {
+                return std::nullopt;
+            }
+            return deserialize<Type, Archive>(stream);
         }
-        return deserialize<Type, Archive>(stream);
     }
 
     template <typename Type, typename Archive>
     auto to_file(Type const& object, std::filesystem::path const& file_path) -> bool
     {
-        std::basic_ofstream<uint8_t> stream(file_path, std::ios::binary);
-        if (!stream.is_open())
+        async_filebuf buffer;
+        if (!buffer.open(file_path))
         {
             return false;
         }
-        return serialize<Type, Archive>(object, stream) > 0;
+
+        std::basic_ostream<uint8_t> stream(&buffer);
+        bool const is_serialized = serialize<Type, Archive>(object, stream) > 0;
+        return buffer.close() && is_serialized;
     }
 } // namespace ionengine::core
\ No newline at end of file
@@ -2,53 +2,477 @@
 
 #pragma once
 
+#include "core/error.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
 namespace ionengine::core
 {
-    inline auto subprocessExecute(std::span<std::string const> const arguments) -> std::optional<std::vector<uint8_t>>
+    struct subprocess_result
     {
-        std::array<uint8_t, 256> buffer;
-        std::vector<uint8_t> result;
+        int32_t exit_code;
+        std::vector<uint8_t> output;
+        std::vector<uint8_t> errors;
+        bool is_timed_out;
+    };
 
-        std::stringstream stream;
+    struct subprocess_options
+    {
+        // Called from the pool thread with each chunk as soon as it is read
+        std::function<void(std::span<uint8_t const>)> on_output = {};
+        std::function<void(std::span<uint8_t const>)> on_errors = {};
+        // The child is killed once it runs longer
+        std::optional<std::chrono::milliseconds> timeout = std::nullopt;
+    };
 
-        bool isFirst = true;
-        for (auto const& argument : arguments)
+    // Runs child processes without blocking the caller. At most max_running children are alive at once, the rest
+    // wait in a queue. On POSIX a single thread waits on every pipe with epoll. On Windows every child is read by
+    // its own thread through _popen, which merges nothing into errors and cannot enforce the timeout.
+    class subprocess_pool
+    {
+      public:
+        subprocess_pool(uint32_t const max_running = std::max(std::thread::hardware_concurrency(), 1u))
+            : max_running(max_running)
         {
-            if (!isFirst)
+#ifndef _WIN32
+            epoll = ::epoll_create1(EPOLL_CLOEXEC);
+            wakeup = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+            if (epoll == -1 || wakeup == -1)
             {
-                stream << " ";
+                throw core::runtime_error("An error occurred while creating the subprocess pool");
             }
-            stream << argument;
-            isFirst = false;
+
+            ::epoll_event event{.events = EPOLLIN, .data = {.ptr = nullptr}};
+            ::epoll_ctl(epoll, EPOLL_CTL_ADD, wakeup, &event);
+#endif
+            thread = std::thread([this]() { run(); });
         }
 
-        FILE* pipe = ::_popen(stream.str().c_str(), "rb");
-        if (!pipe)
+        // Waits for every queued and running child
+        ~subprocess_pool()
         {
-            return std::nullopt;
+            {
+                std::lock_guard lock(mutex);
+                is_stopped = true;
+            }
+            notify();
+            thread.join();
+#ifndef _WIN32
+            ::close(wakeup);
+            ::close(epoll);
+#endif
         }
 
-        try
+        subprocess_pool(subprocess_pool const&) = delete;
+
+        auto operator=(subprocess_pool const&) -> subprocess_pool& = delete;
+
+        // The first argument is the program, looked up in PATH. Arguments are passed as they are, without a shell.
+        auto execute(std::vector<std::string> arguments,
+                     subprocess_options options = {}) -> std::future<subprocess_result>
+        {
+            auto process = std::make_unique<job>();
+            process->arguments = std::move(arguments);
+            process->options = std::move(options);
+            auto future = process->promise.get_future();
+            {
+                std::lock_guard lock(mutex);
+                pending.emplace(std::move(process));
+            }
+            notify();
+            return future;
+        }
+
+      private:
+        struct job
+        {
+            std::vector<std::string> arguments;
+            subprocess_options options;
+            std::promise<subprocess_result> promise;
+            subprocess_result result{};
+            std::chrono::steady_clock::time_point deadline;
+#ifndef _WIN32
+            pid_t pid = -1;
+            int32_t output_fd = -1;
+            int32_t errors_fd = -1;
+            int32_t pid_fd = -1;
+            bool is_exited = false;
+#else
+            std::thread thread;
+            std::atomic<bool> is_finished = false;
+#endif
+        };
+
+        uint32_t max_running;
+        std::mutex mutex;
+        std::queue<std::unique_ptr<job>> pending;
+        std::vector<std::unique_ptr<job>> running;
+        bool is_stopped = false;
+        std::thread thread;
+
+#ifndef _WIN32
+        int32_t epoll = -1;
+        int32_t wakeup = -1;
+
+        auto notify() -> void
+        {
+            uint64_t const value = 1;
+            [[maybe_unused]] auto const result = ::write(wakeup, &value, sizeof(value));
+        }
+
+        auto run() -> void
+        {
+            std::array<::epoll_event, 32> events;
+            while (true)
+            {
+                {
+                    std::lock_guard lock(mutex);
+                    while (!pending.empty() && running.size() < max_running)
+                    {
+                        auto process = std::move(pending.front());
+                        pending.pop();
+                        if (start(*process))
+                        {
+                            running.emplace_back(std::move(process));
+                        }
+                    }
+
+                    if (is_stopped && pending.empty() && running.empty())
+                    {
+                        break;
+                    }
+                }
+
+                int32_t const count = ::epoll_wait(epoll, events.data(), events.size(), next_timeout());
+                for (int32_t const i : std::views::iota(0, std::max(count, 0)))
+                {
+                    if (!events[i].data.ptr)
+                    {
+                        uint64_t value;
+                        [[maybe_unused]] auto const result = ::read(wakeup, &value, sizeof(value));
+                        continue;
+                    }
+
+                    auto& process = *static_cast<job*>(events[i].data.ptr);
+                    read_pipe(process.output_fd, process.result.output, process.options.on_output);
+                    read_pipe(process.errors_fd, process.result.errors, process.options.on_errors);
+                    if (process.pid_fd != -1)
+                    {
+                        reap(process, WNOHANG);
+                    }
+                }
+
+                kill_timed_out();
+                complete_finished();
+            }
+        }
+
+        auto start(job& process) -> bool
         {
-            while (pipe)
+            std::array<int32_t, 2> output_pipe;
+            std::array<int32_t, 2> errors_pipe;
+            if (::pipe2(output_pipe.data(), O_CLOEXEC) != 0)
+            {
+                fail(process, "An error occurred while creating a pipe");
+                return false;
+            }
+            if (::pipe2(errors_pipe.data(), O_CLOEXEC) != 0)
+            {
+                ::close(output_pipe[0]);
+                ::close(output_pipe[1]);
+                fail(process, "An error occurred while creating a pipe");
+                return false;
+            }
+
+            ::posix_spawn_file_actions_t actions;
+            ::posix_spawn_file_actions_init(&actions);
+            ::posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+            ::posix_spawn_file_actions_adddup2(&actions, output_pipe[1], STDOUT_FILENO);
+            ::posix_spawn_file_actions_adddup2(&actions, errors_pipe[1], STDERR_FILENO);
+
+            std::vector<char*> argv;
+            for (auto& argument : process.arguments)
             {
-                size_t const read_bytes = ::fread(buffer.data(), sizeof(uint8_t), 128, pipe);
-                if (read_bytes > 0)
+                argv.emplace_back(argument.data());
+            }
+            argv.emplace_back(nullptr);
+
+            int32_t const error = argv.size() > 1
+                                      ? ::posix_spawnp(&process.pid, argv[0], &actions, nullptr, argv.data(), environ)
+                                      : EINVAL;
+            ::posix_spawn_file_actions_destroy(&actions);
+            ::close(output_pipe[1]);
+            ::close(errors_pipe[1]);
+            if (error != 0)
+            {
+                ::close(output_pipe[0]);
+                ::close(errors_pipe[0]);
+                fail(process, "An error occurred while starting the subprocess");
+                return false;
+            }
+
+            // Only the ends read by the pool are non-blocking, the child writes as usual
+            process.output_fd = output_pipe[0];
+            process.errors_fd = errors_pipe[0];
+            ::fcntl(process.output_fd, F_SETFL, O_NONBLOCK);
+            ::fcntl(process.errors_fd, F_SETFL, O_NONBLOCK);
+            if (process.options.timeout.has_value())
+            {
+                process.deadline = std::chrono::steady_clock::now() + process.options.timeout.value();
+            }
+
+            ::epoll_event event{.events = EPOLLIN, .data = {.ptr = &process}};
+            ::epoll_ctl(epoll, EPOLL_CTL_ADD, process.output_fd, &event);
+            ::epoll_ctl(epoll, EPOLL_CTL_ADD, process.errors_fd, &event);
+
+            // Exit is observed through a pidfd where available, otherwise after both pipes are closed
+#ifdef SYS_pidfd_open
+            process.pid_fd = static_cast<int32_t>(::syscall(SYS_pidfd_open, process.pid, 0));
+            if (process.pid_fd != -1)
+            {
+                ::epoll_ctl(epoll, EPOLL_CTL_ADD, process.pid_fd, &event);
+            }
+#endif
+            return true;
+        }
+
+        auto read_pipe(int32_t& fd, std::vector<uint8_t>& buffer,
+                       std::function<void(std::span<uint8_t const>)> const& callback) -> void
+        {
+            if (fd == -1)
+            {
+                return;
+            }
+
+            std::array<uint8_t, 64 * 1024> chunk;
+            while (true)
+            {
+                ssize_t const size = ::read(fd, chunk.data(), chunk.size());
+                if (size > 0)
                 {
-                    result.insert(result.end(), buffer.begin(), std::next(buffer.begin(), read_bytes));
+                    buffer.insert(buffer.end(), chunk.begin(), chunk.begin() + size);
+                    if (callback)
+                    {
+                        callback(std::span<uint8_t const>(chunk.data(), size));
+                    }
+                }
+                else if (size == -1 && errno == EINTR)
+                {
+                    continue;
                 }
                 else
                 {
+                    // Closed by the child or drained for now
+                    if (size == 0 || errno != EAGAIN)
+                    {
+                        ::epoll_ctl(epoll, EPOLL_CTL_DEL, fd, nullptr);
+                        ::close(fd);
+                        fd = -1;
+                    }
                     break;
                 }
             }
-            _pclose(pipe);
-            return result;
         }
-        catch (...)
+
+        auto reap(job& process, int32_t const options) -> void
+        {
+            int32_t status = 0;
+            if (::waitpid(process.pid, &status, options) != process.pid)
+            {
+                return;
+            }
+
+            process.is_exited = true;
+            if (process.pid_fd != -1)
+            {
+                ::epoll_ctl(epoll, EPOLL_CTL_DEL, process.pid_fd, nullptr);
+                ::close(process.pid_fd);
+                process.pid_fd = -1;
+            }
+
+            if (WIFEXITED(status))
+            {
+                process.result.exit_code = WEXITSTATUS(status);
+            }
+            else if (WIFSIGNALED(status))
+            {
+                process.result.exit_code = 128 + WTERMSIG(status);
+            }
+        }
+
+        auto next_timeout() -> int32_t
+        {
+            std::lock_guard lock(mutex);
+            std::optional<std::chrono::steady_clock::time_point> nearest;
+            for (auto const& process : running)
+            {
+                if (process->options.timeout.has_value() && !process->result.is_timed_out && !process->is_exited)
+                {
+                    nearest = nearest.has_value() ? std::min(nearest.value(), process->deadline) : process->deadline;
+                }
+            }
+
+            if (!nearest.has_value())
+            {
+                return -1;
+            }
+            auto const remaining = std::chrono::ceil<std::chrono::milliseconds>(nearest.value() -
+                                                                               std::chrono::steady_clock::now());
+            return static_cast<int32_t>(std::max<int64_t>(remaining.count(), 0));
+        }
+
+        // A reaped child's pid may already belong to another process, so only children not reaped yet are signaled
+        auto kill_timed_out() -> void
+        {
+            auto const now = std::chrono::steady_clock::now();
+            std::lock_guard lock(mutex);
+            for (auto const& process : running)
+            {
+                if (process->options.timeout.has_value() && !process->result.is_timed_out && !process->is_exited &&
+                    now >= process->deadline)
+                {
+#ifdef SYS_pidfd_send_signal
+                    if (process->pid_fd != -1)
+                    {
+                        ::syscall(SYS_pidfd_send_signal, process->pid_fd, SIGKILL, nullptr, 0);
+                    }
+                    else
+                    {
+                        ::kill(process->pid, SIGKILL);
+                    }
+#else
+                    ::kill(process->pid, SIGKILL);
+#endif
+                    process->result.is_timed_out = true;
+                }
+            }
+        }
+
+        auto complete_finished() -> void
+        {
+            std::lock_guard lock(mutex);
+            std::erase_if(running, [this](auto& process) {
+                if (process->output_fd != -1 || process->errors_fd != -1)
+                {
+                    return false;
+                }
+
+                if (!process->is_exited)
+                {
+                    // Without a pidfd the pipes closing is the only signal, the child is about to exit
+                    reap(*process, process->pid_fd != -1 ? WNOHANG : 0);
+                    if (!process->is_exited)
+                    {
+                        return false;
+                    }
+                }
+                process->promise.set_value(std::move(process->result));
+                return true;
+            });
+        }
+
+        auto fail(job& process, std::string_view const message) -> void
+        {
+            process.promise.set_exception(std::make_exception_ptr(core::runtime_error(message)));
+        }
+#else
+        std::condition_variable condition;
+
+        auto notify() -> void
+        {
+            condition.notify_all();
+        }
+
+        auto run() -> void
+        {
+            std::unique_lock lock(mutex);
+            while (true)
+            {
+                std::erase_if(running, [](auto& process) {
+                    if (!process->is_finished)
+                    {
+                        return false;
+                    }
+                    process->thread.join();
+                    return true;
+                });
+
+                while (!pending.empty() && running.size() < max_running)
+                {
+                    auto process = std::move(pending.front());
+                    pending.pop();
+                    process->thread = std::thread([this, process = process.get()]() {
+                        execute_blocking(*process);
+                        {
+                            std::lock_guard lock(mutex);
+                            process->is_finished = true;
+                        }
+                        notify();
+                    });
+                    running.emplace_back(std::move(process));
+                }
+
+                if (is_stopped && pending.empty() && running.empty())
+                {
+                    break;
+                }
+                condition.wait(lock);
+            }
+        }
+
+        auto execute_blocking(job& process) -> void
+        {
+            std::string command;
+            for (auto const& argument : process.arguments)
+            {
+                command += command.empty() ? argument : " " + argument;
+            }
+
+            FILE* pipe = ::_popen(command.c_str(), "rb");
+            if (!pipe)
+            {
+                process.promise.set_exception(
+                    std::make_exception_ptr(core::runtime_error("An error occurred while starting the subprocess")));
+                return;
+            }
+
+            std::array<uint8_t, 64 * 1024> chunk;
+            while (size_t const size = ::fread(chunk.data(), sizeof(uint8_t), chunk.size(), pipe))
+            {
+                process.result.output.insert(process.result.output.end(), chunk.begin(), chunk.begin() + size);
+                if (process.options.on_output)
+                {
+                    process.options.on_output(std::span<uint8_t const>(chunk.data(), size));
+                }
+            }
+            process.result.exit_code = ::_pclose(pipe);
+            process.promise.set_value(std::move(process.result));
+        }
+#endif
+    };
+
+    // Runs through a pool shared by every caller, created on first use
+    inline auto subprocessExecute(std::span<std::string const> const arguments) -> std::optional<std::vector<uint8_t>>
+    {
+        static subprocess_pool pool;
+        try
+        {
+            return pool.execute(std::vector<std::string>(arguments.begin(), arguments.end())).get().output;
+        }
+        catch (core::runtime_error const&)
         {
-            _pclose(pipe);
             return std::nullopt;
         }
     }
-} // namespace ionengine::core
\ No newline at end of file
+} // namespace ionengine::core
@@ -36,14 +36,20 @@ namespace ionengine
                              std::span<uint8_t const>(modelFile.blob.data() + bufferData.offset, bufferData.size))
                 .wait();
 
-            auto surface = core::make_ref<Surface>(vertexBuffer, indexBuffer, surfaceData.indexCount);
-            surfaces.emplace_back(surface);
+            rhi::IndexFormat const indexFormat = surfaceData.indexFormat == asset::mdl::IndexFormat::UINT16
+                                                     ? rhi::IndexFormat::Uint16
+                                                     : rhi::IndexFormat::Uint32;
+            uint64_t const vertexOffset =
+                static_cast<uint64_t>(surfaceData.vertexOffset.value_or(0)) * modelFile.modelData.vertexLayout.size;
+
+            surfaces.emplace_back(core::make_ref<Surface>(vertexBuffer, vertexOffset, std::move(indexBuffer),
+                                                          surfaceData.indexCount, indexFormat));
         }
     }
 
     auto Model::setMaterial(uint32_t const index, core::ref_ptr<Material> material) -> void
     {
-        materials[index] = material;
+        materials[index] = std::move(material);
     }
 
     auto Model::getSurfaces() const -> std::span<core::ref_ptr<Surface> const>
@@ -16,7 +16,8 @@ namespace ionengine
 
         auto push(core::ref_ptr<Surface> surface, core::ref_ptr<Material> material, uint16_t const layer) -> void
         {
-            elements.emplace_back(Element{.surface = surface, .material = material, .layer = layer});
+            elements.emplace_back(
+                Element{.surface = std::move(surface), .material = std::move(material), .layer = layer});
         }
 
       private:
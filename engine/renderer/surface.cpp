@@ -5,16 +5,18 @@
 
 namespace ionengine
 {
-    Surface::Surface(core::ref_ptr<rhi::Buffer> vertexBuffer, core::ref_ptr<rhi::Buffer> indexBuffer,
-                     uint32_t const indexCount)
-        : vertexBuffer(vertexBuffer), indexBuffer(indexBuffer), indexCount(indexCount)
+    Surface::Surface(core::ref_ptr<rhi::Buffer> vertexBuffer, uint64_t const vertexOffset,
+                     core::ref_ptr<rhi::Buffer> indexBuffer, uint32_t const indexCount,
+                     rhi::IndexFormat const indexFormat)
+        : vertexBuffer(std::move(vertexBuffer)), vertexOffset(vertexOffset), indexBuffer(std::move(indexBuffer)),
+          indexCount(indexCount), indexFormat(indexFormat)
     {
     }
 
     auto Surface::draw(rhi::GraphicsContext& context) -> void
     {
-        context.bindVertexBuffer(vertexBuffer, 0, vertexBuffer->getSize());
-        context.bindIndexBuffer(indexBuffer, 0, indexBuffer->getSize(), rhi::IndexFormat::Uint32);
+        context.bindVertexBuffer(vertexBuffer, vertexOffset, vertexBuffer->getSize() - vertexOffset);
+        context.bindIndexBuffer(indexBuffer, 0, indexBuffer->getSize(), indexFormat);
         context.drawIndexed(indexCount, 1);
     }
 }
\ No newline at end of file
@@ -9,14 +9,17 @@ namespace ionengine
     class Surface : public core::ref_counted_object
     {
       public:
-        Surface(core::ref_ptr<rhi::Buffer> vertexBuffer, core::ref_ptr<rhi::Buffer> indexBuffer,
-                uint32_t const indexCount);
+        Surface(core::ref_ptr<rhi::Buffer> vertexBuffer, uint64_t const vertexOffset,
+                core::ref_ptr<rhi::Buffer> indexBuffer, uint32_t const indexCount, rhi::IndexFormat const indexFormat);
 
         auto draw(rhi::GraphicsContext& context) -> void;
 
       private:
         core::ref_ptr<rhi::Buffer> vertexBuffer;
+        // Byte offset of the first vertex the indices refer to
+        uint64_t vertexOffset;
         core::ref_ptr<rhi::Buffer> indexBuffer;
         uint32_t indexCount;
+        rhi::IndexFormat indexFormat;
     };
 }
\ No newline at end of file
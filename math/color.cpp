@@ -1,41 +1,180 @@
 // Copyright © 2020-2021 Dmitriy Lukovenko. All rights reserved.
 
 #include "math/color.hpp"
+#include "math/simd.hpp"
 #include "precompiled.h"
 
 namespace ionengine::math
 {
-    auto Color::srgb() -> Color&
+    namespace
     {
-        for (size_t const i : std::views::iota(0u, 3u))
+        auto toLinear(float const color) -> float
         {
-            float color = (&r)[i];
-            if (color < 0.0031308f)
+            if (color <= 0.040448643f)
             {
-                color = color * 12.92f;
+                return color / 12.92f;
             }
             else
             {
-                color = 1.055f * std::powf(color, 1.0f / 2.4f) - 0.05499995f;
+                return std::pow((color + 0.055f) / 1.055f, 2.4f);
             }
         }
-        return *this;
-    }
 
-    auto Color::rgb() -> Color&
-    {
-        for (size_t const i : std::views::iota(0u, 3u))
+        auto toSrgb(float const color) -> float
         {
-            float color = (&r)[i];
-            if (color <= 0.040448643f)
+            if (color < 0.0031308f)
             {
-                color = color / 12.92f;
+                return color * 12.92f;
             }
             else
             {
-                color = std::powf((color + 0.055f) / 1.055f, 2.4f);
+                return 1.055f * std::pow(color, 1.0f / 2.4f) - 0.05499995f;
+            }
+        }
+
+        // Horner scheme, coefficients from the constant term up
+        template <size_t Size>
+        auto polynomial(simd::float4 const x, std::array<float, Size> const& coefficients) -> simd::float4
+        {
+            simd::float4 result = simd::splat(coefficients[Size - 1]);
+            [&]<size_t... Indices>(std::index_sequence<Indices...>) {
+                ((result = simd::add(simd::mul(result, x), simd::splat(coefficients[Size - 2 - Indices]))), ...);
+            }(std::make_index_sequence<Size - 1>{});
+            return result;
+        }
+
+        // Chebyshev fits of ((x + 0.055) / 1.055) ^ 2.4 on [0.04045, 1] and of 1.055 * x ^ (5 / 3) - 0.055 on
+        // [0.0031308 ^ (1 / 4), 1], the second is evaluated at the fourth root of the linear value
+        constexpr std::array<float, 7> toLinearCoefficients{0.000931145449f, 0.0326325297f, 0.515857697f,
+                                                            0.700870752f,    -0.406270951f, 0.203136593f,
+                                                            -0.0471605808f};
+        constexpr std::array<float, 6> toSrgbCoefficients{-0.0616297051f, 0.164974004f,  1.24421394f,
+                                                          -0.557555676f,  0.272752255f, -0.0627589896f};
+
+        auto toLinear(simd::float4 const color) -> simd::float4
+        {
+            simd::float4 const clamped = simd::min(simd::max(color, simd::splat(0.0f)), simd::splat(1.0f));
+            return simd::select(simd::less(clamped, simd::splat(0.04045f)),
+                                simd::mul(clamped, simd::splat(1.0f / 12.92f)),
+                                polynomial(clamped, toLinearCoefficients));
+        }
+
+        auto toSrgb(simd::float4 const color) -> simd::float4
+        {
+            simd::float4 const clamped = simd::min(simd::max(color, simd::splat(0.0f)), simd::splat(1.0f));
+            return simd::select(simd::less(clamped, simd::splat(0.0031308f)), simd::mul(clamped, simd::splat(12.92f)),
+                                polynomial(simd::sqrt(simd::sqrt(clamped)), toSrgbCoefficients));
+        }
+
+        // Converts the color lanes of every pixel, one pixel per float4 and four pixels per iteration
+        template <typename Function>
+        auto convertPixels(std::span<float> pixels, Function&& function) -> void
+        {
+            assert(pixels.size() % 4 == 0 && "pixels are not RGBA");
+
+            // Set for the color lanes, clear for alpha
+            simd::float4 const colorMask = simd::less(simd::set(0.0f, 0.0f, 0.0f, 1.0f), simd::splat(0.5f));
+            auto const convert = [&](float* pixel) {
+                simd::float4 const value = simd::load(pixel);
+                simd::store(pixel, simd::select(colorMask, function(value), value));
+            };
+
+            size_t const count = pixels.size() / 16 * 16;
+            for (size_t i = 0; i < count; i += 16)
+            {
+                convert(pixels.data() + i);
+                convert(pixels.data() + i + 4);
+                convert(pixels.data() + i + 8);
+                convert(pixels.data() + i + 12);
+            }
+            for (size_t i = count; i < pixels.size(); i += 4)
+            {
+                convert(pixels.data() + i);
+            }
+        }
+
+        template <typename Function>
+        auto makeTable(Function&& function) -> std::array<uint8_t, 256>
+        {
+            std::array<uint8_t, 256> table;
+            for (uint32_t const i : std::views::iota(0u, 256u))
+            {
+                table[i] = static_cast<uint8_t>(std::lround(function(i / 255.0f) * 255.0f));
+            }
+            return table;
+        }
+
+        // Color channels go through the table, every fourth byte is alpha
+        auto convertPixels(std::span<uint8_t> pixels, std::array<uint8_t, 256> const& table) -> void
+        {
+            assert(pixels.size() % 4 == 0 && "pixels are not RGBA");
+
+            for (size_t i = 0; i < pixels.size(); i += 4)
+            {
+                pixels[i] = table[pixels[i]];
+                pixels[i + 1] = table[pixels[i + 1]];
+                pixels[i + 2] = table[pixels[i + 2]];
             }
         }
+    } // namespace
+
+    auto Color::srgb() -> Color&
+    {
+        r = toSrgb(r);
+        g = toSrgb(g);
+        b = toSrgb(b);
         return *this;
     }
-} // namespace ionengine::math
\ No newline at end of file
+
+    auto Color::rgb() -> Color&
+    {
+        r = toLinear(r);
+        g = toLinear(g);
+        b = toLinear(b);
+        return *this;
+    }
+
+    auto srgbToLinear(std::span<float> pixels) -> void
+    {
+        convertPixels(pixels, [](simd::float4 const pixel) { return toLinear(pixel); });
+    }
+
+    auto linearToSrgb(std::span<float> pixels) -> void
+    {
+        convertPixels(pixels, [](simd::float4 const pixel) { return toSrgb(pixel); });
+    }
+
+    auto srgbToLinear(std::span<uint8_t> pixels) -> void
+    {
+        static std::array<uint8_t, 256> const table = makeTable([](float const color) { return toLinear(color); });
+        convertPixels(pixels, table);
+    }
+
+    auto linearToSrgb(std::span<uint8_t> pixels) -> void
+    {
+        static std::array<uint8_t, 256> const table = makeTable([](float const color) { return toSrgb(color); });
+        convertPixels(pixels, table);
+    }
+
+    auto srgbToLinear(std::span<uint8_t const> source, std::span<float> dest) -> void
+    {
+        assert(source.size() % 4 == 0 && dest.size() >= source.size() && "pixels are not RGBA");
+
+        static std::array<float, 256> const table = [] {
+            std::array<float, 256> table;
+            for (uint32_t const i : std::views::iota(0u, 256u))
+            {
+                table[i] = toLinear(i / 255.0f);
+            }
+            return table;
+        }();
+
+        for (size_t i = 0; i < source.size(); i += 4)
+        {
+            dest[i] = table[source[i]];
+            dest[i + 1] = table[source[i + 1]];
+            dest[i + 2] = table[source[i + 2]];
+            dest[i + 3] = source[i + 3] / 255.0f;
+        }
+    }
+} // namespace ionengine::math
@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include "core/hash.hpp"
+
 namespace ionengine::math
 {
     struct Color
@@ -17,31 +19,13 @@ namespace ionengine::math
         {
         }
 
-        Color(Color const& other) : r(other.r), g(other.g), b(other.b), a(other.a)
-        {
-        }
+        Color(Color const&) = default;
 
-        Color(Color&& other) noexcept : r(other.r), g(other.g), b(other.b), a(other.a)
-        {
-        }
+        Color(Color&&) = default;
 
-        auto operator=(Color const& other) -> Color&
-        {
-            r = other.r;
-            g = other.g;
-            b = other.b;
-            a = other.a;
-            return *this;
-        }
+        auto operator=(Color const&) -> Color& = default;
 
-        auto operator=(Color&& other) -> Color&
-        {
-            r = other.r;
-            g = other.g;
-            b = other.b;
-            a = other.a;
-            return *this;
-        }
+        auto operator=(Color&&) -> Color& = default;
 
         auto data() const -> float const*
         {
@@ -62,6 +46,20 @@ namespace ionengine::math
             return std::tie(r, g, b, a) == std::tie(other.r, other.g, other.b, other.a);
         }
     };
+
+    // Conversions of whole RGBA images in place, alpha is left as is. Float values are clamped to [0, 1] and
+    // converted with polynomial approximations that stay within 1e-5 of the exact curve, 8-bit values through tables.
+
+    auto srgbToLinear(std::span<float> pixels) -> void;
+
+    auto linearToSrgb(std::span<float> pixels) -> void;
+
+    auto srgbToLinear(std::span<uint8_t> pixels) -> void;
+
+    auto linearToSrgb(std::span<uint8_t> pixels) -> void;
+
+    // Decodes 8-bit sRGB pixels into linear floats
+    auto srgbToLinear(std::span<uint8_t const> source, std::span<float> dest) -> void;
 } // namespace ionengine::math
 
 template <>
@@ -69,7 +67,6 @@ struct std::hash<ionengine::math::Color>
 {
     auto operator()(ionengine::math::Color const& other) const -> size_t
     {
-        return std::hash<float>()(other.r) ^ std::hash<float>()(other.g) ^ std::hash<float>()(other.b) ^
-               std::hash<float>()(other.a);
+        return ionengine::core::hash_floats(std::span<float const>(other.data(), other.size()));
     }
 };
\ No newline at end of file
@@ -28,61 +28,13 @@ namespace ionengine::math
         {
         }
 
-        Mat(Mat const& other)
-            : _00(other._00), _01(other._01), _02(other._02), _03(other._03), _10(other._10), _11(other._11),
-              _12(other._12), _13(other._13), _20(other._20), _21(other._21), _22(other._22), _23(other._23),
-              _30(other._30), _31(other._31), _32(other._32), _33(other._33)
-        {
-        }
+        Mat(Mat const&) = default;
 
-        Mat(Mat&& other) noexcept
-            : _00(other._00), _01(other._01), _02(other._02), _03(other._03), _10(other._10), _11(other._11),
-              _12(other._12), _13(other._13), _20(other._20), _21(other._21), _22(other._22), _23(other._23),
-              _30(other._30), _31(other._31), _32(other._32), _33(other._33)
-        {
-        }
+        Mat(Mat&&) = default;
 
-        auto operator=(Mat const& other) -> Mat&
-        {
-            _00 = other._00;
-            _01 = other._01;
-            _02 = other._02;
-            _03 = other._03;
-            _10 = other._10;
-            _11 = other._11;
-            _12 = other._12;
-            _13 = other._13;
-            _20 = other._20;
-            _21 = other._21;
-            _22 = other._22;
-            _23 = other._23;
-            _30 = other._30;
-            _31 = other._31;
-            _32 = other._32;
-            _33 = other._33;
-            return *this;
-        }
+        auto operator=(Mat const&) -> Mat& = default;
 
-        auto operator=(Mat&& other) -> Mat&
-        {
-            _00 = other._00;
-            _01 = other._01;
-            _02 = other._02;
-            _03 = other._03;
-            _10 = other._10;
-            _11 = other._11;
-            _12 = other._12;
-            _13 = other._13;
-            _20 = other._20;
-            _21 = other._21;
-            _22 = other._22;
-            _23 = other._23;
-            _30 = other._30;
-            _31 = other._31;
-            _32 = other._32;
-            _33 = other._33;
-            return *this;
-        }
+        auto operator=(Mat&&) -> Mat& = default;
 
         auto data() const -> Type const*
         {
@@ -96,6 +48,20 @@ namespace ionengine::math
 
         auto transpose() -> Mat&
         {
+            if constexpr (std::is_same_v<Type, float>)
+            {
+                simd::float4 row0 = simd::load(&_00);
+                simd::float4 row1 = simd::load(&_10);
+                simd::float4 row2 = simd::load(&_20);
+                simd::float4 row3 = simd::load(&_30);
+                simd::transpose(row0, row1, row2, row3);
+                simd::store(&_00, row0);
+                simd::store(&_10, row1);
+                simd::store(&_20, row2);
+                simd::store(&_30, row3);
+                return *this;
+            }
+
             Mat mat = *this;
             _00 = mat._00;
             _01 = mat._10;
@@ -118,6 +84,12 @@ namespace ionengine::math
 
         auto inverse() -> Mat&
         {
+            if constexpr (std::is_same_v<Type, float>)
+            {
+                simd::inverse(&_00, &_00);
+                return *this;
+            }
+
             Type n11 = _00, n12 = _10, n13 = _20, n14 = _30;
             Type n21 = _01, n22 = _11, n23 = _21, n24 = _31;
             Type n31 = _02, n32 = _12, n33 = _22, n34 = _32;
@@ -180,6 +152,13 @@ namespace ionengine::math
 
         auto operator*(Mat const& other) const -> Mat
         {
+            if constexpr (std::is_same_v<Type, float>)
+            {
+                Mat mat;
+                simd::multiply(&_00, &other._00, &mat._00);
+                return mat;
+            }
+
             return Mat{_00 * other._00 + _01 * other._10 + _02 * other._20 + _03 * other._30,
                        _00 * other._01 + _01 * other._11 + _02 * other._21 + _03 * other._31,
                        _00 * other._02 + _01 * other._12 + _02 * other._22 + _03 * other._32,
@@ -198,6 +177,21 @@ namespace ionengine::math
                        _30 * other._03 + _31 * other._13 + _32 * other._23 + _33 * other._33};
         }
 
+        // Row vector times the matrix
+        auto transform(Vec4<Type> const& other) const -> Vec4<Type>
+        {
+            if constexpr (std::is_same_v<Type, float>)
+            {
+                return Vec4<Type>::fromSimd(simd::transform(simd::load(&other.x), simd::load(&_00), simd::load(&_10),
+                                                            simd::load(&_20), simd::load(&_30)));
+            }
+
+            return Vec4<Type>{other.x * _00 + other.y * _10 + other.z * _20 + other.w * _30,
+                              other.x * _01 + other.y * _11 + other.z * _21 + other.w * _31,
+                              other.x * _02 + other.y * _12 + other.z * _22 + other.w * _32,
+                              other.x * _03 + other.y * _13 + other.z * _23 + other.w * _33};
+        }
+
         auto operator*(Vec4<Type> const& other) const -> Mat
         {
             return Mat{_00 * other.x, _01 * other.y, _02 * other.z, _03 * other.w, _10 * other.x, _11 * other.y,
@@ -214,7 +208,7 @@ namespace ionengine::math
 
         auto operator+(Mat const& other) const -> Mat
         {
-            return Mat{_00 + other.m00, _01 + other._01, _02 + other._02, _03 + other._03,
+            return Mat{_00 + other._00, _01 + other._01, _02 + other._02, _03 + other._03,
                        _10 + other._10, _11 + other._11, _12 + other._12, _13 + other._13,
                        _20 + other._20, _21 + other._21, _22 + other._22, _23 + other._23,
                        _30 + other._30, _31 + other._31, _32 + other._32, _33 + other._33};
@@ -320,11 +314,6 @@ struct std::hash<ionengine::math::Mat<Type>>
 {
     auto operator()(ionengine::math::Mat<Type> const& other) const -> size_t
     {
-        return std::hash<Type>()(other._00) ^ std::hash<Type>()(other._01) ^ std::hash<Type>()(other._02) ^
-               std::hash<Type>()(other._03) ^ std::hash<Type>()(other._10) ^ std::hash<Type>()(other._11) ^
-               std::hash<Type>()(other._12) ^ std::hash<Type>()(other._13) ^ std::hash<Type>()(other._20) ^
-               std::hash<Type>()(other._21) ^ std::hash<Type>()(other._22) ^ std::hash<Type>()(other._23) ^
-               std::hash<Type>()(other._30) ^ std::hash<Type>()(other._31) ^ std::hash<Type>()(other._32) ^
-               std::hash<Type>()(other._33);
+        return ionengine::math::hashValues(other);
     }
 };
\ No newline at end of file
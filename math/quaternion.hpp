@@ -22,31 +22,13 @@ namespace ionengine::math
         {
         }
 
-        Quat(Quat const& other) : x(other.x), y(other.y), z(other.z), w(other.w)
-        {
-        }
+        Quat(Quat const&) = default;
 
-        Quat(Quat&& other) noexcept : x(other.x), y(other.y), z(other.z), w(other.w)
-        {
-        }
+        Quat(Quat&&) = default;
 
-        auto operator=(Quat const& other) -> Quat&
-        {
-            x = other.x;
-            y = other.y;
-            z = other.z;
-            w = other.w;
-            return *this;
-        }
+        auto operator=(Quat const&) -> Quat& = default;
 
-        auto operator=(Quat&& other) -> Quat&
-        {
-            x = other.x;
-            y = other.y;
-            z = other.z;
-            w = other.w;
-            return *this;
-        }
+        auto operator=(Quat&&) -> Quat& = default;
 
         auto data() const -> Type const*
         {
@@ -60,7 +42,7 @@ namespace ionengine::math
 
         auto normalize() -> Quat&
         {
-            Type inverse = 1.0 / this->length();
+            Type inverse = static_cast<Type>(1) / this->length();
             x = x * inverse;
             y = y * inverse;
             z = z * inverse;
@@ -73,7 +55,8 @@ namespace ionengine::math
             return std::sqrt(x * x + y * y + z * z + w * w);
         }
 
-        auto toMat() const -> Mat
+        // Rotation for row vectors, the same convention as Mat::translate
+        auto toMat() const -> Mat<Type>
         {
             Type xy = x * y;
             Type xz = x * z;
@@ -85,18 +68,16 @@ namespace ionengine::math
             Type yy = y * y;
             Type zz = z * z;
 
-            auto mat = Matrix<Type>::identity();
-            mat._00 = 1.0f - 2.0f * (yy + zz);
-            mat._01 = 2.0f * (xy - zw);
-            mat._02 = 2.0f * (xz + yw);
-            mat._03 = 0.0f;
-            mat._10 = 2.0f * (xy + zw);
-            mat._11 = 1.0f - 2.0f * (xx + zz);
-            mat._12 = 2.0f * (yz - xw);
-            mat._13 = 0.0f;
-            mat._20 = 2.0f * (xz - yw);
-            mat._21 = 2.0f * (yz + xw);
-            mat._22 = 1.0f - 2.0f * (xx + yy);
+            auto mat = Mat<Type>::identity();
+            mat._00 = 1 - 2 * (yy + zz);
+            mat._01 = 2 * (xy + zw);
+            mat._02 = 2 * (xz - yw);
+            mat._10 = 2 * (xy - zw);
+            mat._11 = 1 - 2 * (xx + zz);
+            mat._12 = 2 * (yz + xw);
+            mat._20 = 2 * (xz + yw);
+            mat._21 = 2 * (yz - xw);
+            mat._22 = 1 - 2 * (xx + yy);
             return mat;
         }
 
@@ -109,20 +90,20 @@ namespace ionengine::math
                 quat.normalize();
             }
 
-            *angle = static_cast<Type>(2 * std::acos(quat.w) * 180.0f / std::numbers::pi);
+            angle = static_cast<Type>(2 * std::acos(quat.w) * 180.0f / std::numbers::pi);
             Type s = std::sqrt(1 - quat.w * quat.w);
 
             if (s < 0.001)
             {
-                axis->x = quat.x;
-                axis->y = quat.y;
-                axis->z = quat.z;
+                axis.x = quat.x;
+                axis.y = quat.y;
+                axis.z = quat.z;
             }
             else
             {
-                axis->x = quat.x / s;
-                axis->y = quat.y / s;
-                axis->z = quat.z / s;
+                axis.x = quat.x / s;
+                axis.y = quat.y / s;
+                axis.z = quat.z / s;
             }
         }
 
@@ -141,7 +122,7 @@ namespace ionengine::math
             return quat;
         }
 
-        auto operator*(Quaternion const& other) const -> Quat
+        auto operator*(Quat const& other) const -> Quat
         {
             return Quat{w * other.x + x * other.w + y * other.z - z * other.y,
                         w * other.y - x * other.z + y * other.w + z * other.x,
@@ -210,7 +191,6 @@ struct std::hash<ionengine::math::Quat<Type>>
 {
     auto operator()(ionengine::math::Quat<Type> const& other) const -> size_t
     {
-        return std::hash<Type>()(other.x) ^ std::hash<Type>()(other.y) ^ std::hash<Type>()(other.z) ^
-               std::hash<Type>()(other.w);
+        return ionengine::math::hashValues(other);
     }
 };
\ No newline at end of file
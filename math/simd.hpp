@@ -0,0 +1,311 @@
+// Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
+
+#pragma once
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IONENGINE_MATH_SSE
+#include <emmintrin.h>
+#endif
+
+// Four float lanes. SSE2 is part of every x86-64 target, so it is used without runtime dispatch. Other targets fall
+// back to plain arrays with the same operations; a NEON backend only needs to provide this set. Loads and stores do
+// not require alignment, matrices are also stored inside packed shader structures.
+namespace ionengine::math::simd
+{
+#ifdef IONENGINE_MATH_SSE
+    using float4 = __m128;
+
+    inline auto load(float const* source) -> float4
+    {
+        return _mm_loadu_ps(source);
+    }
+
+    inline auto store(float* dest, float4 const value) -> void
+    {
+        _mm_storeu_ps(dest, value);
+    }
+
+    inline auto set(float const x, float const y, float const z, float const w) -> float4
+    {
+        return _mm_setr_ps(x, y, z, w);
+    }
+
+    inline auto splat(float const value) -> float4
+    {
+        return _mm_set1_ps(value);
+    }
+
+    inline auto add(float4 const lhs, float4 const rhs) -> float4
+    {
+        return _mm_add_ps(lhs, rhs);
+    }
+
+    inline auto sub(float4 const lhs, float4 const rhs) -> float4
+    {
+        return _mm_sub_ps(lhs, rhs);
+    }
+
+    inline auto mul(float4 const lhs, float4 const rhs) -> float4
+    {
+        return _mm_mul_ps(lhs, rhs);
+    }
+
+    inline auto div(float4 const lhs, float4 const rhs) -> float4
+    {
+        return _mm_div_ps(lhs, rhs);
+    }
+
+    inline auto sqrt(float4 const value) -> float4
+    {
+        return _mm_sqrt_ps(value);
+    }
+
+    inline auto min(float4 const lhs, float4 const rhs) -> float4
+    {
+        return _mm_min_ps(lhs, rhs);
+    }
+
+    inline auto max(float4 const lhs, float4 const rhs) -> float4
+    {
+        return _mm_max_ps(lhs, rhs);
+    }
+
+    // Lanes with all bits set where lhs < rhs
+    inline auto less(float4 const lhs, float4 const rhs) -> float4
+    {
+        return _mm_cmplt_ps(lhs, rhs);
+    }
+
+    // Lanes of lhs where the mask is set, otherwise of rhs
+    inline auto select(float4 const mask, float4 const lhs, float4 const rhs) -> float4
+    {
+        return _mm_or_ps(_mm_and_ps(mask, lhs), _mm_andnot_ps(mask, rhs));
+    }
+
+    // (lhs[X], lhs[Y], rhs[Z], rhs[W])
+    template <uint32_t X, uint32_t Y, uint32_t Z, uint32_t W>
+    inline auto shuffle(float4 const lhs, float4 const rhs) -> float4
+    {
+        return _mm_shuffle_ps(lhs, rhs, _MM_SHUFFLE(W, Z, Y, X));
+    }
+#else
+    struct alignas(16) float4
+    {
+        std::array<float, 4> lanes;
+    };
+
+    inline auto load(float const* source) -> float4
+    {
+        return float4{{source[0], source[1], source[2], source[3]}};
+    }
+
+    inline auto store(float* dest, float4 const value) -> void
+    {
+        std::copy(value.lanes.begin(), value.lanes.end(), dest);
+    }
+
+    inline auto set(float const x, float const y, float const z, float const w) -> float4
+    {
+        return float4{{x, y, z, w}};
+    }
+
+    inline auto splat(float const value) -> float4
+    {
+        return float4{{value, value, value, value}};
+    }
+
+    inline auto add(float4 const lhs, float4 const rhs) -> float4
+    {
+        return float4{{lhs.lanes[0] + rhs.lanes[0], lhs.lanes[1] + rhs.lanes[1], lhs.lanes[2] + rhs.lanes[2],
+                       lhs.lanes[3] + rhs.lanes[3]}};
+    }
+
+    inline auto sub(float4 const lhs, float4 const rhs) -> float4
+    {
+        return float4{{lhs.lanes[0] - rhs.lanes[0], lhs.lanes[1] - rhs.lanes[1], lhs.lanes[2] - rhs.lanes[2],
+                       lhs.lanes[3] - rhs.lanes[3]}};
+    }
+
+    inline auto mul(float4 const lhs, float4 const rhs) -> float4
+    {
+        return float4{{lhs.lanes[0] * rhs.lanes[0], lhs.lanes[1] * rhs.lanes[1], lhs.lanes[2] * rhs.lanes[2],
+                       lhs.lanes[3] * rhs.lanes[3]}};
+    }
+
+    inline auto div(float4 const lhs, float4 const rhs) -> float4
+    {
+        return float4{{lhs.lanes[0] / rhs.lanes[0], lhs.lanes[1] / rhs.lanes[1], lhs.lanes[2] / rhs.lanes[2],
+                       lhs.lanes[3] / rhs.lanes[3]}};
+    }
+
+    inline auto sqrt(float4 const value) -> float4
+    {
+        return float4{{std::sqrt(value.lanes[0]), std::sqrt(value.lanes[1]), std::sqrt(value.lanes[2]),
+                       std::sqrt(value.lanes[3])}};
+    }
+
+    inline auto min(float4 const lhs, float4 const rhs) -> float4
+    {
+        return float4{{std::min(lhs.lanes[0], rhs.lanes[0]), std::min(lhs.lanes[1], rhs.lanes[1]),
+                       std::min(lhs.lanes[2], rhs.lanes[2]), std::min(lhs.lanes[3], rhs.lanes[3])}};
+    }
+
+    inline auto max(float4 const lhs, float4 const rhs) -> float4
+    {
+        return float4{{std::max(lhs.lanes[0], rhs.lanes[0]), std::max(lhs.lanes[1], rhs.lanes[1]),
+                       std::max(lhs.lanes[2], rhs.lanes[2]), std::max(lhs.lanes[3], rhs.lanes[3])}};
+    }
+
+    inline auto less(float4 const lhs, float4 const rhs) -> float4
+    {
+        float4 mask;
+        for (uint32_t const i : std::views::iota(0u, 4u))
+        {
+            mask.lanes[i] = std::bit_cast<float>(lhs.lanes[i] < rhs.lanes[i] ? 0xffffffffu : 0u);
+        }
+        return mask;
+    }
+
+    inline auto select(float4 const mask, float4 const lhs, float4 const rhs) -> float4
+    {
+        float4 result;
+        for (uint32_t const i : std::views::iota(0u, 4u))
+        {
+            result.lanes[i] = std::bit_cast<uint32_t>(mask.lanes[i]) != 0 ? lhs.lanes[i] : rhs.lanes[i];
+        }
+        return result;
+    }
+
+    template <uint32_t X, uint32_t Y, uint32_t Z, uint32_t W>
+    inline auto shuffle(float4 const lhs, float4 const rhs) -> float4
+    {
+        return float4{{lhs.lanes[X], lhs.lanes[Y], rhs.lanes[Z], rhs.lanes[W]}};
+    }
+#endif
+
+    template <uint32_t X, uint32_t Y, uint32_t Z, uint32_t W>
+    inline auto swizzle(float4 const value) -> float4
+    {
+        return shuffle<X, Y, Z, W>(value, value);
+    }
+
+    template <uint32_t Lane>
+    inline auto broadcast(float4 const value) -> float4
+    {
+        return shuffle<Lane, Lane, Lane, Lane>(value, value);
+    }
+
+    // Sum of the lanes in every lane
+    inline auto sum(float4 const value) -> float4
+    {
+        float4 const pairs = add(value, swizzle<1, 0, 3, 2>(value));
+        return add(pairs, swizzle<2, 3, 0, 1>(pairs));
+    }
+
+    // Operations on row-major 4x4 matrices, each row is one float4
+
+    inline auto transpose(float4& row0, float4& row1, float4& row2, float4& row3) -> void
+    {
+        float4 const t0 = shuffle<0, 1, 0, 1>(row0, row1);
+        float4 const t1 = shuffle<0, 1, 0, 1>(row2, row3);
+        float4 const t2 = shuffle<2, 3, 2, 3>(row0, row1);
+        float4 const t3 = shuffle<2, 3, 2, 3>(row2, row3);
+        row0 = shuffle<0, 2, 0, 2>(t0, t1);
+        row1 = shuffle<1, 3, 1, 3>(t0, t1);
+        row2 = shuffle<0, 2, 0, 2>(t2, t3);
+        row3 = shuffle<1, 3, 1, 3>(t2, t3);
+    }
+
+    // Row vector times matrix, summed pairwise to shorten the dependency chain
+    inline auto transform(float4 const vector, float4 const row0, float4 const row1, float4 const row2,
+                          float4 const row3) -> float4
+    {
+        float4 const xy = add(mul(broadcast<0>(vector), row0), mul(broadcast<1>(vector), row1));
+        float4 const zw = add(mul(broadcast<2>(vector), row2), mul(broadcast<3>(vector), row3));
+        return add(xy, zw);
+    }
+
+    inline auto multiply(float const* lhs, float const* rhs, float* dest) -> void
+    {
+        float4 const row0 = load(rhs);
+        float4 const row1 = load(rhs + 4);
+        float4 const row2 = load(rhs + 8);
+        float4 const row3 = load(rhs + 12);
+        float4 const result0 = transform(load(lhs), row0, row1, row2, row3);
+        float4 const result1 = transform(load(lhs + 4), row0, row1, row2, row3);
+        float4 const result2 = transform(load(lhs + 8), row0, row1, row2, row3);
+        float4 const result3 = transform(load(lhs + 12), row0, row1, row2, row3);
+        store(dest, result0);
+        store(dest + 4, result1);
+        store(dest + 8, result2);
+        store(dest + 12, result3);
+    }
+
+    namespace internal
+    {
+        // 2x2 blocks stored as (m00, m01, m10, m11)
+
+        inline auto mat2Mul(float4 const lhs, float4 const rhs) -> float4
+        {
+            return add(mul(lhs, swizzle<0, 3, 0, 3>(rhs)), mul(swizzle<1, 0, 3, 2>(lhs), swizzle<2, 1, 2, 1>(rhs)));
+        }
+
+        // adjugate(lhs) * rhs
+        inline auto mat2AdjMul(float4 const lhs, float4 const rhs) -> float4
+        {
+            return sub(mul(swizzle<3, 3, 0, 0>(lhs), rhs), mul(swizzle<1, 1, 2, 2>(lhs), swizzle<2, 3, 0, 1>(rhs)));
+        }
+
+        // lhs * adjugate(rhs)
+        inline auto mat2MulAdj(float4 const lhs, float4 const rhs) -> float4
+        {
+            return sub(mul(lhs, swizzle<3, 0, 3, 0>(rhs)), mul(swizzle<1, 0, 3, 2>(lhs), swizzle<2, 1, 2, 1>(rhs)));
+        }
+    } // namespace internal
+
+    // General inverse through 2x2 blocks
+    // https://lxjk.github.io/2017/09/03/Fast-4x4-Matrix-Inverse-with-SSE-SIMD-Explained.html
+    inline auto inverse(float const* source, float* dest) -> void
+    {
+        float4 const row0 = load(source);
+        float4 const row1 = load(source + 4);
+        float4 const row2 = load(source + 8);
+        float4 const row3 = load(source + 12);
+
+        float4 const a = shuffle<0, 1, 0, 1>(row0, row1);
+        float4 const b = shuffle<2, 3, 2, 3>(row0, row1);
+        float4 const c = shuffle<0, 1, 0, 1>(row2, row3);
+        float4 const d = shuffle<2, 3, 2, 3>(row2, row3);
+
+        // Determinants of the blocks as (|A|, |B|, |C|, |D|)
+        float4 const detSub =
+            sub(mul(shuffle<0, 2, 0, 2>(row0, row2), shuffle<1, 3, 1, 3>(row1, row3)),
+                mul(shuffle<1, 3, 1, 3>(row0, row2), shuffle<0, 2, 0, 2>(row1, row3)));
+        float4 const detA = broadcast<0>(detSub);
+        float4 const detB = broadcast<1>(detSub);
+        float4 const detC = broadcast<2>(detSub);
+        float4 const detD = broadcast<3>(detSub);
+
+        float4 const dC = internal::mat2AdjMul(d, c);
+        float4 const aB = internal::mat2AdjMul(a, b);
+        float4 x = sub(mul(detD, a), internal::mat2Mul(b, dC));
+        float4 w = sub(mul(detA, d), internal::mat2Mul(c, aB));
+        float4 y = sub(mul(detB, c), internal::mat2MulAdj(d, aB));
+        float4 z = sub(mul(detC, b), internal::mat2MulAdj(a, dC));
+
+        float4 det = add(mul(detA, detD), mul(detB, detC));
+        det = sub(det, sum(mul(aB, swizzle<0, 2, 1, 3>(dC))));
+
+        float4 const inverseDet = div(set(1.0f, -1.0f, -1.0f, 1.0f), det);
+        x = mul(x, inverseDet);
+        y = mul(y, inverseDet);
+        z = mul(z, inverseDet);
+        w = mul(w, inverseDet);
+
+        // Adjugate of the blocks combined with the transpose back into rows
+        store(dest, shuffle<3, 1, 3, 1>(x, y));
+        store(dest + 4, shuffle<2, 0, 2, 0>(x, y));
+        store(dest + 8, shuffle<3, 1, 3, 1>(z, w));
+        store(dest + 12, shuffle<2, 0, 2, 0>(z, w));
+    }
+} // namespace ionengine::math::simd
@@ -0,0 +1,198 @@
+// Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
+
+#include "math/transform.hpp"
+#include "precompiled.h"
+
+namespace ionengine::math
+{
+    namespace
+    {
+        using simd::float4;
+
+        // Lanes hold the same element of four objects
+        struct Vec3x4
+        {
+            float4 x;
+            float4 y;
+            float4 z;
+        };
+
+        // Row-major matrix elements of four objects. Plain arrays since __m128 attributes are dropped in templates
+        using Matx4 = float4[4][4];
+
+        auto loadVec3x4(Vec3f const* source) -> Vec3x4
+        {
+            float const* data = &source->x;
+            float4 const a = simd::load(data);
+            float4 const b = simd::load(data + 4);
+            float4 const c = simd::load(data + 8);
+
+            float4 const bc = simd::shuffle<2, 3, 0, 1>(b, c);
+            return Vec3x4{.x = simd::shuffle<0, 3, 0, 3>(a, bc),
+                          .y = simd::shuffle<0, 2, 0, 2>(simd::shuffle<1, 2, 0, 1>(a, b),
+                                                         simd::shuffle<3, 3, 2, 2>(b, c)),
+                          .z = simd::shuffle<0, 2, 0, 1>(simd::shuffle<2, 2, 1, 1>(a, b),
+                                                         simd::swizzle<0, 3, 0, 3>(c))};
+        }
+
+        // Transposes the lanes back into four row-major matrices
+        auto storeMatx4(Matx4& mat, Matf* dest) -> void
+        {
+            for (uint32_t const row : std::views::iota(0u, 4u))
+            {
+                simd::transpose(mat[row][0], mat[row][1], mat[row][2], mat[row][3]);
+                for (uint32_t const object : std::views::iota(0u, 4u))
+                {
+                    simd::store(&dest[object]._00 + row * 4, mat[row][object]);
+                }
+            }
+        }
+
+        auto computeTransformsx4(Vec3f const* positions, Quatf const* rotations, Vec3f const* scales,
+                                 Matf const& viewProj, Matf const& inverseViewProj, Matf* modelViewProjs,
+                                 Matf* inverseModelViewProjs) -> void
+        {
+            Vec3x4 const position = loadVec3x4(positions);
+            Vec3x4 const scale = loadVec3x4(scales);
+
+            float4 qx = simd::load(&rotations[0].x);
+            float4 qy = simd::load(&rotations[1].x);
+            float4 qz = simd::load(&rotations[2].x);
+            float4 qw = simd::load(&rotations[3].x);
+            simd::transpose(qx, qy, qz, qw);
+
+            // Rotation rows, as Quat::toMat
+            float4 const one = simd::splat(1.0f);
+            float4 const two = simd::splat(2.0f);
+            float4 const xx = simd::mul(qx, qx);
+            float4 const yy = simd::mul(qy, qy);
+            float4 const zz = simd::mul(qz, qz);
+            float4 const xy = simd::mul(qx, qy);
+            float4 const xz = simd::mul(qx, qz);
+            float4 const yz = simd::mul(qy, qz);
+            float4 const xw = simd::mul(qx, qw);
+            float4 const yw = simd::mul(qy, qw);
+            float4 const zw = simd::mul(qz, qw);
+
+            float4 const rotation[3][3]{
+                {simd::sub(one, simd::mul(two, simd::add(yy, zz))), simd::mul(two, simd::add(xy, zw)),
+                 simd::mul(two, simd::sub(xz, yw))},
+                {simd::mul(two, simd::sub(xy, zw)), simd::sub(one, simd::mul(two, simd::add(xx, zz))),
+                 simd::mul(two, simd::add(yz, xw))},
+                {simd::mul(two, simd::add(xz, yw)), simd::mul(two, simd::sub(yz, xw)),
+                 simd::sub(one, simd::mul(two, simd::add(xx, yy)))}};
+
+            float4 const scaleRows[3]{scale.x, scale.y, scale.z};
+            float4 const positionRow[3]{position.x, position.y, position.z};
+
+            // world = scale * rotation * translate, its last column is (0, 0, 0, 1)
+            Matx4 world;
+            for (uint32_t const i : std::views::iota(0u, 3u))
+            {
+                for (uint32_t const j : std::views::iota(0u, 3u))
+                {
+                    world[i][j] = simd::mul(scaleRows[i], rotation[i][j]);
+                }
+            }
+
+            Matx4 modelViewProj;
+            for (uint32_t const j : std::views::iota(0u, 4u))
+            {
+                float4 const vp0 = simd::splat(viewProj.data()[j]);
+                float4 const vp1 = simd::splat(viewProj.data()[4 + j]);
+                float4 const vp2 = simd::splat(viewProj.data()[8 + j]);
+                float4 const vp3 = simd::splat(viewProj.data()[12 + j]);
+                for (uint32_t const i : std::views::iota(0u, 3u))
+                {
+                    modelViewProj[i][j] = simd::add(simd::add(simd::mul(world[i][0], vp0), simd::mul(world[i][1], vp1)),
+                                                    simd::mul(world[i][2], vp2));
+                }
+                modelViewProj[3][j] =
+                    simd::add(simd::add(simd::mul(positionRow[0], vp0), simd::mul(positionRow[1], vp1)),
+                              simd::add(simd::mul(positionRow[2], vp2), vp3));
+            }
+            storeMatx4(modelViewProj, modelViewProjs);
+
+            // inverse(world) = inverse(translate) * transpose(rotation) * inverse(scale)
+            float4 const inverseScale[3]{simd::div(one, scale.x), simd::div(one, scale.y), simd::div(one, scale.z)};
+            Matx4 inverseWorld;
+            for (uint32_t const i : std::views::iota(0u, 3u))
+            {
+                for (uint32_t const j : std::views::iota(0u, 3u))
+                {
+                    inverseWorld[i][j] = simd::mul(rotation[j][i], inverseScale[j]);
+                }
+            }
+            for (uint32_t const j : std::views::iota(0u, 3u))
+            {
+                inverseWorld[3][j] = simd::sub(
+                    simd::splat(0.0f),
+                    simd::add(simd::add(simd::mul(positionRow[0], inverseWorld[0][j]),
+                                        simd::mul(positionRow[1], inverseWorld[1][j])),
+                              simd::mul(positionRow[2], inverseWorld[2][j])));
+            }
+
+            // inverse(world * viewProj) = inverse(viewProj) * inverse(world)
+            Matx4 inverseModelViewProj;
+            for (uint32_t const i : std::views::iota(0u, 4u))
+            {
+                float4 const ivp0 = simd::splat(inverseViewProj.data()[i * 4]);
+                float4 const ivp1 = simd::splat(inverseViewProj.data()[i * 4 + 1]);
+                float4 const ivp2 = simd::splat(inverseViewProj.data()[i * 4 + 2]);
+                float4 const ivp3 = simd::splat(inverseViewProj.data()[i * 4 + 3]);
+                for (uint32_t const j : std::views::iota(0u, 3u))
+                {
+                    inverseModelViewProj[i][j] =
+                        simd::add(simd::add(simd::mul(ivp0, inverseWorld[0][j]), simd::mul(ivp1, inverseWorld[1][j])),
+                                  simd::add(simd::mul(ivp2, inverseWorld[2][j]), simd::mul(ivp3, inverseWorld[3][j])));
+                }
+                inverseModelViewProj[i][3] = ivp3;
+            }
+            storeMatx4(inverseModelViewProj, inverseModelViewProjs);
+        }
+    } // namespace
+
+    auto computeTransforms(TransformBatch const& batch, Matf const& viewProj, std::span<Matf> modelViewProjs,
+                           std::span<Matf> inverseModelViewProjs) -> void
+    {
+        assert(batch.rotations.size() == batch.size() && batch.scales.size() == batch.size() &&
+               "batch arrays have different sizes");
+        assert(modelViewProjs.size() >= batch.size() && inverseModelViewProjs.size() >= batch.size() &&
+               "output is smaller than the batch");
+
+        Matf const inverseViewProj = Matf(viewProj).inverse();
+
+        size_t const count = batch.size() / 4 * 4;
+        for (size_t i = 0; i < count; i += 4)
+        {
+            computeTransformsx4(&batch.positions[i], &batch.rotations[i], &batch.scales[i], viewProj, inverseViewProj,
+                                &modelViewProjs[i], &inverseModelViewProjs[i]);
+        }
+
+        // The remainder goes through the same kernel, padded with identity transforms
+        if (size_t const remainder = batch.size() - count; remainder > 0)
+        {
+            std::array<Vec3f, 4> positions;
+            std::array<Quatf, 4> rotations{Quatf(0.0f, 0.0f, 0.0f, 1.0f), Quatf(0.0f, 0.0f, 0.0f, 1.0f),
+                                           Quatf(0.0f, 0.0f, 0.0f, 1.0f), Quatf(0.0f, 0.0f, 0.0f, 1.0f)};
+            std::array<Vec3f, 4> scales{Vec3f(1.0f, 1.0f, 1.0f), Vec3f(1.0f, 1.0f, 1.0f), Vec3f(1.0f, 1.0f, 1.0f),
+                                        Vec3f(1.0f, 1.0f, 1.0f)};
+            for (size_t const i : std::views::iota(0u, remainder))
+            {
+                positions[i] = batch.positions[count + i];
+                rotations[i] = batch.rotations[count + i];
+                scales[i] = batch.scales[count + i];
+            }
+
+            std::array<Matf, 4> outModelViewProjs;
+            std::array<Matf, 4> outInverseModelViewProjs;
+            computeTransformsx4(positions.data(), rotations.data(), scales.data(), viewProj, inverseViewProj,
+                                outModelViewProjs.data(), outInverseModelViewProjs.data());
+            for (size_t const i : std::views::iota(0u, remainder))
+            {
+                modelViewProjs[count + i] = outModelViewProjs[i];
+                inverseModelViewProjs[count + i] = outInverseModelViewProjs[i];
+            }
+        }
+    }
+} // namespace ionengine::math
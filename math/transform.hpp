@@ -0,0 +1,38 @@
+// Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
+
+#pragma once
+
+#include "math/matrix.hpp"
+#include "math/quaternion.hpp"
+
+namespace ionengine::math
+{
+    // Transforms of many objects kept as separate arrays. Each object is scaled, rotated and then translated.
+    struct TransformBatch
+    {
+        std::span<Vec3f const> positions;
+        std::span<Quatf const> rotations;
+        std::span<Vec3f const> scales;
+
+        auto size() const -> size_t
+        {
+            return positions.size();
+        }
+
+        auto chunk(size_t const offset, size_t const count) const -> TransformBatch
+        {
+            return TransformBatch{.positions = positions.subspan(offset, count),
+                                  .rotations = rotations.subspan(offset, count),
+                                  .scales = scales.subspan(offset, count)};
+        }
+    };
+
+    // Objects per chunk when a batch is split between threads, a multiple of the SIMD width
+    inline constexpr size_t TransformChunkSize = 1024;
+
+    // Writes world * viewProj and its inverse for every object of the batch. Works four objects at a time, the
+    // inverse is composed from the inverse of viewProj and the analytic inverse of the world matrix. Chunks of one
+    // batch can be computed on different threads.
+    auto computeTransforms(TransformBatch const& batch, Matf const& viewProj, std::span<Matf> modelViewProjs,
+                           std::span<Matf> inverseModelViewProjs) -> void;
+} // namespace ionengine::math
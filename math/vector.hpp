@@ -2,6 +2,9 @@
 
 #pragma once
 
+#include "core/hash.hpp"
+#include "math/simd.hpp"
+
 namespace ionengine::math
 {
     template <typename Type>
@@ -18,27 +21,13 @@ namespace ionengine::math
         {
         }
 
-        Vec2(Vec2 const& other) : x(other.x), y(other.y)
-        {
-        }
+        Vec2(Vec2 const&) = default;
 
-        Vec2(Vec2&& other) : x(other.x), y(other.y)
-        {
-        }
+        Vec2(Vec2&&) = default;
 
-        auto operator=(Vec2 const& other) -> Vec2&
-        {
-            x = other.x;
-            y = other.y;
-            return *this;
-        }
+        auto operator=(Vec2 const&) -> Vec2& = default;
 
-        auto operator=(Vec2&& other) -> Vec2&
-        {
-            x = other.x;
-            y = other.y;
-            return *this;
-        }
+        auto operator=(Vec2&&) -> Vec2& = default;
 
         auto data() const -> Type const*
         {
@@ -122,29 +111,13 @@ namespace ionengine::math
         {
         }
 
-        Vec3(Vec3 const& other) : x(other.x), y(other.y), z(other.z)
-        {
-        }
+        Vec3(Vec3 const&) = default;
 
-        Vec3(Vec3&& other) : x(other.x), y(other.y), z(other.z)
-        {
-        }
+        Vec3(Vec3&&) = default;
 
-        auto operator=(Vec3 const& other) -> Vec3
-        {
-            x = other.x;
-            y = other.y;
-            z = other.z;
-            return *this;
-        }
+        auto operator=(Vec3 const&) -> Vec3& = default;
 
-        auto operator=(Vec3&& other) -> Vec3
-        {
-            x = other.x;
-            y = other.y;
-            z = other.z;
-            return *this;
-        }
+        auto operator=(Vec3&&) -> Vec3& = default;
 
         auto data() const -> Type const*
         {
@@ -244,31 +217,13 @@ namespace ionengine::math
         {
         }
 
-        Vec4(Vec4 const& other) : x(other.x), y(other.y), z(other.z), w(other.w)
-        {
-        }
+        Vec4(Vec4 const&) = default;
 
-        Vec4(Vec4&& other) : x(other.x), y(other.y), z(other.z), w(other.w)
-        {
-        }
+        Vec4(Vec4&&) = default;
 
-        auto operator=(Vec4 const& other) -> Vec4
-        {
-            x = other.x;
-            y = other.y;
-            z = other.z;
-            w = other.w;
-            return *this;
-        }
+        auto operator=(Vec4 const&) -> Vec4& = default;
 
-        auto operator=(Vec4&& other) -> Vec4
-        {
-            x = other.x;
-            y = other.y;
-            z = other.z;
-            w = other.w;
-            return *this;
-        }
+        auto operator=(Vec4&&) -> Vec4& = default;
 
         auto data() const -> Type const*
         {
@@ -297,11 +252,21 @@ namespace ionengine::math
 
         auto operator*(Type const other) const -> Vec4
         {
+            if constexpr (std::is_same_v<Type, float>)
+            {
+                return fromSimd(simd::mul(simd::load(&x), simd::splat(other)));
+            }
+
             return Vec4{x * other, y * other, z * other, w * other};
         }
 
         auto operator-(Vec4 const& other) const -> Vec4
         {
+            if constexpr (std::is_same_v<Type, float>)
+            {
+                return fromSimd(simd::sub(simd::load(&x), simd::load(&other.x)));
+            }
+
             return Vec4{x - other.x, y - other.y, z - other.z, w - other.w};
         }
 
@@ -317,6 +282,11 @@ namespace ionengine::math
 
         auto operator+(Vec4 const& other) const -> Vec4
         {
+            if constexpr (std::is_same_v<Type, float>)
+            {
+                return fromSimd(simd::add(simd::load(&x), simd::load(&other.x)));
+            }
+
             return Vec4{x + other.x, y + other.y, z + other.z, w + other.w};
         }
 
@@ -327,17 +297,48 @@ namespace ionengine::math
 
         auto operator/(Type const other) const -> Vec4
         {
+            if constexpr (std::is_same_v<Type, float>)
+            {
+                return fromSimd(simd::div(simd::load(&x), simd::splat(other)));
+            }
+
             return Vec4{x / other, y / other, z / other, w / other};
         }
 
         auto operator==(Vec4 const& other) const -> bool
         {
-            return std::make_tuple(x, y, z) == std::make_tuple(other.x, other.y, other.z, other.w);
+            return std::make_tuple(x, y, z, w) == std::make_tuple(other.x, other.y, other.z, other.w);
+        }
+
+        static auto fromSimd(simd::float4 const value) -> Vec4
+        {
+            Vec4 vec;
+            simd::store(&vec.x, value);
+            return vec;
         }
     };
 
     using Vec4f = Vec4<float>;
     using Vec4d = Vec4<double>;
+
+    // Hash of all components of a math type, used by the std::hash specializations
+    template <typename Type>
+    auto hashValues(Type const& other) -> size_t
+    {
+        if constexpr (std::is_same_v<std::remove_cvref_t<decltype(*other.data())>, float>)
+        {
+            return core::hash_floats(std::span<float const>(other.data(), other.size()));
+        }
+        else
+        {
+            uint64_t hash = other.size();
+            for (auto const value : std::span(other.data(), other.size()))
+            {
+                hash = core::hash_combine(hash, std::hash<std::remove_cvref_t<decltype(value)>>()(value));
+            }
+            return hash;
+        }
+    }
 } // namespace ionengine::math
 
 template <typename Type>
@@ -345,7 +346,7 @@ struct std::hash<ionengine::math::Vec2<Type>>
 {
     auto operator()(ionengine::math::Vec2<Type> const& other) const -> size_t
     {
-        return std::hash<Type>()(other.x) ^ std::hash<Type>()(other.y);
+        return ionengine::math::hashValues(other);
     }
 };
 
@@ -354,7 +355,7 @@ struct std::hash<ionengine::math::Vec3<Type>>
 {
     auto operator()(ionengine::math::Vec3<Type> const& other) const -> size_t
     {
-        return std::hash<Type>()(other.x) ^ std::hash<Type>()(other.y) ^ std::hash<Type>()(other.z);
+        return ionengine::math::hashValues(other);
     }
 };
 
@@ -363,7 +364,6 @@ struct std::hash<ionengine::math::Vec4<Type>>
 {
     auto operator()(ionengine::math::Vec4<Type> const& other) const -> size_t
     {
-        return std::hash<Type>()(other.x) ^ std::hash<Type>()(other.y) ^ std::hash<Type>()(other.z) ^
-               std::hash<Type>()(other.w);
+        return ionengine::math::hashValues(other);
     }
 };
\ No newline at end of file
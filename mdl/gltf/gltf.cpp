@@ -0,0 +1,674 @@
+// Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
+
+#include "gltf.hpp"
+#include "mdl/quantize.hpp"
+#include "precompiled.h"
+
+namespace ionengine::asset
+{
+    namespace
+    {
+        // Uncompressed vertex of the model file, interleaved full precision position, normal and texcoord. Files that
+        // already store vertices this way can have their binary chunk used as it is
+        size_t constexpr VertexSize = 32;
+        size_t constexpr NormalOffset = 12;
+        size_t constexpr TexcoordOffset = 24;
+
+        auto readUint32(std::span<uint8_t const> const bytes, size_t const offset) -> uint32_t
+        {
+            uint32_t value;
+            std::memcpy(&value, bytes.data() + offset, sizeof(uint32_t));
+            return value;
+        }
+
+        template <size_t Count>
+        auto readFloats(std::span<uint8_t const> const bytes, size_t const offset) -> std::array<float, Count>
+        {
+            std::array<float, Count> values;
+            std::memcpy(values.data(), bytes.data() + offset, Count * sizeof(float));
+            return values;
+        }
+
+        template <typename Type>
+        auto elementAt(std::optional<std::vector<Type>> const& elements, uint32_t const index) -> Type const&
+        {
+            if (!elements.has_value() || index >= elements->size())
+            {
+                throw core::runtime_error("A glTF file references an element out of range");
+            }
+            return (*elements)[index];
+        }
+
+        auto sizeof_Component(uint32_t const componentType) -> size_t
+        {
+            switch (componentType)
+            {
+                case gltf::ComponentUnsignedByte:
+                    return sizeof(uint8_t);
+                case gltf::ComponentUnsignedShort:
+                    return sizeof(uint16_t);
+                case gltf::ComponentUnsignedInt:
+                    return sizeof(uint32_t);
+                case gltf::ComponentFloat:
+                    return sizeof(float);
+                default:
+                    return 0;
+            }
+        }
+
+        // Elements of an accessor inside the binary chunk
+        struct AccessorRange
+        {
+            size_t offset;
+            size_t stride;
+            uint32_t count;
+            uint32_t componentType;
+            uint32_t bufferView;
+        };
+
+        auto getAccessorRange(gltf::DocumentData const& document, std::span<uint8_t const> const binChunk,
+                              uint32_t const index, std::string_view const type,
+                              std::initializer_list<uint32_t> const componentTypes) -> AccessorRange
+        {
+            gltf::AccessorData const& accessor = elementAt(document.accessors, index);
+            if (accessor.sparse.has_value() || !accessor.bufferView.has_value())
+            {
+                throw core::runtime_error("Sparse glTF accessors are not supported");
+            }
+            bool isComponentType = false;
+            for (uint32_t const componentType : componentTypes)
+            {
+                isComponentType = isComponentType || accessor.componentType == componentType;
+            }
+            if (accessor.type != type || accessor.normalized.value_or(false) || !isComponentType)
+            {
+                throw core::runtime_error("A glTF accessor has an unsupported format");
+            }
+
+            gltf::BufferViewData const& bufferView = elementAt(document.bufferViews, accessor.bufferView.value());
+            gltf::BufferData const& buffer = elementAt(document.buffers, bufferView.buffer);
+            if (bufferView.buffer != 0 || buffer.uri.has_value())
+            {
+                throw core::runtime_error("External glTF buffers are not supported");
+            }
+
+            size_t const elementSize = sizeof_Component(accessor.componentType) * (type == "VEC3"   ? 3
+                                                                                   : type == "VEC2" ? 2
+                                                                                                    : 1);
+            AccessorRange const range{.offset = bufferView.byteOffset.value_or(0) + accessor.byteOffset.value_or(0),
+                                      .stride = bufferView.byteStride.value_or(elementSize),
+                                      .count = accessor.count,
+                                      .componentType = accessor.componentType,
+                                      .bufferView = accessor.bufferView.value()};
+
+            size_t const viewEnd = bufferView.byteOffset.value_or(0) + bufferView.byteLength;
+            if (range.count > 0 &&
+                (range.offset + range.stride * (range.count - 1) + elementSize > viewEnd || viewEnd > binChunk.size()))
+            {
+                throw core::runtime_error("A glTF accessor is out of the buffer range");
+            }
+            return range;
+        }
+
+        struct VertexSource
+        {
+            AccessorRange positions;
+            std::optional<AccessorRange> normals;
+            std::optional<AccessorRange> texcoords;
+
+            // Attributes that already are interleaved the way the uncompressed layout stores vertices
+            auto isInterleaved() const -> bool
+            {
+                return normals.has_value() && texcoords.has_value() && positions.stride == VertexSize &&
+                       normals->bufferView == positions.bufferView && texcoords->bufferView == positions.bufferView &&
+                       normals->offset == positions.offset + NormalOffset &&
+                       texcoords->offset == positions.offset + TexcoordOffset;
+            }
+
+            auto write(std::span<uint8_t const> const binChunk, uint8_t* destination) const -> void
+            {
+                if (isInterleaved())
+                {
+                    std::memcpy(destination, binChunk.data() + positions.offset, positions.count * VertexSize);
+                    return;
+                }
+
+                for (uint32_t const i : std::views::iota(0u, positions.count))
+                {
+                    uint8_t* vertex = destination + i * VertexSize;
+                    std::memcpy(vertex, binChunk.data() + positions.offset + i * positions.stride, NormalOffset);
+                    if (normals.has_value())
+                    {
+                        std::memcpy(vertex + NormalOffset, binChunk.data() + normals->offset + i * normals->stride,
+                                    TexcoordOffset - NormalOffset);
+                    }
+                    else
+                    {
+                        std::memset(vertex + NormalOffset, 0, TexcoordOffset - NormalOffset);
+                    }
+                    if (texcoords.has_value())
+                    {
+                        std::memcpy(vertex + TexcoordOffset,
+                                    binChunk.data() + texcoords->offset + i * texcoords->stride,
+                                    VertexSize - TexcoordOffset);
+                    }
+                    else
+                    {
+                        std::memset(vertex + TexcoordOffset, 0, VertexSize - TexcoordOffset);
+                    }
+                }
+            }
+
+            auto isUnitTexcoords(std::span<uint8_t const> const binChunk) const -> bool
+            {
+                if (!texcoords.has_value())
+                {
+                    return true;
+                }
+
+                for (uint32_t const i : std::views::iota(0u, texcoords->count))
+                {
+                    auto const uv = readFloats<2>(binChunk, texcoords->offset + i * texcoords->stride);
+                    if (!(uv[0] >= 0.0f && uv[0] <= 1.0f && uv[1] >= 0.0f && uv[1] <= 1.0f))
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            auto writePacked(std::span<uint8_t const> const binChunk, mdl::VertexFormat const uvFormat,
+                             uint8_t* destination) const -> void
+            {
+                for (uint32_t const i : std::views::iota(0u, positions.count))
+                {
+                    auto const position = readFloats<3>(binChunk, positions.offset + i * positions.stride);
+                    math::Vec3f normal;
+                    if (normals.has_value())
+                    {
+                        auto const values = readFloats<3>(binChunk, normals->offset + i * normals->stride);
+                        normal = math::Vec3f(values[0], values[1], values[2]);
+                    }
+                    math::Vec2f uv;
+                    if (texcoords.has_value())
+                    {
+                        auto const values = readFloats<2>(binChunk, texcoords->offset + i * texcoords->stride);
+                        uv = math::Vec2f(values[0], values[1]);
+                    }
+
+                    mdl::PackedVertex const packedVertex = mdl::packVertex(
+                        math::Vec3f(position[0], position[1], position[2]), normal, uv, uvFormat);
+                    std::memcpy(destination + i * sizeof(mdl::PackedVertex), &packedVertex, sizeof(mdl::PackedVertex));
+                }
+            }
+        };
+
+        template <typename Type>
+        auto maxIndexOf(uint8_t const* source, size_t const stride, uint32_t const count) -> uint32_t
+        {
+            uint32_t maxIndex = 0;
+            for (uint32_t const i : std::views::iota(0u, count))
+            {
+                Type value;
+                std::memcpy(&value, source + i * stride, sizeof(Type));
+                maxIndex = std::max<uint32_t>(maxIndex, value);
+            }
+            return maxIndex;
+        }
+
+        template <typename Source, typename Destination>
+        auto convertIndices(uint8_t const* source, size_t const stride, uint32_t const count,
+                            uint8_t* destination) -> void
+        {
+            for (uint32_t const i : std::views::iota(0u, count))
+            {
+                Source value;
+                std::memcpy(&value, source + i * stride, sizeof(Source));
+                Destination const index = static_cast<Destination>(value);
+                std::memcpy(destination + i * sizeof(Destination), &index, sizeof(Destination));
+            }
+        }
+
+        template <typename Destination>
+        auto convertIndices(AccessorRange const& indices, std::span<uint8_t const> const binChunk,
+                            uint8_t* destination) -> void
+        {
+            uint8_t const* source = binChunk.data() + indices.offset;
+            switch (indices.componentType)
+            {
+                case gltf::ComponentUnsignedByte:
+                    convertIndices<uint8_t, Destination>(source, indices.stride, indices.count, destination);
+                    break;
+                case gltf::ComponentUnsignedShort:
+                    convertIndices<uint16_t, Destination>(source, indices.stride, indices.count, destination);
+                    break;
+                default:
+                    convertIndices<uint32_t, Destination>(source, indices.stride, indices.count, destination);
+                    break;
+            }
+        }
+
+        // Indices are relative to the first vertex of their attribute set, so sets with fewer than 65536 vertices
+        // get 16-bit indices
+        struct IndexSource
+        {
+            std::optional<AccessorRange> indices;
+            uint32_t vertexCount;
+
+            auto format() const -> mdl::IndexFormat
+            {
+                return vertexCount <= std::numeric_limits<uint16_t>::max() ? mdl::IndexFormat::UINT16
+                                                                           : mdl::IndexFormat::UINT32;
+            }
+
+            auto count() const -> uint32_t
+            {
+                return indices.has_value() ? indices->count : vertexCount;
+            }
+
+            auto size() const -> size_t
+            {
+                return count() * mdl::sizeof_IndexFormat(format());
+            }
+
+            // Tightly packed indices of the same width are stored as they are in the model file
+            auto isDirect() const -> bool
+            {
+                uint32_t const componentType = format() == mdl::IndexFormat::UINT16 ? gltf::ComponentUnsignedShort
+                                                                                     : gltf::ComponentUnsignedInt;
+                return indices.has_value() && indices->componentType == componentType &&
+                       indices->stride == sizeof_Component(componentType);
+            }
+
+            auto validate(std::span<uint8_t const> const binChunk) const -> void
+            {
+                if (!indices.has_value() || indices->count == 0)
+                {
+                    return;
+                }
+
+                uint8_t const* source = binChunk.data() + indices->offset;
+                uint32_t maxIndex;
+                switch (indices->componentType)
+                {
+                    case gltf::ComponentUnsignedByte:
+                        maxIndex = maxIndexOf<uint8_t>(source, indices->stride, indices->count);
+                        break;
+                    case gltf::ComponentUnsignedShort:
+                        maxIndex = maxIndexOf<uint16_t>(source, indices->stride, indices->count);
+                        break;
+                    default:
+                        maxIndex = maxIndexOf<uint32_t>(source, indices->stride, indices->count);
+                        break;
+                }
+
+                if (maxIndex >= vertexCount)
+                {
+                    throw core::runtime_error("A glTF primitive references a vertex out of range");
+                }
+            }
+
+            auto write(std::span<uint8_t const> const binChunk, uint8_t* destination) const -> void
+            {
+                bool const isUint16 = format() == mdl::IndexFormat::UINT16;
+                if (!indices.has_value())
+                {
+                    for (uint32_t const i : std::views::iota(0u, vertexCount))
+                    {
+                        if (isUint16)
+                        {
+                            uint16_t const index = static_cast<uint16_t>(i);
+                            std::memcpy(destination + i * sizeof(uint16_t), &index, sizeof(uint16_t));
+                        }
+                        else
+                        {
+                            std::memcpy(destination + i * sizeof(uint32_t), &i, sizeof(uint32_t));
+                        }
+                    }
+                    return;
+                }
+
+                if (isDirect())
+                {
+                    std::memcpy(destination, binChunk.data() + indices->offset, size());
+                }
+                else if (isUint16)
+                {
+                    convertIndices<uint16_t>(indices.value(), binChunk, destination);
+                }
+                else
+                {
+                    convertIndices<uint32_t>(indices.value(), binChunk, destination);
+                }
+            }
+        };
+    } // namespace
+
+    auto GLTFImporter::loadFromFile(std::filesystem::path const& filePath,
+                                    std::string& errors) -> std::optional<ModelFile>
+    {
+        core::ref_ptr<core::mapped_file> mapping;
+        try
+        {
+            mapping = core::make_ref<core::mapped_file>(filePath);
+        }
+        catch (core::runtime_error const& e)
+        {
+            errors = e.what();
+            return std::nullopt;
+        }
+
+        return readGLBToModelFile(mapping->data(), mapping, errors);
+    }
+
+    auto GLTFImporter::loadFromBytes(std::span<uint8_t const> const dataBytes,
+                                     std::string& errors) -> std::optional<ModelFile>
+    {
+        return readGLBToModelFile(dataBytes, nullptr, errors);
+    }
+
+    auto GLTFImporter::readGLBToModelFile(std::span<uint8_t const> const dataBytes,
+                                          core::ref_ptr<core::mapped_file> mapping,
+                                          std::string& errors) -> std::optional<ModelFile>
+    {
+        try
+        {
+            if (dataBytes.size() < 12 || std::memcmp(dataBytes.data(), gltf::Magic.data(), gltf::Magic.size()) != 0)
+            {
+                throw core::runtime_error("The data is not a binary glTF file");
+            }
+            if (readUint32(dataBytes, 4) != gltf::Version)
+            {
+                throw core::runtime_error("Only glTF 2.0 files are supported");
+            }
+
+            // The JSON chunk comes first, the binary chunk is optional and follows it
+            size_t const length = std::min<size_t>(readUint32(dataBytes, 8), dataBytes.size());
+            std::span<uint8_t const> jsonChunk;
+            std::span<uint8_t const> binChunk;
+            for (size_t offset = 12; offset + 8 <= length;)
+            {
+                size_t const chunkLength = readUint32(dataBytes, offset);
+                uint32_t const chunkType = readUint32(dataBytes, offset + 4);
+                if (chunkLength > length - offset - 8)
+                {
+                    throw core::runtime_error("A glTF chunk is out of the file range");
+                }
+
+                if (chunkType == gltf::ChunkJSON && jsonChunk.empty())
+                {
+                    jsonChunk = dataBytes.subspan(offset + 8, chunkLength);
+                }
+                else if (chunkType == gltf::ChunkBIN && binChunk.empty())
+                {
+                    binChunk = dataBytes.subspan(offset + 8, chunkLength);
+                }
+                offset += 8 + chunkLength;
+            }
+
+            if (jsonChunk.empty())
+            {
+                throw core::runtime_error("A glTF file has no JSON chunk");
+            }
+
+            gltf::DocumentData document;
+            {
+                std::string jsonData(reinterpret_cast<char const*>(jsonChunk.data()), jsonChunk.size());
+                jsonData.reserve(jsonData.size() + simdjson::SIMDJSON_PADDING);
+                core::serialize_ijson archive(
+                    simdjson::padded_string_view(jsonData.data(), jsonData.size(), jsonData.capacity()));
+                archive(document);
+            }
+
+            std::vector<VertexSource> vertexSources;
+            std::vector<uint32_t> baseVertices;
+            std::map<std::tuple<uint32_t, int64_t, int64_t>, uint32_t> vertexSourceIndices;
+            std::vector<IndexSource> indexSources;
+            std::map<std::tuple<int64_t, uint32_t>, uint32_t> indexSourceIndices;
+            uint64_t vertexCount = 0;
+
+            mdl::ModelData modelData{};
+
+            uint32_t const materialCount =
+                document.materials.has_value() ? static_cast<uint32_t>(document.materials->size()) : 0;
+            bool hasDefaultMaterial = false;
+
+            size_t const meshCount = document.meshes.has_value() ? document.meshes->size() : 0;
+            std::vector<std::vector<uint32_t>> meshSurfaces(meshCount);
+            for (uint32_t const meshIndex : std::views::iota(0u, meshCount))
+            {
+                for (auto const& primitive : (*document.meshes)[meshIndex].primitives)
+                {
+                    if (primitive.mode.value_or(gltf::ModeTriangles) != gltf::ModeTriangles)
+                    {
+                        throw core::runtime_error("Only triangle glTF primitives are supported");
+                    }
+
+                    auto const attribute = [&](std::string const& semantic) -> int64_t {
+                        auto const it = primitive.attributes.find(semantic);
+                        return it != primitive.attributes.end() ? static_cast<int64_t>(it->second) : -1;
+                    };
+
+                    int64_t const positions = attribute("POSITION");
+                    if (positions < 0)
+                    {
+                        throw core::runtime_error("A glTF primitive has no positions");
+                    }
+                    int64_t const normals = attribute("NORMAL");
+                    int64_t const texcoords = attribute("TEXCOORD_0");
+
+                    // Primitives often share their attributes, those are imported once
+                    auto const [vertexSourceIt, isVertexSourceInserted] = vertexSourceIndices.try_emplace(
+                        std::make_tuple(static_cast<uint32_t>(positions), normals, texcoords),
+                        static_cast<uint32_t>(vertexSources.size()));
+                    if (isVertexSourceInserted)
+                    {
+                        VertexSource vertexSource{.positions = getAccessorRange(document, binChunk,
+                                                                                static_cast<uint32_t>(positions),
+                                                                                "VEC3", {gltf::ComponentFloat}),
+                                                  .normals = std::nullopt,
+                                                  .texcoords = std::nullopt};
+                        if (normals >= 0)
+                        {
+                            vertexSource.normals =
+                                getAccessorRange(document, binChunk, static_cast<uint32_t>(normals), "VEC3",
+                                                 {gltf::ComponentFloat});
+                        }
+                        if (texcoords >= 0)
+                        {
+                            vertexSource.texcoords =
+                                getAccessorRange(document, binChunk, static_cast<uint32_t>(texcoords), "VEC2",
+                                                 {gltf::ComponentFloat});
+                        }
+                        if ((vertexSource.normals.has_value() &&
+                             vertexSource.normals->count != vertexSource.positions.count) ||
+                            (vertexSource.texcoords.has_value() &&
+                             vertexSource.texcoords->count != vertexSource.positions.count))
+                        {
+                            throw core::runtime_error("The attributes of a glTF primitive differ in count");
+                        }
+
+                        // Vertices of every attribute set are appended to the single vertex buffer of the model
+                        baseVertices.emplace_back(static_cast<uint32_t>(vertexCount));
+                        vertexCount += vertexSource.positions.count;
+                        vertexSources.emplace_back(std::move(vertexSource));
+                    }
+
+                    uint32_t const vertexSourceIndex = vertexSourceIt->second;
+                    int64_t const indices =
+                        primitive.indices.has_value() ? static_cast<int64_t>(primitive.indices.value()) : -1;
+                    auto const [indexSourceIt, isIndexSourceInserted] = indexSourceIndices.try_emplace(
+                        std::make_tuple(indices, vertexSourceIndex), static_cast<uint32_t>(indexSources.size()));
+                    if (isIndexSourceInserted)
+                    {
+                        IndexSource indexSource{.indices = std::nullopt,
+                                                .vertexCount = vertexSources[vertexSourceIndex].positions.count};
+                        if (primitive.indices.has_value())
+                        {
+                            indexSource.indices =
+                                getAccessorRange(document, binChunk, primitive.indices.value(), "SCALAR",
+                                                 {gltf::ComponentUnsignedByte, gltf::ComponentUnsignedShort,
+                                                  gltf::ComponentUnsignedInt});
+                        }
+
+                        indexSources.emplace_back(std::move(indexSource));
+                    }
+
+                    uint32_t material = materialCount;
+                    if (primitive.material.has_value())
+                    {
+                        if (primitive.material.value() >= materialCount)
+                        {
+                            throw core::runtime_error("A glTF file references an element out of range");
+                        }
+                        material = primitive.material.value();
+                    }
+                    else
+                    {
+                        hasDefaultMaterial = true;
+                    }
+
+                    meshSurfaces[meshIndex].emplace_back(static_cast<uint32_t>(modelData.surfaces.size()));
+
+                    // Index buffers go first, so the buffer of a surface is the index of its index source
+                    IndexSource const& indexSource = indexSources[indexSourceIt->second];
+                    mdl::SurfaceData surfaceData{.buffer = indexSourceIt->second,
+                                                 .material = material,
+                                                 .indexCount = indexSource.count(),
+                                                 .indexFormat = indexSource.format(),
+                                                 .vertexOffset = baseVertices[vertexSourceIndex],
+                                                 .meshletBuffer = std::nullopt};
+                    modelData.surfaces.emplace_back(std::move(surfaceData));
+                }
+            }
+
+            if (vertexCount > std::numeric_limits<uint32_t>::max())
+            {
+                throw core::runtime_error("A glTF file has too many vertices");
+            }
+
+            for (auto const& indexSource : indexSources)
+            {
+                indexSource.validate(binChunk);
+            }
+
+            modelData.objects.emplace();
+            if (document.nodes.has_value())
+            {
+                for (auto const& node : document.nodes.value())
+                {
+                    if (!node.mesh.has_value())
+                    {
+                        continue;
+                    }
+
+                    gltf::MeshData const& mesh = elementAt(document.meshes, node.mesh.value());
+                    mdl::ObjectData objectData{.name = node.name.value_or(mesh.name.value_or("")),
+                                               .surfaces = meshSurfaces[node.mesh.value()]};
+                    modelData.objects->emplace_back(std::move(objectData));
+                }
+            }
+
+            modelData.materialCount = materialCount + (hasDefaultMaterial ? 1 : 0);
+            modelData.buffer = static_cast<uint32_t>(indexSources.size());
+
+            size_t vertexSize = VertexSize;
+            mdl::VertexFormat uvFormat = mdl::VertexFormat::RG16_UNORM;
+            if (!options.isQuantized)
+            {
+                modelData.vertexLayout = mdl::floatVertexLayout();
+            }
+            else
+            {
+                for (auto const& vertexSource : vertexSources)
+                {
+                    if (!vertexSource.isUnitTexcoords(binChunk))
+                    {
+                        uvFormat = mdl::VertexFormat::RG16_FLOAT;
+                    }
+                }
+                vertexSize = sizeof(mdl::PackedVertex);
+                modelData.vertexLayout = mdl::packedVertexLayout(uvFormat);
+            }
+
+            // A mapped file is referenced as it is when every buffer is a range of the binary chunk already, which
+            // needs uncompressed interleaved vertices stored one attribute set after another and indices of the
+            // chosen width
+            bool isMappable = mapping && !options.isQuantized && !vertexSources.empty();
+            for (uint32_t const i : std::views::iota(0u, vertexSources.size()))
+            {
+                isMappable = isMappable && vertexSources[i].isInterleaved() &&
+                             (i == 0 || vertexSources[i].positions.offset ==
+                                            vertexSources[i - 1].positions.offset +
+                                                vertexSources[i - 1].positions.count * VertexSize);
+            }
+            for (auto const& indexSource : indexSources)
+            {
+                isMappable = isMappable && indexSource.isDirect();
+            }
+
+            if (isMappable)
+            {
+                for (auto const& indexSource : indexSources)
+                {
+                    modelData.buffers.emplace_back(
+                        mdl::BufferData{.offset = indexSource.indices->offset, .size = indexSource.size()});
+                }
+                modelData.buffers.emplace_back(mdl::BufferData{.offset = vertexSources[0].positions.offset,
+                                                               .size = vertexCount * VertexSize});
+
+                // The blob views only the part of the binary chunk the buffers cover
+                uint64_t begin = std::numeric_limits<uint64_t>::max();
+                uint64_t end = 0;
+                for (auto const& bufferData : modelData.buffers)
+                {
+                    begin = std::min(begin, bufferData.offset);
+                    end = std::max(end, bufferData.offset + bufferData.size);
+                }
+                for (auto& bufferData : modelData.buffers)
+                {
+                    bufferData.offset -= begin;
+                }
+
+                return ModelFile{.magic = mdl::Magic,
+                                 .modelData = std::move(modelData),
+                                 .blob = core::blob(mapping, binChunk.subspan(begin, end - begin))};
+            }
+
+            uint64_t blobSize = 0;
+            for (auto const& indexSource : indexSources)
+            {
+                modelData.buffers.emplace_back(mdl::BufferData{.offset = blobSize, .size = indexSource.size()});
+                blobSize += modelData.buffers.back().size;
+            }
+            modelData.buffers.emplace_back(mdl::BufferData{.offset = blobSize, .size = vertexCount * vertexSize});
+            blobSize += modelData.buffers.back().size;
+
+            std::vector<uint8_t> blob(blobSize);
+            for (uint32_t const i : std::views::iota(0u, indexSources.size()))
+            {
+                indexSources[i].write(binChunk, blob.data() + modelData.buffers[i].offset);
+            }
+            for (uint32_t const i : std::views::iota(0u, vertexSources.size()))
+            {
+                uint8_t* vertices =
+                    blob.data() + modelData.buffers[modelData.buffer].offset + baseVertices[i] * vertexSize;
+                if (options.isQuantized)
+                {
+                    vertexSources[i].writePacked(binChunk, uvFormat, vertices);
+                }
+                else
+                {
+                    vertexSources[i].write(binChunk, vertices);
+                }
+            }
+
+            return ModelFile{.magic = mdl::Magic, .modelData = std::move(modelData), .blob = std::move(blob)};
+        }
+        catch (core::runtime_error const& e)
+        {
+            errors = e.what();
+            return std::nullopt;
+        }
+    }
+} // namespace ionengine::asset
@@ -0,0 +1,185 @@
+// Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
+
+#pragma once
+
+#include "core/mapped_file.hpp"
+#include "mdl/importer.hpp"
+
+namespace ionengine::asset
+{
+    namespace gltf
+    {
+        std::array<uint8_t, 4> constexpr Magic{'g', 'l', 'T', 'F'};
+        uint32_t constexpr Version = 2;
+        uint32_t constexpr ChunkJSON = 0x4E4F534A;
+        uint32_t constexpr ChunkBIN = 0x004E4942;
+
+        uint32_t constexpr ComponentUnsignedByte = 5121;
+        uint32_t constexpr ComponentUnsignedShort = 5123;
+        uint32_t constexpr ComponentUnsignedInt = 5125;
+        uint32_t constexpr ComponentFloat = 5126;
+
+        uint32_t constexpr ModeTriangles = 4;
+
+        // Subset of the glTF 2.0 schema used by the importer, other properties are skipped while parsing
+
+        struct BufferData
+        {
+            uint64_t byteLength;
+            std::optional<std::string> uri;
+
+            template <typename Archive>
+            auto operator()(Archive& archive)
+            {
+                archive.property(byteLength, "byteLength");
+                archive.property(uri, "uri");
+            }
+        };
+
+        struct BufferViewData
+        {
+            uint32_t buffer;
+            std::optional<uint64_t> byteOffset;
+            uint64_t byteLength;
+            std::optional<uint32_t> byteStride;
+
+            template <typename Archive>
+            auto operator()(Archive& archive)
+            {
+                archive.property(buffer, "buffer");
+                archive.property(byteOffset, "byteOffset");
+                archive.property(byteLength, "byteLength");
+                archive.property(byteStride, "byteStride");
+            }
+        };
+
+        struct AccessorSparseData
+        {
+            uint32_t count;
+
+            template <typename Archive>
+            auto operator()(Archive& archive)
+            {
+                archive.property(count, "count");
+            }
+        };
+
+        struct AccessorData
+        {
+            std::optional<uint32_t> bufferView;
+            std::optional<uint64_t> byteOffset;
+            uint32_t componentType;
+            std::optional<bool> normalized;
+            uint32_t count;
+            std::string type;
+            std::optional<AccessorSparseData> sparse;
+
+            template <typename Archive>
+            auto operator()(Archive& archive)
+            {
+                archive.property(bufferView, "bufferView");
+                archive.property(byteOffset, "byteOffset");
+                archive.property(componentType, "componentType");
+                archive.property(normalized, "normalized");
+                archive.property(count, "count");
+                archive.property(type, "type");
+                archive.property(sparse, "sparse");
+            }
+        };
+
+        struct PrimitiveData
+        {
+            std::unordered_map<std::string, uint32_t> attributes;
+            std::optional<uint32_t> indices;
+            std::optional<uint32_t> material;
+            std::optional<uint32_t> mode;
+
+            template <typename Archive>
+            auto operator()(Archive& archive)
+            {
+                archive.property(attributes, "attributes");
+                archive.property(indices, "indices");
+                archive.property(material, "material");
+                archive.property(mode, "mode");
+            }
+        };
+
+        struct MeshData
+        {
+            std::optional<std::string> name;
+            std::vector<PrimitiveData> primitives;
+
+            template <typename Archive>
+            auto operator()(Archive& archive)
+            {
+                archive.property(name, "name");
+                archive.property(primitives, "primitives");
+            }
+        };
+
+        struct NodeData
+        {
+            std::optional<std::string> name;
+            std::optional<uint32_t> mesh;
+
+            template <typename Archive>
+            auto operator()(Archive& archive)
+            {
+                archive.property(name, "name");
+                archive.property(mesh, "mesh");
+            }
+        };
+
+        struct MaterialData
+        {
+            std::optional<std::string> name;
+
+            template <typename Archive>
+            auto operator()(Archive& archive)
+            {
+                archive.property(name, "name");
+            }
+        };
+
+        struct DocumentData
+        {
+            std::optional<std::vector<BufferData>> buffers;
+            std::optional<std::vector<BufferViewData>> bufferViews;
+            std::optional<std::vector<AccessorData>> accessors;
+            std::optional<std::vector<MeshData>> meshes;
+            std::optional<std::vector<NodeData>> nodes;
+            std::optional<std::vector<MaterialData>> materials;
+
+            template <typename Archive>
+            auto operator()(Archive& archive)
+            {
+                archive.property(buffers, "buffers");
+                archive.property(bufferViews, "bufferViews");
+                archive.property(accessors, "accessors");
+                archive.property(meshes, "meshes");
+                archive.property(nodes, "nodes");
+                archive.property(materials, "materials");
+            }
+        };
+    } // namespace gltf
+
+    // Imports binary glTF 2.0 files. Every primitive becomes a surface and every node with a mesh becomes an object.
+    // Vertices are compressed to mdl::PackedVertex when the options ask for it. Data that already has the layout of
+    // the model file is copied as is, and a mapped file whose binary chunk can be used without changes is referenced
+    // by the blob instead of being copied.
+    class GLTFImporter : public MDLImporter
+    {
+      public:
+        using MDLImporter::MDLImporter;
+
+        auto loadFromFile(std::filesystem::path const& filePath,
+                          std::string& errors) -> std::optional<ModelFile> override;
+
+        auto loadFromBytes(std::span<uint8_t const> const dataBytes,
+                           std::string& errors) -> std::optional<ModelFile> override;
+
+      private:
+        auto readGLBToModelFile(std::span<uint8_t const> const dataBytes, core::ref_ptr<core::mapped_file> mapping,
+                                std::string& errors) -> std::optional<ModelFile>;
+    };
+} // namespace ionengine::asset
@@ -7,9 +7,20 @@
 
 namespace ionengine::asset
 {
+    struct MDLImportOptions
+    {
+        // Compresses vertices to mdl::PackedVertex. Pipelines take their input layout from the shaders, which read
+        // full precision attributes, so packed models only render once the layout comes from the model.
+        bool isQuantized = false;
+    };
+
     class MDLImporter : public core::ref_counted_object
     {
       public:
+        MDLImporter(MDLImportOptions const& options = {}) : options(options)
+        {
+        }
+
         virtual ~MDLImporter() = default;
 
         virtual auto loadFromFile(std::filesystem::path const& filePath,
@@ -17,5 +28,8 @@ namespace ionengine::asset
 
         virtual auto loadFromBytes(std::span<uint8_t const> const dataBytes,
                                    std::string& errors) -> std::optional<ModelFile> = 0;
+
+      protected:
+        MDLImportOptions options;
     };
 } // namespace ionengine::mdl
\ No newline at end of file
@@ -35,6 +35,27 @@ namespace ionengine::asset::mdl
                 return sizeof(int32_t);
             case VertexFormat::R32_UINT:
                 return sizeof(uint32_t);
+            case VertexFormat::RG16_UNORM:
+                return sizeof(uint16_t) * 2;
+            case VertexFormat::RG16_SNORM:
+                return sizeof(int16_t) * 2;
+            case VertexFormat::RG16_FLOAT:
+                return sizeof(uint16_t) * 2;
+            case VertexFormat::RGBA8_SNORM:
+                return sizeof(int8_t) * 4;
+            default:
+                return 0;
+        }
+    }
+
+    auto sizeof_IndexFormat(IndexFormat const format) -> size_t
+    {
+        switch (format)
+        {
+            case IndexFormat::UINT16:
+                return sizeof(uint16_t);
+            case IndexFormat::UINT32:
+                return sizeof(uint32_t);
             default:
                 return 0;
         }
@@ -8,7 +8,11 @@ namespace ionengine::asset
 {
     namespace mdl
     {
-        std::array<uint8_t, 4> constexpr Magic{'M', 'D', '1', '0'};
+        std::array<uint8_t, 4> constexpr Magic{'M', 'D', '1', '2'};
+        // Files written before strings in the binary sections were length-prefixed
+        std::array<uint8_t, 4> constexpr MagicV10{'M', 'D', '1', '0'};
+        // Files written before blobs carried a checksum
+        std::array<uint8_t, 4> constexpr MagicV11{'M', 'D', '1', '1'};
 
         enum class VertexFormat
         {
@@ -23,11 +27,23 @@ namespace ionengine::asset
             RGB32_FLOAT,
             RGBA32_UINT,
             RGBA32_SINT,
-            RGBA32_FLOAT
+            RGBA32_FLOAT,
+            RG16_UNORM,
+            RG16_SNORM,
+            RG16_FLOAT,
+            RGBA8_SNORM
         };
 
         auto sizeof_VertexFormat(VertexFormat const format) -> size_t;
 
+        enum class IndexFormat
+        {
+            UINT16,
+            UINT32
+        };
+
+        auto sizeof_IndexFormat(IndexFormat const format) -> size_t;
+
         struct BufferData
         {
             uint64_t offset;
@@ -46,6 +62,13 @@ namespace ionengine::asset
             uint32_t buffer;
             uint32_t material;
             uint32_t indexCount;
+            // Both are absent in files written before 16-bit indices, whose surfaces index the whole vertex buffer
+            // with 32-bit indices
+            std::optional<IndexFormat> indexFormat;
+            // First vertex of the surface in the vertex buffer, indices are relative to it
+            std::optional<uint32_t> vertexOffset;
+            // Buffer with the MeshletData array of the index buffer
+            std::optional<uint32_t> meshletBuffer;
 
             template <typename Archive>
             auto operator()(Archive& archive)
@@ -53,9 +76,30 @@ namespace ionengine::asset
                 archive.property(buffer, "buffer");
                 archive.property(material, "material");
                 archive.property(indexCount, "indexCount");
+                archive.property(indexFormat, "indexFormat");
+                archive.property(vertexOffset, "vertexOffset");
+                archive.property(meshletBuffer, "meshletBuffer");
             }
         };
 
+        uint32_t constexpr MeshletMaxVertices = 64;
+        uint32_t constexpr MeshletMaxTriangles = 124;
+
+        // Run of consecutive triangles of an index buffer with bounds for culling, stored in the blob as it is. The
+        // triangles face away from a camera at position p when dot(normalize(coneApex - p), coneAxis) > coneCutoff.
+        struct MeshletData
+        {
+            uint32_t indexOffset;
+            uint32_t triangleCount;
+            std::array<float, 3> center;
+            float radius;
+            std::array<float, 3> coneApex;
+            std::array<float, 3> coneAxis;
+            float coneCutoff;
+        };
+
+        static_assert(sizeof(MeshletData) == 52, "MeshletData is written to the blob as is");
+
         struct VertexLayoutElementData
         {
             VertexFormat format;
@@ -82,11 +126,27 @@ namespace ionengine::asset
             }
         };
 
+        // Named group of surfaces, such as a node of the source scene
+        struct ObjectData
+        {
+            std::string name;
+            std::vector<uint32_t> surfaces;
+
+            template <typename Archive>
+            auto operator()(Archive& archive)
+            {
+                archive.property(name, "name");
+                archive.property(surfaces, "surfaces");
+            }
+        };
+
         struct ModelData
         {
             uint32_t materialCount;
             uint32_t buffer;
             VertexLayoutData vertexLayout;
+            // Absent in files written before surfaces were grouped
+            std::optional<std::vector<ObjectData>> objects;
             std::vector<SurfaceData> surfaces;
             std::vector<BufferData> buffers;
 
@@ -96,6 +156,7 @@ namespace ionengine::asset
                 archive.property(materialCount, "materialCount");
                 archive.property(buffer, "buffer");
                 archive.property(vertexLayout, "vertexLayout");
+                archive.property(objects, "objects");
                 archive.property(surfaces, "surfaces");
                 archive.property(buffers, "buffers");
             }
@@ -106,12 +167,15 @@ namespace ionengine::asset
     {
         std::array<uint8_t, mdl::Magic.size()> magic;
         mdl::ModelData modelData;
-        std::vector<uint8_t> blob;
+        core::blob blob;
 
         template <typename Archive>
         auto operator()(Archive& archive)
         {
             archive.property(magic);
+            archive.revision(magic == mdl::MagicV10   ? core::archive_revision::v10
+                             : magic == mdl::MagicV11 ? core::archive_revision::v11
+                                                     : core::archive_revision::latest);
             archive.template with<core::serialize_ojson, core::serialize_ijson>(modelData);
             archive.property(blob);
         }
@@ -138,6 +202,21 @@ namespace ionengine::core
             archive.field(asset::mdl::VertexFormat::R32_FLOAT, "R32_FLOAT");
             archive.field(asset::mdl::VertexFormat::R32_SINT, "R32_SINT");
             archive.field(asset::mdl::VertexFormat::R32_UINT, "R32_UINT");
+            archive.field(asset::mdl::VertexFormat::RG16_UNORM, "RG16_UNORM");
+            archive.field(asset::mdl::VertexFormat::RG16_SNORM, "RG16_SNORM");
+            archive.field(asset::mdl::VertexFormat::RG16_FLOAT, "RG16_FLOAT");
+            archive.field(asset::mdl::VertexFormat::RGBA8_SNORM, "RGBA8_SNORM");
+        }
+    };
+
+    template <>
+    struct serializable_enum<asset::mdl::IndexFormat>
+    {
+        template <typename Archive>
+        auto operator()(Archive& archive)
+        {
+            archive.field(asset::mdl::IndexFormat::UINT16, "UINT16");
+            archive.field(asset::mdl::IndexFormat::UINT32, "UINT32");
         }
     };
 } // namespace ionengine::core
\ No newline at end of file
@@ -1,10 +1,48 @@
 // Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
 
 #include "obj.hpp"
+#include "core/flat_hash_map.hpp"
+#include "mdl/quantize.hpp"
 #include "precompiled.h"
 
 namespace ionengine::asset
 {
+    namespace
+    {
+        // Runs the function for every index on a thread per core, indices are handed out one at a time so that
+        // large and small items balance out
+        template <typename Func>
+        auto parallelFor(size_t const count, Func&& func) -> void
+        {
+            size_t const threadCount = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), count);
+            if (threadCount <= 1)
+            {
+                for (size_t const i : std::views::iota(0u, count))
+                {
+                    func(i);
+                }
+                return;
+            }
+
+            std::atomic<size_t> next = 0;
+            std::vector<std::thread> threads;
+            threads.reserve(threadCount);
+            while (threads.size() < threadCount)
+            {
+                threads.emplace_back([&]() {
+                    for (size_t i = next++; i < count; i = next++)
+                    {
+                        func(i);
+                    }
+                });
+            }
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+        }
+    } // namespace
+
     auto OBJImporter::loadFromFile(std::filesystem::path const& filePath,
                                    std::string& errors) -> std::optional<ModelFile>
     {
@@ -34,104 +72,285 @@ namespace ionengine::asset
         return readOBJToModelFile(objReader, errors);
     }
 
-    auto OBJImporter::readOBJToModelFile(tinyobj::ObjReader const& reader,
-                                         std::string& errors) -> std::optional<ModelFile>
+    auto OBJImporter::weldShape(tinyobj::attrib_t const& attrib, tinyobj::shape_t const& shape) -> ShapeData
     {
-        tinyobj::attrib_t const& attrib = reader.GetAttrib();
-        std::vector<tinyobj::shape_t> const& shapes = reader.GetShapes();
+        ShapeData shapeData;
+        shapeData.indices.reserve(shape.mesh.indices.size());
 
-        uint32_t materialIndex = 0;
-        std::unordered_map<Vertex, uint32_t, VertexHasher> uniqueVertices{};
-        std::vector<Vertex> vertices;
-        std::vector<uint32_t> indices;
+        core::flat_hash_map<Vertex, uint32_t, VertexHasher> uniqueVertices(
+            std::min(shape.mesh.indices.size(), attrib.vertices.size() / 3));
 
-        std::basic_stringstream<uint8_t> streambuf;
+        size_t offset = 0;
+        for (size_t f = 0; f < shape.mesh.num_face_vertices.size(); ++f)
+        {
+            size_t const fv = static_cast<size_t>(shape.mesh.num_face_vertices[f]);
 
-        mdl::ModelData modelData{};
+            for (size_t v = 0; v < fv; ++v)
+            {
+                tinyobj::index_t const index = shape.mesh.indices[offset + v];
 
-        for (auto const& shape : shapes)
-        {
-            indices.clear();
+                tinyobj::real_t const vx = attrib.vertices[3 * static_cast<size_t>(index.vertex_index) + 0];
+                tinyobj::real_t const vy = attrib.vertices[3 * static_cast<size_t>(index.vertex_index) + 1];
+                tinyobj::real_t const vz = attrib.vertices[3 * static_cast<size_t>(index.vertex_index) + 2];
 
-            std::cout << "shape v " << shape.mesh.num_face_vertices.size() << std::endl;
+                Vertex vertex{.position = math::Vec3f(vx, vy, vz),
+                              .normal = math::Vec3f(0.0f, 0.0f, 0.0f),
+                              .uv = math::Vec2f(0.0f, 0.0f)};
 
-            size_t offset = 0;
-            for (size_t f = 0; f < shape.mesh.num_face_vertices.size(); ++f)
-            {
-                size_t const fv = static_cast<size_t>(shape.mesh.num_face_vertices[f]);
+                if (index.normal_index >= 0)
+                {
+                    tinyobj::real_t const nx = attrib.normals[3 * static_cast<size_t>(index.normal_index) + 0];
+                    tinyobj::real_t const ny = attrib.normals[3 * static_cast<size_t>(index.normal_index) + 1];
+                    tinyobj::real_t const nz = attrib.normals[3 * static_cast<size_t>(index.normal_index) + 2];
 
-                for (size_t v = 0; v < fv; ++v)
+                    vertex.normal = math::Vec3f(nx, ny, nz);
+                }
+
+                if (index.texcoord_index >= 0)
                 {
-                    tinyobj::index_t const index = shape.mesh.indices[offset + v];
+                    tinyobj::real_t const tx = attrib.texcoords[2 * static_cast<size_t>(index.texcoord_index) + 0];
+                    tinyobj::real_t const ty = attrib.texcoords[2 * static_cast<size_t>(index.texcoord_index) + 1];
 
-                    tinyobj::real_t const vx = attrib.vertices[3 * static_cast<size_t>(index.vertex_index) + 0];
-                    tinyobj::real_t const vy = attrib.vertices[3 * static_cast<size_t>(index.vertex_index) + 1];
-                    tinyobj::real_t const vz = attrib.vertices[3 * static_cast<size_t>(index.vertex_index) + 2];
+                    vertex.uv = math::Vec2f(tx, ty);
+                }
 
-                    Vertex vertex{.position = math::Vec3f(vx, vy, vz)};
+                auto const [vertexIndex, isInserted] =
+                    uniqueVertices.try_emplace(vertex, static_cast<uint32_t>(shapeData.vertices.size()));
+                if (isInserted)
+                {
+                    shapeData.vertices.emplace_back(vertex);
+                }
 
-                    if (index.normal_index >= 0)
-                    {
-                        tinyobj::real_t const nx = attrib.normals[3 * static_cast<size_t>(index.normal_index) + 0];
-                        tinyobj::real_t const ny = attrib.normals[3 * static_cast<size_t>(index.normal_index) + 1];
-                        tinyobj::real_t const nz = attrib.normals[3 * static_cast<size_t>(index.normal_index) + 2];
+                shapeData.indices.emplace_back(vertexIndex);
+            }
 
-                        vertex.normal = math::Vec3f(nx, ny, nz);
-                    }
+            offset += fv;
+        }
+        return shapeData;
+    }
 
-                    if (index.texcoord_index >= 0)
-                    {
-                        tinyobj::real_t const tx = attrib.texcoords[2 * static_cast<size_t>(index.texcoord_index) + 0];
-                        tinyobj::real_t const ty = attrib.texcoords[2 * static_cast<size_t>(index.texcoord_index) + 1];
+    auto OBJImporter::readOBJToModelFile(tinyobj::ObjReader const& reader,
+                                         std::string& errors) -> std::optional<ModelFile>
+    {
+        tinyobj::attrib_t const& attrib = reader.GetAttrib();
+        std::vector<tinyobj::shape_t> const& shapes = reader.GetShapes();
 
-                        vertex.uv = math::Vec2f(tx, ty);
-                    }
+        std::vector<ShapeData> shapeDatas(shapes.size());
+        parallelFor(shapes.size(), [&](size_t const i) { shapeDatas[i] = weldShape(attrib, shapes[i]); });
 
-                    if (uniqueVertices.count(vertex) == 0)
-                    {
-                        uniqueVertices[vertex] = static_cast<size_t>(vertices.size());
-                        vertices.emplace_back(vertex);
-                    }
+        // Welded vertices of the shapes are numbered one after another from the prefix sums of their counts
+        std::vector<uint64_t> baseVertices(shapes.size());
+        uint64_t weldedCount = 0;
+        for (size_t const i : std::views::iota(0u, shapes.size()))
+        {
+            baseVertices[i] = weldedCount;
+            weldedCount += shapeDatas[i].vertices.size();
+        }
+
+        if (weldedCount > std::numeric_limits<uint32_t>::max())
+        {
+            errors = "An OBJ file has too many vertices";
+            return std::nullopt;
+        }
 
-                    indices.emplace_back(uniqueVertices[vertex]);
+        // Vertices shared between shapes are merged, in the order the shapes first use them. Welded vertices are
+        // split into partitions by their hash and every partition is merged on its own, the partition bits sit below
+        // the ones flat_hash_map keeps in its control bytes
+        uint32_t constexpr partitionCount = 256;
+        size_t constexpr blockSize = 64 * 1024;
+        size_t const blockCount = (weldedCount + blockSize - 1) / blockSize;
+
+        auto const weldedVertex = [&](uint64_t const welded) -> Vertex const& {
+            size_t const shape = std::ranges::upper_bound(baseVertices, welded) - baseVertices.begin() - 1;
+            return shapeDatas[shape].vertices[welded - baseVertices[shape]];
+        };
+
+        // Calls the function for the welded vertices of a block, numbered across all shapes
+        auto const forEachWelded = [&](size_t const block, auto&& func) {
+            uint64_t const first = block * blockSize;
+            uint64_t const last = std::min<uint64_t>(first + blockSize, weldedCount);
+            size_t shape = std::ranges::upper_bound(baseVertices, first) - baseVertices.begin() - 1;
+            for (uint64_t welded = first; welded < last; ++welded)
+            {
+                while (welded - baseVertices[shape] >= shapeDatas[shape].vertices.size())
+                {
+                    ++shape;
                 }
+                func(static_cast<uint32_t>(welded), shapeDatas[shape].vertices[welded - baseVertices[shape]]);
+            }
+        };
+
+        std::vector<uint8_t> partitions(weldedCount);
+        std::vector<uint64_t> partitionOffsets(blockCount * partitionCount, 0);
+        parallelFor(blockCount, [&](size_t const block) {
+            forEachWelded(block, [&](uint32_t const welded, Vertex const& vertex) {
+                partitions[welded] = static_cast<uint8_t>(VertexHasher()(vertex) >> 49);
+                ++partitionOffsets[block * partitionCount + partitions[welded]];
+            });
+        });
+
+        // A partition lists its welded vertices in order, so blocks follow each other inside it
+        std::vector<uint64_t> partitionStarts(partitionCount + 1, 0);
+        uint64_t partitionOffset = 0;
+        for (uint32_t const partition : std::views::iota(0u, partitionCount))
+        {
+            partitionStarts[partition] = partitionOffset;
+            for (size_t const block : std::views::iota(0u, blockCount))
+            {
+                partitionOffset +=
+                    std::exchange(partitionOffsets[block * partitionCount + partition], partitionOffset);
+            }
+        }
+        partitionStarts[partitionCount] = partitionOffset;
+
+        std::vector<uint32_t> partitionVertices(weldedCount);
+        parallelFor(blockCount, [&](size_t const block) {
+            forEachWelded(block, [&](uint32_t const welded, Vertex const&) {
+                partitionVertices[partitionOffsets[block * partitionCount + partitions[welded]]++] = welded;
+            });
+        });
+
+        // Every welded vertex points to the first welded vertex equal to it
+        std::vector<uint32_t> firstVertices(weldedCount);
+        parallelFor(partitionCount, [&](size_t const partition) {
+            std::span<uint32_t const> const welds(partitionVertices.data() + partitionStarts[partition],
+                                                  partitionStarts[partition + 1] - partitionStarts[partition]);
+            core::flat_hash_map<Vertex, uint32_t, VertexHasher> uniqueVertices(welds.size());
+            for (uint32_t const welded : welds)
+            {
+                firstVertices[welded] = uniqueVertices.try_emplace(weldedVertex(welded), welded).first;
+            }
+        });
+
+        // First welded vertices are numbered in order from the prefix sums of their counts in the blocks
+        std::vector<uint32_t> blockStarts(blockCount, 0);
+        parallelFor(blockCount, [&](size_t const block) {
+            forEachWelded(block, [&](uint32_t const welded, Vertex const&) {
+                blockStarts[block] += firstVertices[welded] == welded;
+            });
+        });
+
+        uint32_t vertexCount = 0;
+        for (uint32_t& blockStart : blockStarts)
+        {
+            vertexCount += std::exchange(blockStart, vertexCount);
+        }
 
-                offset += fv;
+        std::vector<Vertex> vertices(vertexCount);
+        std::vector<uint32_t> remap(weldedCount);
+        parallelFor(blockCount, [&](size_t const block) {
+            uint32_t vertexIndex = blockStarts[block];
+            forEachWelded(block, [&](uint32_t const welded, Vertex const& vertex) {
+                if (firstVertices[welded] == welded)
+                {
+                    remap[welded] = vertexIndex;
+                    vertices[vertexIndex++] = vertex;
+                }
+            });
+        });
+
+        // Indices of every shape point into the merged vertices, shapes that only use the first 65536 of them get
+        // 16-bit indices
+        std::vector<uint32_t> maxIndices(shapes.size(), 0);
+        parallelFor(shapes.size(), [&](size_t const i) {
+            for (uint32_t& index : shapeDatas[i].indices)
+            {
+                index = remap[firstVertices[baseVertices[i] + index]];
+                maxIndices[i] = std::max(maxIndices[i], index);
             }
+        });
 
-            mdl::SurfaceData surfaceData{.buffer = static_cast<uint32_t>(modelData.buffers.size()),
-                                         .material = materialIndex,
-                                         .indexCount = static_cast<uint32_t>(indices.size())};
-            modelData.surfaces.emplace_back(std::move(surfaceData));
+        mdl::ModelData modelData{};
 
-            mdl::BufferData bufferData{.offset = static_cast<uint64_t>(streambuf.tellp()),
-                                       .size = indices.size() * sizeof(uint32_t)};
-            modelData.buffers.emplace_back(std::move(bufferData));
+        bool isUnitTexcoords = true;
+        if (options.isQuantized)
+        {
+            for (auto const& vertex : vertices)
+            {
+                isUnitTexcoords &=
+                    vertex.uv.x >= 0.0f && vertex.uv.x <= 1.0f && vertex.uv.y >= 0.0f && vertex.uv.y <= 1.0f;
+            }
+        }
+        mdl::VertexFormat const uvFormat =
+            isUnitTexcoords ? mdl::VertexFormat::RG16_UNORM : mdl::VertexFormat::RG16_FLOAT;
 
-            streambuf.write(reinterpret_cast<uint8_t const*>(indices.data()), indices.size() * sizeof(uint32_t));
+        // Index buffers of the shapes go first and the shared vertex buffer follows them
+        uint64_t blobSize = 0;
+        modelData.objects.emplace();
+        for (size_t const i : std::views::iota(0u, shapes.size()))
+        {
+            mdl::ObjectData objectData{.name = shapes[i].name, .surfaces = {static_cast<uint32_t>(i)}};
+            modelData.objects->emplace_back(std::move(objectData));
+
+            mdl::IndexFormat const indexFormat = maxIndices[i] <= std::numeric_limits<uint16_t>::max()
+                                                     ? mdl::IndexFormat::UINT16
+                                                     : mdl::IndexFormat::UINT32;
+
+            mdl::SurfaceData surfaceData{.buffer = static_cast<uint32_t>(i),
+                                         .material = static_cast<uint32_t>(i),
+                                         .indexCount = static_cast<uint32_t>(shapeDatas[i].indices.size()),
+                                         .indexFormat = indexFormat,
+                                         .vertexOffset = 0,
+                                         .meshletBuffer = std::nullopt};
+            modelData.surfaces.emplace_back(std::move(surfaceData));
 
-            materialIndex++;
+            mdl::BufferData bufferData{.offset = blobSize,
+                                       .size = shapeDatas[i].indices.size() * mdl::sizeof_IndexFormat(indexFormat)};
+            modelData.buffers.emplace_back(std::move(bufferData));
+            blobSize += modelData.buffers.back().size;
         }
 
-        modelData.materialCount = materialIndex;
+        modelData.materialCount = static_cast<uint32_t>(shapes.size());
         modelData.buffer = static_cast<uint32_t>(modelData.buffers.size());
 
-        mdl::VertexLayoutData vertexLayoutData{
-            .elements = {mdl::VertexLayoutElementData{.format = mdl::VertexFormat::RGB32_FLOAT, .semantic = "POSITION"},
-                         mdl::VertexLayoutElementData{.format = mdl::VertexFormat::RGB32_FLOAT, .semantic = "NORMAL"},
-                         mdl::VertexLayoutElementData{.format = mdl::VertexFormat::RG32_FLOAT,
-                                                      .semantic = "TEXCOORD0"}},
-            .size = 32};
-        modelData.vertexLayout = std::move(vertexLayoutData);
+        size_t const vertexSize = options.isQuantized ? sizeof(mdl::PackedVertex) : sizeof(Vertex);
+        modelData.vertexLayout = options.isQuantized ? mdl::packedVertexLayout(uvFormat) : mdl::floatVertexLayout();
 
-        mdl::BufferData bufferData{.offset = static_cast<uint64_t>(streambuf.tellp()),
-                                   .size = vertices.size() * sizeof(Vertex)};
+        mdl::BufferData bufferData{.offset = blobSize, .size = vertices.size() * vertexSize};
         modelData.buffers.emplace_back(std::move(bufferData));
+        blobSize += modelData.buffers.back().size;
+
+        // Every shape writes its own range of the blob
+        std::vector<uint8_t> blob(blobSize);
+        parallelFor(shapes.size(), [&](size_t const i) {
+            ShapeData shapeData = std::move(shapeDatas[i]);
+
+            uint8_t* indices = blob.data() + modelData.buffers[i].offset;
+            if (modelData.surfaces[i].indexFormat == mdl::IndexFormat::UINT16)
+            {
+                for (size_t const j : std::views::iota(0u, shapeData.indices.size()))
+                {
+                    uint16_t const index = static_cast<uint16_t>(shapeData.indices[j]);
+                    std::memcpy(indices + j * sizeof(uint16_t), &index, sizeof(uint16_t));
+                }
+            }
+            else
+            {
+                std::memcpy(indices, shapeData.indices.data(), shapeData.indices.size() * sizeof(uint32_t));
+            }
+        });
 
-        streambuf.write(reinterpret_cast<uint8_t const*>(vertices.data()), vertices.size() * sizeof(Vertex));
+        uint8_t* destination = blob.data() + modelData.buffers[modelData.buffer].offset;
+        if (!options.isQuantized)
+        {
+            std::memcpy(destination, vertices.data(), vertices.size() * sizeof(Vertex));
+        }
+        else
+        {
+            size_t constexpr BlockSize = 64 * 1024;
+            parallelFor((vertices.size() + BlockSize - 1) / BlockSize, [&](size_t const block) {
+                size_t const end = std::min(vertices.size(), (block + 1) * BlockSize);
+                for (size_t const j : std::views::iota(block * BlockSize, end))
+                {
+                    Vertex const& vertex = vertices[j];
+                    mdl::PackedVertex const packedVertex =
+                        mdl::packVertex(vertex.position, vertex.normal, vertex.uv, uvFormat);
+                    std::memcpy(destination + j * sizeof(mdl::PackedVertex), &packedVertex,
+                                sizeof(mdl::PackedVertex));
+                }
+            });
+        }
 
-        return ModelFile{.magic = mdl::Magic,
-                         .modelData = std::move(modelData),
-                         .blob = {std::istreambuf_iterator<uint8_t>(streambuf.rdbuf()), {}}};
+        return ModelFile{.magic = mdl::Magic, .modelData = std::move(modelData), .blob = std::move(blob)};
     }
 } // namespace ionengine::mdl
\ No newline at end of file
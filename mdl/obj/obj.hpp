@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "core/hash.hpp"
 #include "math/vector.hpp"
 #include "mdl/importer.hpp"
 #include <tiny_obj_loader.h>
@@ -11,6 +12,8 @@ namespace ionengine::asset
     class OBJImporter : public MDLImporter
     {
       public:
+        using MDLImporter::MDLImporter;
+
         auto loadFromFile(std::filesystem::path const& filePath,
                           std::string& errors) -> std::optional<ModelFile> override;
 
@@ -32,13 +35,25 @@ namespace ionengine::asset
             }
         };
 
+        static_assert(sizeof(Vertex) == 8 * sizeof(float), "Vertex is written to the blob as packed floats");
+
         struct VertexHasher
         {
             auto operator()(const Vertex& other) const -> std::size_t
             {
-                return std::hash<math::Vec3f>()(other.position) ^ std::hash<math::Vec3f>()(other.normal) ^
-                       std::hash<math::Vec2f>()(other.uv);
+                // Copied out whole since the members are separate subobjects
+                auto const floats = std::bit_cast<std::array<float, 8>>(other);
+                return core::hash_floats(floats);
             }
         };
+
+        // Welded vertices of a shape and the indices of its faces into them
+        struct ShapeData
+        {
+            std::vector<Vertex> vertices;
+            std::vector<uint32_t> indices;
+        };
+
+        static auto weldShape(tinyobj::attrib_t const& attrib, tinyobj::shape_t const& shape) -> ShapeData;
     };
 } // namespace ionengine::mdl
\ No newline at end of file
@@ -0,0 +1,825 @@
+// Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
+
+#include "optimizer.hpp"
+#include "precompiled.h"
+
+namespace ionengine::asset
+{
+    namespace
+    {
+        uint32_t constexpr InvalidIndex = std::numeric_limits<uint32_t>::max();
+
+        auto readIndices(uint8_t const* source, mdl::IndexFormat const format, uint32_t const count)
+            -> std::vector<uint32_t>
+        {
+            std::vector<uint32_t> indices(count);
+            if (format == mdl::IndexFormat::UINT16)
+            {
+                for (uint32_t const i : std::views::iota(0u, count))
+                {
+                    uint16_t index;
+                    std::memcpy(&index, source + i * sizeof(uint16_t), sizeof(uint16_t));
+                    indices[i] = index;
+                }
+            }
+            else
+            {
+                std::memcpy(indices.data(), source, count * sizeof(uint32_t));
+            }
+            return indices;
+        }
+
+        auto writeIndices(std::span<uint32_t const> const indices, mdl::IndexFormat const format,
+                          uint8_t* destination) -> void
+        {
+            if (format == mdl::IndexFormat::UINT16)
+            {
+                for (size_t const i : std::views::iota(0u, indices.size()))
+                {
+                    uint16_t const index = static_cast<uint16_t>(indices[i]);
+                    std::memcpy(destination + i * sizeof(uint16_t), &index, sizeof(uint16_t));
+                }
+            }
+            else
+            {
+                std::memcpy(destination, indices.data(), indices.size() * sizeof(uint32_t));
+            }
+        }
+
+        auto isInBlob(ModelFile const& modelFile, mdl::BufferData const& bufferData) -> bool
+        {
+            return bufferData.offset <= modelFile.blob.size() &&
+                   bufferData.size <= modelFile.blob.size() - bufferData.offset;
+        }
+
+        // Vertex buffer of a model with full precision positions
+        struct ModelVertices
+        {
+            uint8_t const* data;
+            size_t stride;
+            uint32_t count;
+            size_t positionOffset;
+
+            auto position(uint32_t const vertex) const -> math::Vec3f
+            {
+                math::Vec3f position;
+                std::memcpy(&position, data + vertex * stride + positionOffset, sizeof(math::Vec3f));
+                return position;
+            }
+        };
+
+        auto getModelVertices(ModelFile const& modelFile, std::string& errors) -> std::optional<ModelVertices>
+        {
+            mdl::ModelData const& modelData = modelFile.modelData;
+            if (modelData.buffer >= modelData.buffers.size() ||
+                !isInBlob(modelFile, modelData.buffers[modelData.buffer]) || modelData.vertexLayout.size == 0)
+            {
+                errors = "A model has no valid vertex buffer";
+                return std::nullopt;
+            }
+
+            std::optional<size_t> positionOffset;
+            size_t elementOffset = 0;
+            for (auto const& element : modelData.vertexLayout.elements)
+            {
+                if (element.semantic == "POSITION" && element.format == mdl::VertexFormat::RGB32_FLOAT)
+                {
+                    positionOffset = elementOffset;
+                }
+                elementOffset += mdl::sizeof_VertexFormat(element.format);
+            }
+            if (!positionOffset.has_value() || elementOffset > modelData.vertexLayout.size)
+            {
+                errors = "A model has no positions in its vertex layout";
+                return std::nullopt;
+            }
+
+            mdl::BufferData const& vertexBuffer = modelData.buffers[modelData.buffer];
+            return ModelVertices{.data = modelFile.blob.data() + vertexBuffer.offset,
+                                 .stride = modelData.vertexLayout.size,
+                                 .count = static_cast<uint32_t>(vertexBuffer.size / modelData.vertexLayout.size),
+                                 .positionOffset = positionOffset.value()};
+        }
+
+        auto isValidIndexBuffer(ModelFile const& modelFile, mdl::SurfaceData const& surfaceData) -> bool
+        {
+            mdl::ModelData const& modelData = modelFile.modelData;
+            return surfaceData.buffer < modelData.buffers.size() && surfaceData.buffer != modelData.buffer &&
+                   surfaceData.indexCount % 3 == 0 &&
+                   modelData.buffers[surfaceData.buffer].size ==
+                       surfaceData.indexCount *
+                           mdl::sizeof_IndexFormat(surfaceData.indexFormat.value_or(mdl::IndexFormat::UINT32)) &&
+                   isInBlob(modelFile, modelData.buffers[surfaceData.buffer]);
+        }
+
+        // Bounding sphere and normal cone of the triangles, the cone apex lies behind the planes of all triangles
+        auto makeMeshlet(std::span<uint32_t const> const indices, uint32_t const indexOffset,
+                         std::span<uint32_t const> const vertices,
+                         std::span<math::Vec3f const> const positions) -> mdl::MeshletData
+        {
+            math::Vec3f minimum = positions[vertices[0]];
+            math::Vec3f maximum = minimum;
+            for (uint32_t const vertex : vertices)
+            {
+                math::Vec3f const& position = positions[vertex];
+                minimum = math::Vec3f(std::min(minimum.x, position.x), std::min(minimum.y, position.y),
+                                      std::min(minimum.z, position.z));
+                maximum = math::Vec3f(std::max(maximum.x, position.x), std::max(maximum.y, position.y),
+                                      std::max(maximum.z, position.z));
+            }
+            math::Vec3f const center = (minimum + maximum) * 0.5f;
+            float radius = 0.0f;
+            for (uint32_t const vertex : vertices)
+            {
+                radius = std::max(radius, (positions[vertex] - center).length());
+            }
+
+            std::vector<math::Vec3f> normals;
+            normals.reserve(indices.size() / 3);
+            math::Vec3f axis;
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                math::Vec3f const& p0 = positions[indices[i]];
+                math::Vec3f normal = (positions[indices[i + 1]] - p0).cross(positions[indices[i + 2]] - p0);
+                float const length = normal.length();
+                normals.emplace_back(length > 0.0f ? normal / length : math::Vec3f());
+                axis = axis + normals.back();
+            }
+
+            mdl::MeshletData meshlet{.indexOffset = indexOffset,
+                                     .triangleCount = static_cast<uint32_t>(indices.size() / 3),
+                                     .center = {center.x, center.y, center.z},
+                                     .radius = radius,
+                                     .coneApex = {center.x, center.y, center.z},
+                                     .coneAxis = {0.0f, 0.0f, 0.0f},
+                                     .coneCutoff = 1.0f};
+
+            float const axisLength = axis.length();
+            if (axisLength == 0.0f)
+            {
+                return meshlet;
+            }
+            axis = axis / axisLength;
+            meshlet.coneAxis = {axis.x, axis.y, axis.z};
+
+            float minimumDot = 1.0f;
+            for (auto const& normal : normals)
+            {
+                minimumDot = std::min(minimumDot, axis.dot(normal));
+            }
+            // Cones wider than a hemisphere cannot cull anything
+            if (minimumDot <= 0.1f)
+            {
+                return meshlet;
+            }
+
+            float apexDistance = 0.0f;
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                math::Vec3f const& normal = normals[i / 3];
+                if (normal.length() > 0.0f)
+                {
+                    apexDistance =
+                        std::max(apexDistance, (center - positions[indices[i]]).dot(normal) / axis.dot(normal));
+                }
+            }
+            math::Vec3f const apex = center - axis * apexDistance;
+            meshlet.coneApex = {apex.x, apex.y, apex.z};
+            meshlet.coneCutoff = std::sqrt(1.0f - minimumDot * minimumDot);
+            return meshlet;
+        }
+
+        // FIFO cache where a vertex stays cached until cacheSize other vertices have been transformed after it
+        class VertexCache
+        {
+          public:
+            VertexCache(uint32_t const vertexCount, uint32_t const cacheSize)
+                : timestamps(vertexCount, 0), timestamp(cacheSize + 1), cacheSize(cacheSize)
+            {
+            }
+
+            auto isCached(uint32_t const vertex) const -> bool
+            {
+                return timestamp - timestamps[vertex] <= cacheSize;
+            }
+
+            auto age(uint32_t const vertex) const -> uint32_t
+            {
+                return timestamp - timestamps[vertex];
+            }
+
+            // Returns whether the vertex had to be transformed
+            auto access(uint32_t const vertex) -> bool
+            {
+                if (isCached(vertex))
+                {
+                    return false;
+                }
+                timestamps[vertex] = timestamp++;
+                return true;
+            }
+
+            auto flush() -> void
+            {
+                timestamp += cacheSize + 1;
+            }
+
+          private:
+            std::vector<uint32_t> timestamps;
+            uint32_t timestamp;
+            uint32_t cacheSize;
+        };
+
+        auto triangleMisses(VertexCache& cache, std::span<uint32_t const> const indices,
+                            size_t const triangle) -> uint32_t
+        {
+            return cache.access(indices[triangle * 3 + 0]) + cache.access(indices[triangle * 3 + 1]) +
+                   cache.access(indices[triangle * 3 + 2]);
+        }
+    } // namespace
+
+    auto analyzeVertexCache(std::span<uint32_t const> const indices, uint32_t const vertexCount,
+                            uint32_t const cacheSize) -> VertexCacheStatistics
+    {
+        VertexCacheStatistics statistics{
+            .triangleCount = static_cast<uint32_t>(indices.size() / 3), .vertexCount = 0, .transformedCount = 0};
+
+        std::vector<bool> isReferenced(vertexCount, false);
+        VertexCache cache(vertexCount, cacheSize);
+        for (uint32_t const index : indices)
+        {
+            statistics.transformedCount += cache.access(index);
+            if (!isReferenced[index])
+            {
+                isReferenced[index] = true;
+                ++statistics.vertexCount;
+            }
+        }
+        return statistics;
+    }
+
+    auto optimizeVertexCache(std::span<uint32_t> const indices, uint32_t const vertexCount,
+                             uint32_t const cacheSize) -> void
+    {
+        size_t const triangleCount = indices.size() / 3;
+
+        // Triangles of every vertex, stored one vertex after another
+        std::vector<uint32_t> offsets(vertexCount + 1, 0);
+        for (uint32_t const index : indices)
+        {
+            ++offsets[index + 1];
+        }
+        for (uint32_t const i : std::views::iota(0u, vertexCount))
+        {
+            offsets[i + 1] += offsets[i];
+        }
+
+        std::vector<uint32_t> adjacency(triangleCount * 3);
+        std::vector<uint32_t> liveCounts(vertexCount);
+        {
+            std::vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+            for (size_t const i : std::views::iota(0u, triangleCount * 3))
+            {
+                adjacency[cursors[indices[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+        for (uint32_t const i : std::views::iota(0u, vertexCount))
+        {
+            liveCounts[i] = offsets[i + 1] - offsets[i];
+        }
+
+        std::vector<uint32_t> result;
+        result.reserve(triangleCount * 3);
+        std::vector<bool> isEmitted(triangleCount, false);
+        std::vector<uint32_t> deadEnds;
+        std::vector<uint32_t> candidates;
+        VertexCache cache(vertexCount, cacheSize);
+        uint32_t cursor = 0;
+
+        uint32_t fanning = vertexCount > 0 ? 0 : InvalidIndex;
+        while (fanning != InvalidIndex)
+        {
+            // Emits every remaining triangle around the fanning vertex
+            candidates.clear();
+            for (uint32_t const triangle : std::span<uint32_t const>(adjacency.data() + offsets[fanning],
+                                                                     offsets[fanning + 1] - offsets[fanning]))
+            {
+                if (isEmitted[triangle])
+                {
+                    continue;
+                }
+
+                for (uint32_t const vertex : indices.subspan(triangle * 3, 3))
+                {
+                    result.emplace_back(vertex);
+                    deadEnds.emplace_back(vertex);
+                    candidates.emplace_back(vertex);
+                    --liveCounts[vertex];
+                    cache.access(vertex);
+                }
+                isEmitted[triangle] = true;
+            }
+
+            // The next fanning vertex is the oldest candidate that stays in the cache while its triangles are emitted
+            uint32_t next = InvalidIndex;
+            int64_t bestPriority = -1;
+            for (uint32_t const vertex : candidates)
+            {
+                if (liveCounts[vertex] == 0)
+                {
+                    continue;
+                }
+
+                int64_t priority = 0;
+                if (cache.age(vertex) + 2 * liveCounts[vertex] <= cacheSize)
+                {
+                    priority = cache.age(vertex);
+                }
+                if (priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    next = vertex;
+                }
+            }
+
+            // Otherwise a recently used vertex with triangles left, and then any vertex with triangles left
+            while (next == InvalidIndex && !deadEnds.empty())
+            {
+                uint32_t const vertex = deadEnds.back();
+                deadEnds.pop_back();
+                if (liveCounts[vertex] > 0)
+                {
+                    next = vertex;
+                }
+            }
+            while (next == InvalidIndex && cursor < vertexCount)
+            {
+                if (liveCounts[cursor] > 0)
+                {
+                    next = cursor;
+                }
+                ++cursor;
+            }
+            fanning = next;
+        }
+
+        std::memcpy(indices.data(), result.data(), result.size() * sizeof(uint32_t));
+    }
+
+    auto optimizeOverdraw(std::span<uint32_t> const indices, std::span<math::Vec3f const> const positions,
+                          uint32_t const cacheSize, float const threshold) -> void
+    {
+        size_t const triangleCount = indices.size() / 3;
+        if (triangleCount < 2)
+        {
+            return;
+        }
+
+        // Hard boundaries where the order restarts with three transformed vertices
+        std::vector<uint32_t> misses(triangleCount);
+        std::vector<size_t> hardClusters;
+        {
+            VertexCache cache(static_cast<uint32_t>(positions.size()), cacheSize);
+            for (size_t const i : std::views::iota(0u, triangleCount))
+            {
+                misses[i] = triangleMisses(cache, indices, i);
+                if (i == 0 || misses[i] == 3)
+                {
+                    hardClusters.emplace_back(i);
+                }
+            }
+            hardClusters.emplace_back(triangleCount);
+        }
+
+        // Soft boundaries split a hard cluster as soon as the part before them is within the threshold of its ACMR
+        std::vector<size_t> clusters;
+        {
+            VertexCache cache(static_cast<uint32_t>(positions.size()), cacheSize);
+            for (size_t const i : std::views::iota(0u, hardClusters.size() - 1))
+            {
+                size_t const begin = hardClusters[i];
+                size_t const end = hardClusters[i + 1];
+                uint32_t clusterMisses = 0;
+                for (size_t const j : std::views::iota(begin, end))
+                {
+                    clusterMisses += misses[j];
+                }
+                float const clusterACMR = static_cast<float>(clusterMisses) / (end - begin);
+
+                cache.flush();
+                clusters.emplace_back(begin);
+                size_t clusterBegin = begin;
+                uint32_t partMisses = 0;
+                for (size_t const j : std::views::iota(begin, end))
+                {
+                    partMisses += triangleMisses(cache, indices, j);
+                    if (j + 1 < end && partMisses <= threshold * clusterACMR * (j + 1 - clusterBegin))
+                    {
+                        cache.flush();
+                        clusters.emplace_back(j + 1);
+                        clusterBegin = j + 1;
+                        partMisses = 0;
+                    }
+                }
+            }
+            clusters.emplace_back(triangleCount);
+        }
+
+        size_t const clusterCount = clusters.size() - 1;
+        if (clusterCount < 2)
+        {
+            return;
+        }
+
+        math::Vec3f meshCenter;
+        for (uint32_t const index : indices)
+        {
+            meshCenter = meshCenter + positions[index];
+        }
+        meshCenter = meshCenter / static_cast<float>(indices.size());
+
+        // Clusters facing away from the center of the mesh are more likely to occlude the others
+        std::vector<float> sortKeys(clusterCount);
+        for (size_t const i : std::views::iota(0u, clusterCount))
+        {
+            math::Vec3f center;
+            math::Vec3f normal;
+            float area = 0.0f;
+            for (size_t const j : std::views::iota(clusters[i], clusters[i + 1]))
+            {
+                math::Vec3f const& p0 = positions[indices[j * 3 + 0]];
+                math::Vec3f const& p1 = positions[indices[j * 3 + 1]];
+                math::Vec3f const& p2 = positions[indices[j * 3 + 2]];
+
+                math::Vec3f triangleNormal = (p1 - p0).cross(p2 - p0);
+                float const triangleArea = triangleNormal.length();
+
+                center = center + (p0 + p1 + p2) * (triangleArea / 3.0f);
+                normal = normal + triangleNormal;
+                area += triangleArea;
+            }
+
+            float const normalLength = normal.length();
+            sortKeys[i] = area > 0.0f && normalLength > 0.0f
+                              ? (center / area - meshCenter).dot(normal / normalLength)
+                              : -std::numeric_limits<float>::max();
+        }
+
+        std::vector<uint32_t> order(clusterCount);
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(),
+                         [&](uint32_t const lhs, uint32_t const rhs) { return sortKeys[lhs] > sortKeys[rhs]; });
+
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+        for (uint32_t const cluster : order)
+        {
+            result.insert(result.end(), indices.begin() + clusters[cluster] * 3,
+                          indices.begin() + clusters[cluster + 1] * 3);
+        }
+        std::memcpy(indices.data(), result.data(), result.size() * sizeof(uint32_t));
+    }
+
+    auto optimizeModelFile(ModelFile& modelFile, MDLOptimizeOptions const& options,
+                           std::string& errors) -> std::optional<MDLOptimizeReport>
+    {
+        mdl::ModelData& modelData = modelFile.modelData;
+
+        auto const modelVertices = getModelVertices(modelFile, errors);
+        if (!modelVertices.has_value())
+        {
+            return std::nullopt;
+        }
+
+        size_t const stride = modelVertices->stride;
+        uint32_t const vertexCount = modelVertices->count;
+        uint8_t const* vertices = modelVertices->data;
+
+        // Surfaces index the vertex range from their vertex offset up to the next offset of another surface
+        std::set<uint32_t> rangeStarts;
+        for (auto const& surfaceData : modelData.surfaces)
+        {
+            if (surfaceData.vertexOffset.value_or(0) > vertexCount)
+            {
+                errors = "A model surface references a vertex out of range";
+                return std::nullopt;
+            }
+            rangeStarts.emplace(surfaceData.vertexOffset.value_or(0));
+        }
+        auto const rangeEnd = [&](uint32_t const rangeStart) -> uint32_t {
+            auto const it = rangeStarts.upper_bound(rangeStart);
+            return it != rangeStarts.end() ? *it : vertexCount;
+        };
+
+        MDLOptimizeReport report;
+
+        // Index buffers shared by several surfaces are optimized once, in the order the surfaces use them
+        std::vector<std::vector<uint32_t>> bufferIndices(modelData.buffers.size());
+        std::vector<std::optional<SurfaceOptimizeReport>> bufferReports(modelData.buffers.size());
+        std::vector<mdl::SurfaceData const*> bufferSurfaces(modelData.buffers.size(), nullptr);
+        std::vector<uint32_t> optimizedBuffers;
+
+        std::vector<uint32_t> localIndices(vertexCount, InvalidIndex);
+        std::vector<uint32_t> globalIndices;
+        std::vector<math::Vec3f> positions;
+
+        for (auto const& surfaceData : modelData.surfaces)
+        {
+            if (!isValidIndexBuffer(modelFile, surfaceData))
+            {
+                errors = "A model surface has no valid index buffer";
+                return std::nullopt;
+            }
+            // Meshlets refer to the triangle order, so they are built after the optimization
+            if (surfaceData.meshletBuffer.has_value())
+            {
+                errors = "A model has meshlets already";
+                return std::nullopt;
+            }
+
+            uint32_t const vertexOffset = surfaceData.vertexOffset.value_or(0);
+            mdl::IndexFormat const indexFormat = surfaceData.indexFormat.value_or(mdl::IndexFormat::UINT32);
+
+            if (mdl::SurfaceData const* bufferSurface = bufferSurfaces[surfaceData.buffer])
+            {
+                if (bufferSurface->vertexOffset.value_or(0) != vertexOffset ||
+                    bufferSurface->indexFormat.value_or(mdl::IndexFormat::UINT32) != indexFormat)
+                {
+                    errors = "A model index buffer is shared by surfaces with different vertex offsets";
+                    return std::nullopt;
+                }
+            }
+            else
+            {
+                bufferSurfaces[surfaceData.buffer] = &surfaceData;
+
+                std::vector<uint32_t>& indices = bufferIndices[surfaceData.buffer];
+                indices = readIndices(modelFile.blob.data() + modelData.buffers[surfaceData.buffer].offset,
+                                      indexFormat, surfaceData.indexCount);
+
+                // Vertices are numbered locally, so the work is proportional to the size of the surface
+                uint32_t const rangeSize = rangeEnd(vertexOffset) - vertexOffset;
+                globalIndices.clear();
+                for (uint32_t& index : indices)
+                {
+                    if (index >= rangeSize)
+                    {
+                        errors = "A model surface references a vertex out of range";
+                        return std::nullopt;
+                    }
+                    uint32_t const vertex = vertexOffset + index;
+                    if (localIndices[vertex] == InvalidIndex)
+                    {
+                        localIndices[vertex] = static_cast<uint32_t>(globalIndices.size());
+                        globalIndices.emplace_back(vertex);
+                    }
+                    index = localIndices[vertex];
+                }
+
+                positions.resize(globalIndices.size());
+                for (size_t const i : std::views::iota(0u, globalIndices.size()))
+                {
+                    positions[i] = modelVertices->position(globalIndices[i]);
+                    localIndices[globalIndices[i]] = InvalidIndex;
+                }
+
+                uint32_t const localVertexCount = static_cast<uint32_t>(globalIndices.size());
+                SurfaceOptimizeReport surfaceReport{
+                    .before = analyzeVertexCache(indices, localVertexCount, options.cacheSize), .after = {}};
+
+                // Orders that already suit the cache are kept, Tipsify does not always improve on them
+                std::vector<uint32_t> cacheOrder = indices;
+                optimizeVertexCache(cacheOrder, localVertexCount, options.cacheSize);
+                if (analyzeVertexCache(cacheOrder, localVertexCount, options.cacheSize).transformedCount <
+                    surfaceReport.before.transformedCount)
+                {
+                    indices = std::move(cacheOrder);
+                }
+                optimizeOverdraw(indices, positions, options.cacheSize, options.overdrawThreshold);
+                surfaceReport.after = analyzeVertexCache(indices, localVertexCount, options.cacheSize);
+
+                for (uint32_t& index : indices)
+                {
+                    index = globalIndices[index];
+                }
+
+                bufferReports[surfaceData.buffer] = surfaceReport;
+                optimizedBuffers.emplace_back(surfaceData.buffer);
+            }
+
+            report.surfaces.emplace_back(bufferReports[surfaceData.buffer].value());
+        }
+
+        // Vertices of a range are stored in the order the triangles first use them. The ones no surface uses follow
+        // in their previous order, so the ranges keep their offsets and sizes.
+        std::vector<uint32_t> remap(vertexCount, InvalidIndex);
+        std::map<uint32_t, uint32_t> rangeSizes;
+        for (uint32_t const buffer : optimizedBuffers)
+        {
+            uint32_t const vertexOffset = bufferSurfaces[buffer]->vertexOffset.value_or(0);
+            uint32_t& rangeSize = rangeSizes[vertexOffset];
+            for (uint32_t& index : bufferIndices[buffer])
+            {
+                if (remap[index] == InvalidIndex)
+                {
+                    remap[index] = vertexOffset + rangeSize++;
+                }
+                index = remap[index] - vertexOffset;
+            }
+        }
+        for (uint32_t const rangeStart : rangeStarts)
+        {
+            uint32_t& rangeSize = rangeSizes[rangeStart];
+            for (uint32_t const vertex : std::views::iota(rangeStart, rangeEnd(rangeStart)))
+            {
+                if (remap[vertex] == InvalidIndex)
+                {
+                    remap[vertex] = rangeStart + rangeSize++;
+                }
+            }
+        }
+
+        uint64_t blobSize = 0;
+        std::vector<mdl::BufferData> buffers(modelData.buffers.size());
+        for (size_t const i : std::views::iota(0u, buffers.size()))
+        {
+            size_t const size = i == modelData.buffer ? vertexCount * stride : modelData.buffers[i].size;
+            buffers[i] = mdl::BufferData{.offset = blobSize, .size = size};
+            blobSize += buffers[i].size;
+        }
+
+        std::vector<uint8_t> blob(blobSize);
+        for (size_t const i : std::views::iota(0u, buffers.size()))
+        {
+            uint8_t* destination = blob.data() + buffers[i].offset;
+            if (i == modelData.buffer)
+            {
+                for (uint32_t const vertex : std::views::iota(0u, vertexCount))
+                {
+                    uint32_t const remapped = remap[vertex] != InvalidIndex ? remap[vertex] : vertex;
+                    std::memcpy(destination + remapped * stride, vertices + vertex * stride, stride);
+                }
+            }
+            else if (bufferReports[i].has_value())
+            {
+                writeIndices(bufferIndices[i], bufferSurfaces[i]->indexFormat.value_or(mdl::IndexFormat::UINT32),
+                             destination);
+            }
+            else if (isInBlob(modelFile, modelData.buffers[i]))
+            {
+                std::memcpy(destination, modelFile.blob.data() + modelData.buffers[i].offset, buffers[i].size);
+            }
+        }
+
+        modelData.buffers = std::move(buffers);
+        modelFile.blob = std::move(blob);
+        return report;
+    }
+
+    auto buildMeshlets(std::span<uint32_t const> const indices, std::span<math::Vec3f const> const positions,
+                       uint32_t const maxVertices, uint32_t const maxTriangles) -> std::vector<mdl::MeshletData>
+    {
+        std::vector<mdl::MeshletData> meshlets;
+        std::vector<uint32_t> vertexMeshlets(positions.size(), InvalidIndex);
+        std::vector<uint32_t> vertices;
+        uint32_t indexOffset = 0;
+
+        for (uint32_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            uint32_t const a = indices[i];
+            uint32_t const b = indices[i + 1];
+            uint32_t const c = indices[i + 2];
+            auto const isNew = [&](uint32_t const vertex) {
+                return vertexMeshlets[vertex] != static_cast<uint32_t>(meshlets.size());
+            };
+
+            uint32_t const newCount = (isNew(a) ? 1 : 0) + (isNew(b) && b != a ? 1 : 0) +
+                                      (isNew(c) && c != a && c != b ? 1 : 0);
+            if ((i - indexOffset) / 3 == maxTriangles || vertices.size() + newCount > maxVertices)
+            {
+                meshlets.emplace_back(
+                    makeMeshlet(indices.subspan(indexOffset, i - indexOffset), indexOffset, vertices, positions));
+                vertices.clear();
+                indexOffset = i;
+            }
+
+            for (uint32_t const vertex : {a, b, c})
+            {
+                if (isNew(vertex))
+                {
+                    vertexMeshlets[vertex] = static_cast<uint32_t>(meshlets.size());
+                    vertices.emplace_back(vertex);
+                }
+            }
+        }
+
+        if (!vertices.empty())
+        {
+            size_t const indexCount = indices.size() / 3 * 3;
+            meshlets.emplace_back(
+                makeMeshlet(indices.subspan(indexOffset, indexCount - indexOffset), indexOffset, vertices, positions));
+        }
+        return meshlets;
+    }
+
+    auto buildModelMeshlets(ModelFile& modelFile, MDLMeshletOptions const& options, std::string& errors) -> bool
+    {
+        mdl::ModelData& modelData = modelFile.modelData;
+
+        if (options.maxVertices < 3 || options.maxTriangles == 0)
+        {
+            errors = "A meshlet has to hold at least one triangle";
+            return false;
+        }
+
+        auto const modelVertices = getModelVertices(modelFile, errors);
+        if (!modelVertices.has_value())
+        {
+            return false;
+        }
+
+        // Surfaces that draw the same index buffer from the same vertex offset share the meshlets
+        std::map<std::pair<uint32_t, uint32_t>, uint32_t> meshletBuffers;
+        std::vector<std::vector<mdl::MeshletData>> bufferMeshlets;
+        std::vector<uint32_t> surfaceMeshletBuffers;
+
+        std::vector<uint32_t> localIndices(modelVertices->count, InvalidIndex);
+        std::vector<uint32_t> globalIndices;
+        std::vector<math::Vec3f> positions;
+
+        for (auto const& surfaceData : modelData.surfaces)
+        {
+            uint32_t const vertexOffset = surfaceData.vertexOffset.value_or(0);
+            if (!isValidIndexBuffer(modelFile, surfaceData) || vertexOffset > modelVertices->count)
+            {
+                errors = "A model surface has no valid index buffer";
+                return false;
+            }
+            if (surfaceData.meshletBuffer.has_value())
+            {
+                errors = "A model has meshlets already";
+                return false;
+            }
+
+            auto const [meshletBufferIt, isInserted] =
+                meshletBuffers.try_emplace(std::make_pair(surfaceData.buffer, vertexOffset),
+                                           static_cast<uint32_t>(bufferMeshlets.size()));
+            surfaceMeshletBuffers.emplace_back(meshletBufferIt->second);
+            if (!isInserted)
+            {
+                continue;
+            }
+
+            std::vector<uint32_t> indices =
+                readIndices(modelFile.blob.data() + modelData.buffers[surfaceData.buffer].offset,
+                            surfaceData.indexFormat.value_or(mdl::IndexFormat::UINT32), surfaceData.indexCount);
+
+            // Vertices are numbered locally, so the work is proportional to the size of the surface
+            uint32_t const rangeSize = modelVertices->count - vertexOffset;
+            globalIndices.clear();
+            for (uint32_t& index : indices)
+            {
+                if (index >= rangeSize)
+                {
+                    errors = "A model surface references a vertex out of range";
+                    return false;
+                }
+                uint32_t const vertex = vertexOffset + index;
+                if (localIndices[vertex] == InvalidIndex)
+                {
+                    localIndices[vertex] = static_cast<uint32_t>(globalIndices.size());
+                    globalIndices.emplace_back(vertex);
+                }
+                index = localIndices[vertex];
+            }
+
+            positions.resize(globalIndices.size());
+            for (size_t const i : std::views::iota(0u, globalIndices.size()))
+            {
+                positions[i] = modelVertices->position(globalIndices[i]);
+                localIndices[globalIndices[i]] = InvalidIndex;
+            }
+
+            bufferMeshlets.emplace_back(buildMeshlets(indices, positions, options.maxVertices, options.maxTriangles));
+        }
+
+        // Meshlet buffers follow the existing buffers at an aligned offset
+        std::vector<uint8_t> blob(modelFile.blob.begin(), modelFile.blob.end());
+        uint32_t const firstMeshletBuffer = static_cast<uint32_t>(modelData.buffers.size());
+        for (auto const& meshlets : bufferMeshlets)
+        {
+            uint64_t const offset = (blob.size() + alignof(mdl::MeshletData) - 1) & ~(alignof(mdl::MeshletData) - 1);
+            size_t const size = meshlets.size() * sizeof(mdl::MeshletData);
+            blob.resize(offset + size);
+            std::memcpy(blob.data() + offset, meshlets.data(), size);
+            modelData.buffers.emplace_back(mdl::BufferData{.offset = offset, .size = size});
+        }
+
+        for (size_t const i : std::views::iota(0u, modelData.surfaces.size()))
+        {
+            modelData.surfaces[i].meshletBuffer = firstMeshletBuffer + surfaceMeshletBuffers[i];
+        }
+        modelFile.blob = std::move(blob);
+        return true;
+    }
+} // namespace ionengine::asset
@@ -0,0 +1,82 @@
+// Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
+
+#pragma once
+
+#include "math/vector.hpp"
+#include "mdl.hpp"
+
+namespace ionengine::asset
+{
+    // Post-transform cache behaviour of an index buffer, simulated with a FIFO cache
+    struct VertexCacheStatistics
+    {
+        uint32_t triangleCount;
+        uint32_t vertexCount;
+        uint32_t transformedCount;
+
+        // Average cache miss ratio, vertices transformed per triangle. Regular grids approach 0.5.
+        auto acmr() const -> float
+        {
+            return triangleCount > 0 ? static_cast<float>(transformedCount) / triangleCount : 0.0f;
+        }
+
+        // Average transformed vertex ratio, vertices transformed per vertex referenced. 1 is optimal.
+        auto atvr() const -> float
+        {
+            return vertexCount > 0 ? static_cast<float>(transformedCount) / vertexCount : 0.0f;
+        }
+    };
+
+    struct MDLOptimizeOptions
+    {
+        uint32_t cacheSize = 16;
+        // Triangle clusters sorted for overdraw may raise the ACMR of the cache optimized order by this factor
+        float overdrawThreshold = 1.05f;
+    };
+
+    struct SurfaceOptimizeReport
+    {
+        VertexCacheStatistics before;
+        VertexCacheStatistics after;
+    };
+
+    struct MDLOptimizeReport
+    {
+        std::vector<SurfaceOptimizeReport> surfaces;
+    };
+
+    struct MDLMeshletOptions
+    {
+        uint32_t maxVertices = mdl::MeshletMaxVertices;
+        uint32_t maxTriangles = mdl::MeshletMaxTriangles;
+    };
+
+    auto analyzeVertexCache(std::span<uint32_t const> const indices, uint32_t const vertexCount,
+                            uint32_t const cacheSize) -> VertexCacheStatistics;
+
+    // Reorders triangles for the post-transform cache with Tipsify, "Fast Triangle Reordering for Vertex Locality
+    // and Reduced Overdraw" [Sander et al. 2007]
+    auto optimizeVertexCache(std::span<uint32_t> const indices, uint32_t const vertexCount,
+                             uint32_t const cacheSize) -> void;
+
+    // Splits cache optimized triangles into clusters at cache restarts and sorts the clusters so that the ones
+    // facing outwards from the center of the mesh are drawn first
+    auto optimizeOverdraw(std::span<uint32_t> const indices, std::span<math::Vec3f const> const positions,
+                          uint32_t const cacheSize, float const threshold) -> void;
+
+    // Optional stage after an import. Optimizes every index buffer of the model for the vertex cache and overdraw,
+    // then orders the vertices of every surface by first use so vertex fetches follow the triangles. Vertex offsets
+    // and the size of the vertex buffer do not change, vertices that no surface references are moved behind the
+    // used ones.
+    auto optimizeModelFile(ModelFile& modelFile, MDLOptimizeOptions const& options,
+                           std::string& errors) -> std::optional<MDLOptimizeReport>;
+
+    // Splits the triangles into meshlets in the order they are drawn, a meshlet ends where the next triangle would
+    // exceed one of the limits. Orders optimized for the vertex cache give meshlets close to the vertex limit.
+    auto buildMeshlets(std::span<uint32_t const> const indices, std::span<math::Vec3f const> const positions,
+                       uint32_t const maxVertices, uint32_t const maxTriangles) -> std::vector<mdl::MeshletData>;
+
+    // Optional stage after an import and optimizeModelFile. Appends a buffer of meshlets for every index buffer of
+    // the model and references it from the surfaces, index and vertex buffers do not change.
+    auto buildModelMeshlets(ModelFile& modelFile, MDLMeshletOptions const& options, std::string& errors) -> bool;
+} // namespace ionengine::asset
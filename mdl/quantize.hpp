@@ -0,0 +1,139 @@
+// Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
+
+#pragma once
+
+#include "math/vector.hpp"
+#include "mdl.hpp"
+
+namespace ionengine::asset
+{
+    namespace mdl
+    {
+        // Rounds to the nearest even half, values above the half range become infinity
+        inline auto floatToHalf(float const value) -> uint16_t
+        {
+            uint32_t const bits = std::bit_cast<uint32_t>(value);
+            uint16_t const sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+            uint32_t const absolute = bits & 0x7FFFFFFF;
+
+            if (absolute >= 0x7F800000)
+            {
+                return sign | 0x7C00 | (absolute > 0x7F800000 ? 0x0200 : 0);
+            }
+            // Halfway between the largest half 65504 and 65536 ties to infinity
+            if (absolute >= 0x477FF000)
+            {
+                return sign | 0x7C00;
+            }
+            // Subnormal halves are multiples of 2^-24
+            if (absolute < 0x38800000)
+            {
+                float const scaled = std::bit_cast<float>(absolute) * 16777216.0f;
+                return sign | static_cast<uint16_t>(std::nearbyint(scaled));
+            }
+
+            uint32_t const rounded = absolute + 0x0FFF + ((absolute >> 13) & 1);
+            return sign | static_cast<uint16_t>((rounded - 0x38000000) >> 13);
+        }
+
+        inline auto halfToFloat(uint16_t const value) -> float
+        {
+            uint32_t const sign = static_cast<uint32_t>(value & 0x8000) << 16;
+            uint32_t const exponent = (value >> 10) & 0x1F;
+            uint32_t const mantissa = value & 0x03FF;
+
+            if (exponent == 0)
+            {
+                float const magnitude = static_cast<float>(mantissa) / 16777216.0f;
+                return std::bit_cast<float>(sign | std::bit_cast<uint32_t>(magnitude));
+            }
+            if (exponent == 0x1F)
+            {
+                return std::bit_cast<float>(sign | 0x7F800000 | (mantissa << 13));
+            }
+            return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+        }
+
+        inline auto quantizeSnorm16(float const value) -> int16_t
+        {
+            return static_cast<int16_t>(std::round(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f));
+        }
+
+        inline auto quantizeUnorm16(float const value) -> uint16_t
+        {
+            return static_cast<uint16_t>(std::round(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f));
+        }
+
+        // Projects a unit vector onto the octahedron and unfolds the lower half, both coordinates are in [-1, 1]
+        inline auto encodeOctahedral(math::Vec3f const& normal) -> math::Vec2f
+        {
+            float const length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+            if (length == 0.0f)
+            {
+                return math::Vec2f(0.0f, 0.0f);
+            }
+
+            float const u = normal.x / length;
+            float const v = normal.y / length;
+            if (normal.z >= 0.0f)
+            {
+                return math::Vec2f(u, v);
+            }
+            return math::Vec2f((1.0f - std::abs(v)) * (u >= 0.0f ? 1.0f : -1.0f),
+                               (1.0f - std::abs(u)) * (v >= 0.0f ? 1.0f : -1.0f));
+        }
+
+        inline auto decodeOctahedral(math::Vec2f const& encoded) -> math::Vec3f
+        {
+            math::Vec3f normal(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+            float const fold = std::max(-normal.z, 0.0f);
+            normal.x += normal.x >= 0.0f ? -fold : fold;
+            normal.y += normal.y >= 0.0f ? -fold : fold;
+            return normal.normalize();
+        }
+
+        // Compressed vertex written by the importers with MDLImportOptions::isQuantized. Positions stay full precision
+        // since surfaces are drawn without a dequantization transform.
+        struct PackedVertex
+        {
+            std::array<float, 3> position;
+            std::array<int16_t, 2> normal;
+            std::array<uint16_t, 2> uv;
+        };
+
+        static_assert(sizeof(PackedVertex) == 20, "PackedVertex is written to the blob as is");
+
+        // Texture coordinates are stored as RG16_UNORM when all of them are in [0, 1], tiled ones need RG16_FLOAT
+        inline auto packVertex(math::Vec3f const& position, math::Vec3f const& normal, math::Vec2f const& uv,
+                               VertexFormat const uvFormat) -> PackedVertex
+        {
+            math::Vec2f const octahedral = encodeOctahedral(normal);
+            std::array<uint16_t, 2> const packedUV = uvFormat == VertexFormat::RG16_UNORM
+                                                         ? std::array{quantizeUnorm16(uv.x), quantizeUnorm16(uv.y)}
+                                                         : std::array{floatToHalf(uv.x), floatToHalf(uv.y)};
+
+            return PackedVertex{.position = {position.x, position.y, position.z},
+                                .normal = {quantizeSnorm16(octahedral.x), quantizeSnorm16(octahedral.y)},
+                                .uv = packedUV};
+        }
+
+        // Layout of uncompressed vertices, which is what the shaders read
+        inline auto floatVertexLayout() -> VertexLayoutData
+        {
+            return VertexLayoutData{
+                .elements = {VertexLayoutElementData{.format = VertexFormat::RGB32_FLOAT, .semantic = "POSITION"},
+                             VertexLayoutElementData{.format = VertexFormat::RGB32_FLOAT, .semantic = "NORMAL"},
+                             VertexLayoutElementData{.format = VertexFormat::RG32_FLOAT, .semantic = "TEXCOORD0"}},
+                .size = 8 * sizeof(float)};
+        }
+
+        inline auto packedVertexLayout(VertexFormat const uvFormat) -> VertexLayoutData
+        {
+            return VertexLayoutData{
+                .elements = {VertexLayoutElementData{.format = VertexFormat::RGB32_FLOAT, .semantic = "POSITION"},
+                             VertexLayoutElementData{.format = VertexFormat::RG16_SNORM, .semantic = "NORMAL"},
+                             VertexLayoutElementData{.format = uvFormat, .semantic = "TEXCOORD0"}},
+                .size = sizeof(PackedVertex)};
+        }
+    } // namespace mdl
+} // namespace ionengine::asset
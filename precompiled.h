@@ -4,11 +4,17 @@
 
 #include <array>
 #include <cassert>
+#include <charconv>
 #include <exception>
 #include <filesystem>
 #include <format>
 #include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
 #include <fstream>
+#include <future>
 #include <functional>
 #include <iostream>
 #include <limits>
@@ -27,6 +33,7 @@
 #include <spanstream>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <tuple>
 #include <unordered_set>
 #include <variant>
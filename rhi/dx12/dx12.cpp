@@ -332,6 +332,14 @@ namespace ionengine::rhi
                 return DXGI_FORMAT_R32_SINT;
             case VertexFormat::R32_UINT:
                 return DXGI_FORMAT_R32_UINT;
+            case VertexFormat::RG16_UNORM:
+                return DXGI_FORMAT_R16G16_UNORM;
+            case VertexFormat::RG16_SNORM:
+                return DXGI_FORMAT_R16G16_SNORM;
+            case VertexFormat::RG16_FLOAT:
+                return DXGI_FORMAT_R16G16_FLOAT;
+            case VertexFormat::RGBA8_SNORM:
+                return DXGI_FORMAT_R8G8B8A8_SNORM;
             default:
                 return DXGI_FORMAT_UNKNOWN;
         }
@@ -1119,6 +1127,9 @@ namespace ionengine::rhi
         ::WaitForSingleObjectEx(fenceEvent, INFINITE, FALSE);
     }
 
+    // Queries are created on every execute(), their storage is recycled instead of going through the heap
+    static core::pool_allocator queryAllocator;
+
     DX12GraphicsContext::DX12GraphicsContext(ID3D12Device4* device, PipelineCache* pipelineCache,
                                              DescriptorAllocator* descriptorAllocator, ID3D12CommandQueue* queue,
                                              ID3D12Fence* fence, HANDLE fenceEvent, uint64_t& fenceValue)
@@ -1348,7 +1359,7 @@ namespace ionengine::rhi
         (*fenceValue)++;
         throwIfFailed(queue->Signal(fence, *fenceValue));
 
-        auto query = core::make_ref<DX12Query>();
+        auto query = core::make_ref<DX12Query>(std::allocator_arg, queryAllocator);
         auto futureImpl = std::make_unique<DX12FutureImpl>(queue, fence, fenceEvent, *fenceValue);
         return Future<Query>(query, std::move(futureImpl));
     }
@@ -1609,7 +1620,7 @@ namespace ionengine::rhi
         (*fenceValue)++;
         throwIfFailed(queue->Signal(fence, *fenceValue));
 
-        auto query = core::make_ref<DX12Query>();
+        auto query = core::make_ref<DX12Query>(std::allocator_arg, queryAllocator);
         auto futureImpl = std::make_unique<DX12FutureImpl>(queue, fence, fenceEvent, *fenceValue);
         return Future<Query>(query, std::move(futureImpl));
     }
@@ -39,6 +39,14 @@ namespace ionengine::rhi
                 return sizeof(int32_t);
             case VertexFormat::R32_UINT:
                 return sizeof(uint32_t);
+            case VertexFormat::RG16_UNORM:
+                return sizeof(uint16_t) * 2;
+            case VertexFormat::RG16_SNORM:
+                return sizeof(int16_t) * 2;
+            case VertexFormat::RG16_FLOAT:
+                return sizeof(uint16_t) * 2;
+            case VertexFormat::RGBA8_SNORM:
+                return sizeof(int8_t) * 4;
             default:
                 return 0;
         }
@@ -361,7 +361,11 @@ namespace ionengine::rhi
         RGB32_FLOAT,
         RGBA32_UINT,
         RGBA32_SINT,
-        RGBA32_FLOAT
+        RGBA32_FLOAT,
+        RG16_UNORM,
+        RG16_SNORM,
+        RG16_FLOAT,
+        RGBA8_SNORM
     };
 
     auto sizeof_VertexFormat(VertexFormat const format) -> size_t;
@@ -190,6 +190,14 @@ namespace ionengine::rhi
                 return VK_FORMAT_R32_SINT;
             case VertexFormat::R32_UINT:
                 return VK_FORMAT_R32_UINT;
+            case VertexFormat::RG16_UNORM:
+                return VK_FORMAT_R16G16_UNORM;
+            case VertexFormat::RG16_SNORM:
+                return VK_FORMAT_R16G16_SNORM;
+            case VertexFormat::RG16_FLOAT:
+                return VK_FORMAT_R16G16_SFLOAT;
+            case VertexFormat::RGBA8_SNORM:
+                return VK_FORMAT_R8G8B8A8_SNORM;
             default:
                 return VK_FORMAT_UNDEFINED;
         }
@@ -848,6 +856,9 @@ namespace ionengine::rhi
         throwIfFailed(::vkWaitSemaphores(device, &semaphoreWaitInfo, std::numeric_limits<uint64_t>::max()));
     }
 
+    // Queries are created on every execute(), their storage is recycled instead of going through the heap
+    static core::pool_allocator queryAllocator;
+
     VKGraphicsContext::VKGraphicsContext(VkDevice device, VkQueue queue, uint32_t queueFamilyIndex,
                                          VkSemaphore semaphore, uint64_t& fenceValue)
         : device(device), queue(queue), queueFamilyIndex(queueFamilyIndex), semaphore(semaphore),
@@ -895,7 +906,7 @@ namespace ionengine::rhi
                                 .pSignalSemaphores = &semaphore};
         throwIfFailed(::vkQueueSubmit(queue, 1, &submitInfo, nullptr));
 
-        auto query = core::make_ref<VKQuery>();
+        auto query = core::make_ref<VKQuery>(std::allocator_arg, queryAllocator);
         auto futureImpl = std::make_unique<VKFutureImpl>(device, queue, semaphore, *fenceValue);
         return Future<Query>(query, std::move(futureImpl));
     }
@@ -259,6 +259,6 @@ namespace ionengine::shadersys
         return asset::ShaderFile{.magic = asset::fx::Magic,
                           .apiType = apiType,
                           .shaderData = std::move(shaderData),
-                          .blob = {std::istreambuf_iterator<uint8_t>(streambuf.rdbuf()), {}}};
+                          .blob = std::vector<uint8_t>(std::istreambuf_iterator<uint8_t>(streambuf.rdbuf()), {})};
     }
 } // namespace ionengine::shadersys
\ No newline at end of file
@@ -8,7 +8,11 @@ namespace ionengine::asset
 {
     namespace fx
     {
-        std::array<uint8_t, 4> constexpr Magic{'F', 'X', '1', '0'};
+        std::array<uint8_t, 4> constexpr Magic{'F', 'X', '1', '2'};
+        // Files written before strings in the binary sections were length-prefixed
+        std::array<uint8_t, 4> constexpr MagicV10{'F', 'X', '1', '0'};
+        // Files written before blobs carried a checksum
+        std::array<uint8_t, 4> constexpr MagicV11{'F', 'X', '1', '1'};
 
         enum class APIType : uint32_t
         {
@@ -231,12 +235,15 @@ namespace ionengine::asset
         std::array<uint8_t, fx::Magic.size()> magic;
         fx::APIType apiType;
         fx::ShaderData shaderData;
-        std::vector<uint8_t> blob;
+        core::blob blob;
 
         template <typename Archive>
         auto operator()(Archive& archive)
         {
             archive.property(magic);
+            archive.revision(magic == fx::MagicV10   ? core::archive_revision::v10
+                             : magic == fx::MagicV11 ? core::archive_revision::v11
+                                                     : core::archive_revision::latest);
             archive.property(apiType);
             archive.template with<core::serialize_ojson, core::serialize_ijson>(shaderData);
             archive.property(blob);
@@ -0,0 +1,167 @@
+// Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
+
+#include "core/crc32.hpp"
+#include "core/ref_ptr.hpp"
+#include "precompiled.h"
+#include <benchmark/benchmark.h>
+
+using namespace ionengine;
+
+auto makeBytes(size_t const size) -> std::vector<uint8_t>
+{
+    std::mt19937 random(3);
+    std::vector<uint8_t> bytes(size);
+    for (auto& byte : bytes)
+    {
+        byte = static_cast<uint8_t>(random());
+    }
+    return bytes;
+}
+
+// Byte at a time, the constexpr path
+static void BM_CRC32_Bytewise(benchmark::State& state)
+{
+    auto const bytes = makeBytes(state.range(0));
+    std::string_view const source(reinterpret_cast<char const*>(bytes.data()), bytes.size());
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(core::crc32(source));
+    }
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+
+static void BM_CRC32_Slicing(benchmark::State& state)
+{
+    auto const bytes = makeBytes(state.range(0));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(~core::internal::crc32_slicing(bytes.data(), bytes.size(), ~0u));
+    }
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+
+static void BM_CRC32(benchmark::State& state)
+{
+    auto const bytes = makeBytes(state.range(0));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(core::crc32(bytes));
+    }
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+
+BENCHMARK(BM_CRC32_Bytewise)->Arg(64)->Arg(4 * 1024)->Arg(1024 * 1024);
+BENCHMARK(BM_CRC32_Slicing)->Arg(64)->Arg(4 * 1024)->Arg(1024 * 1024);
+BENCHMARK(BM_CRC32)->Arg(64)->Arg(4 * 1024)->Arg(1024 * 1024);
+
+// Mirrors RenderQueue::push, which takes the surface and the material by value
+template <typename Base>
+struct DrawQueue
+{
+    struct Element
+    {
+        core::ref_ptr<Base> surface;
+        core::ref_ptr<Base> material;
+        uint16_t layer;
+    };
+
+    std::vector<Element> elements;
+
+    auto pushCopy(core::ref_ptr<Base> surface, core::ref_ptr<Base> material, uint16_t const layer) -> void
+    {
+        elements.emplace_back(Element{.surface = surface, .material = material, .layer = layer});
+    }
+
+    auto pushMove(core::ref_ptr<Base> surface, core::ref_ptr<Base> material, uint16_t const layer) -> void
+    {
+        elements.emplace_back(Element{.surface = std::move(surface), .material = std::move(material), .layer = layer});
+    }
+};
+
+template <typename Base, bool IsMoved>
+static void BM_DrawSubmission(benchmark::State& state)
+{
+    size_t const drawCount = 1024;
+    std::vector<core::ref_ptr<Base>> surfaces;
+    std::vector<core::ref_ptr<Base>> materials;
+    for ([[maybe_unused]] size_t const i : std::views::iota(0u, drawCount))
+    {
+        surfaces.emplace_back(core::make_ref<Base>());
+        materials.emplace_back(core::make_ref<Base>());
+    }
+
+    DrawQueue<Base> queue;
+    queue.elements.reserve(drawCount);
+    for (auto _ : state)
+    {
+        queue.elements.clear();
+        for (size_t const i : std::views::iota(0u, drawCount))
+        {
+            if constexpr (IsMoved)
+            {
+                queue.pushMove(surfaces[i], materials[i], 0);
+            }
+            else
+            {
+                queue.pushCopy(surfaces[i], materials[i], 0);
+            }
+        }
+        benchmark::DoNotOptimize(queue.elements.data());
+    }
+    state.SetItemsProcessed(state.iterations() * drawCount);
+}
+
+BENCHMARK(BM_DrawSubmission<core::ref_counted_object, false>)->Name("BM_DrawSubmission/Atomic/Copy");
+BENCHMARK(BM_DrawSubmission<core::ref_counted_object, true>)->Name("BM_DrawSubmission/Atomic/Move");
+BENCHMARK(BM_DrawSubmission<core::local_ref_counted_object, false>)->Name("BM_DrawSubmission/Local/Copy");
+BENCHMARK(BM_DrawSubmission<core::local_ref_counted_object, true>)->Name("BM_DrawSubmission/Local/Move");
+
+template <bool IsLocked>
+static void BM_WeakPtr(benchmark::State& state)
+{
+    auto object = core::make_ref<core::ref_counted_object>();
+    core::weak_ptr<core::ref_counted_object> weakObject = object;
+    for (auto _ : state)
+    {
+        if constexpr (IsLocked)
+        {
+            benchmark::DoNotOptimize(weakObject.lock().get());
+        }
+        else
+        {
+            benchmark::DoNotOptimize(weakObject.get());
+        }
+    }
+}
+
+BENCHMARK(BM_WeakPtr<false>)->Name("BM_WeakPtr/Get");
+BENCHMARK(BM_WeakPtr<true>)->Name("BM_WeakPtr/Lock");
+
+// Create and release one object per iteration, as execute() does with its query
+static void BM_MakeRef_Heap(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(core::make_ref<core::ref_counted_object>().get());
+    }
+}
+
+template <typename Allocator>
+static void BM_MakeRef(benchmark::State& state)
+{
+    Allocator allocator(64 * 1024);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(core::make_ref<core::ref_counted_object>(std::allocator_arg, allocator).get());
+        if constexpr (std::is_same_v<Allocator, core::frame_allocator>)
+        {
+            allocator.reset();
+        }
+    }
+}
+
+BENCHMARK(BM_MakeRef_Heap)->Name("BM_MakeRef/Heap");
+BENCHMARK(BM_MakeRef<core::pool_allocator>)->Name("BM_MakeRef/Pool");
+BENCHMARK(BM_MakeRef<core::frame_allocator>)->Name("BM_MakeRef/Frame");
+
+BENCHMARK_MAIN();
@@ -1,81 +1,17 @@
 // Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
 
 #include "core/base64.hpp"
+#include "core/flat_hash_map.hpp"
+#include "core/ref_ptr.hpp"
 #include "core/serialize.hpp"
+#include "core/subprocess.hpp"
+#include "math/vector.hpp"
 #include "precompiled.h"
+#include "tests/serialize_data.hpp"
 #include <gtest/gtest.h>
 
 using namespace ionengine;
 
-enum class TestEnum
-{
-    First,
-    Second,
-    Third
-};
-
-template <>
-struct core::serializable_enum<TestEnum>
-{
-    template <typename Archive>
-    auto operator()(Archive& archive)
-    {
-        archive.field(TestEnum::First, "first");
-        archive.field(TestEnum::Second, "second");
-        archive.field(TestEnum::Third, "third");
-    }
-};
-
-struct InternalData
-{
-    std::string name;
-    uint32_t materialIndex;
-
-    template <typename Archive>
-    auto operator()(Archive& archive)
-    {
-        archive.property(name, "name");
-        archive.property(materialIndex, "materialIndex");
-    }
-};
-
-struct ShaderData
-{
-    uint32_t shaderInt;
-    float shaderFloat;
-    std::string name;
-    std::vector<std::string> names;
-    std::unordered_map<std::string, std::string> mapNames;
-    bool shaderBool;
-    InternalData internalData;
-    TestEnum testEnum;
-    std::unique_ptr<InternalData> internalData2;
-    std::array<int32_t, 2> positions;
-    std::unordered_map<TestEnum, std::string> enumNames;
-    std::unordered_map<uint32_t, std::string> valueNames;
-    std::optional<uint32_t> optionalInt;
-    std::optional<float> optionalFloat;
-
-    template <typename Archive>
-    auto operator()(Archive& archive)
-    {
-        archive.property(shaderInt, "shaderInt");
-        archive.property(shaderFloat, "shaderFloat");
-        archive.property(name, "name");
-        archive.property(names, "names");
-        archive.property(mapNames, "mapNames");
-        archive.property(shaderBool, "shaderBool");
-        archive.property(internalData, "internal");
-        archive.property(testEnum, "testEnum");
-        archive.property(internalData2, "internal2");
-        archive.property(positions, "positions");
-        archive.property(enumNames, "enumNames");
-        archive.property(valueNames, "enumNames");
-        archive.property(optionalInt, "optionalInt");
-        archive.property(optionalFloat, "optionalFloat");
-    }
-};
-
 struct ShaderFile
 {
     uint32_t magic;
@@ -141,6 +77,76 @@ TEST(Core, Serialize_JSON_Test)
     ASSERT_EQ(object.optionalFloat, shaderData.optionalFloat);
 }
 
+struct TextNode
+{
+    std::string text;
+    double weight;
+    std::vector<TextNode> children;
+
+    template <typename Archive>
+    auto operator()(Archive& archive)
+    {
+        archive.property(text, "text");
+        archive.property(weight, "weight");
+        archive.property(children, "children");
+    }
+};
+
+TEST(Core, Serialize_JSON_Stream_Test)
+{
+    TextNode node{.text = "root \"quoted\"\n",
+                  .weight = 0.1,
+                  .children = {{.text = "a\\b", .weight = 2.5, .children = {}},
+                               {.text = "\t", .weight = -1, .children = {}}}};
+
+    auto buffer = core::to_bytes<TextNode, core::serialize_ojson>(node).value();
+    std::string_view const json(reinterpret_cast<char const*>(buffer.data()), buffer.size());
+    ASSERT_EQ(json, R"({"text":"root \"quoted\"\n","weight":0.1,"children":[{"text":"a\\b","weight":2.5,"children":[]},)"
+                    R"({"text":"\t","weight":-1,"children":[]}]})");
+
+    auto object = core::from_bytes<TextNode, core::serialize_ijson>(buffer).value();
+    ASSERT_EQ(object.text, node.text);
+    ASSERT_EQ(object.weight, node.weight);
+    ASSERT_EQ(object.children.size(), 2);
+    ASSERT_EQ(object.children[0].text, node.children[0].text);
+    ASSERT_EQ(object.children[1].text, node.children[1].text);
+    ASSERT_EQ(object.children[1].weight, node.children[1].weight);
+}
+
+struct OptionalData
+{
+    std::string name;
+    std::optional<uint32_t> index;
+
+    template <typename Archive>
+    auto operator()(Archive& archive)
+    {
+        archive.property(name, "name");
+        archive.property(index, "index");
+    }
+};
+
+TEST(Core, Serialize_JSON_Fields_Test)
+{
+    auto fromString = []<typename Type>(std::string_view const json) {
+        return core::from_bytes<Type, core::serialize_ijson>(
+            std::span<uint8_t const>(reinterpret_cast<uint8_t const*>(json.data()), json.size()));
+    };
+
+    auto internalData =
+        fromString.operator()<InternalData>(R"({"unknown":[1,{"name":"skip"}],"materialIndex":7,"name":"reordered"})");
+    ASSERT_TRUE(internalData.has_value());
+    ASSERT_EQ(internalData->name, "reordered");
+    ASSERT_EQ(internalData->materialIndex, 7);
+
+    ASSERT_FALSE(fromString.operator()<InternalData>(R"({"name":"missing"})").has_value());
+
+    auto optionalData = fromString.operator()<OptionalData>(R"({"name":"optional"})");
+    ASSERT_TRUE(optionalData.has_value());
+    ASSERT_EQ(optionalData->name, "optional");
+    ASSERT_FALSE(optionalData->index.has_value());
+}
+
 TEST(Core, Serialize_Archive_Test)
 {
     auto internalData = std::make_unique<InternalData>();
@@ -192,6 +198,250 @@ TEST(Core, Serialize_Archive_Test)
     ASSERT_EQ(object.shaderData.positions, shaderFile.shaderData.positions);
 }
 
+struct PackedVertex
+{
+    float position[3];
+    uint32_t color;
+};
+
+struct BlobFile
+{
+    std::array<uint8_t, 4> magic;
+    std::vector<uint8_t> blob;
+    std::vector<float> weights;
+    std::vector<math::Vec3f> positions;
+    std::vector<PackedVertex> vertices;
+    std::array<uint16_t, 3> indices;
+    std::vector<std::string> names;
+
+    template <typename Archive>
+    auto operator()(Archive& archive)
+    {
+        archive.property(magic);
+        archive.property(blob);
+        archive.property(weights);
+        archive.property(positions);
+        archive.property(vertices);
+        archive.property(indices);
+        archive.property(names);
+    }
+};
+
+TEST(Core, Serialize_Archive_Trivial_Test)
+{
+    BlobFile blobFile{.magic = {'T', 'E', 'S', 'T'},
+                      .blob = std::vector<uint8_t>(1024 * 1024),
+                      .weights = {0.5f, 0.25f, 0.125f},
+                      .positions = {math::Vec3f(1.0f, 2.0f, 3.0f), math::Vec3f(4.0f, 5.0f, 6.0f)},
+                      .vertices = {PackedVertex{.position = {1.0f, 0.0f, 1.0f}, .color = 0xff00ff00}},
+                      .indices = {0, 1, 2},
+                      .names = {"first", "second"}};
+    std::iota(blobFile.blob.begin(), blobFile.blob.end(), 0);
+
+    auto result = core::to_bytes<BlobFile, core::serialize_oarchive>(blobFile);
+    auto buffer = std::move(result.value());
+
+    size_t const expectedSize = 4 + sizeof(size_t) + blobFile.blob.size() + sizeof(size_t) + 3 * sizeof(float) +
+                                sizeof(size_t) + 2 * sizeof(math::Vec3f) + sizeof(size_t) + sizeof(PackedVertex) +
+                                3 * sizeof(uint16_t) + sizeof(size_t) + sizeof(size_t) + 5 +
+                                sizeof(size_t) + 6;
+    ASSERT_EQ(buffer.size(), expectedSize);
+
+    auto resultAfter = core::from_bytes<BlobFile, core::serialize_iarchive>(buffer);
+    auto object = std::move(resultAfter.value());
+
+    ASSERT_EQ(object.magic, blobFile.magic);
+    ASSERT_EQ(object.blob, blobFile.blob);
+    ASSERT_EQ(object.weights, blobFile.weights);
+    ASSERT_EQ(object.positions, blobFile.positions);
+    ASSERT_EQ(object.vertices.size(), 1);
+    ASSERT_EQ(object.vertices[0].color, blobFile.vertices[0].color);
+    ASSERT_EQ(object.indices, blobFile.indices);
+    ASSERT_EQ(object.names, blobFile.names);
+
+    buffer.resize(buffer.size() / 2);
+    ASSERT_FALSE((core::from_bytes<BlobFile, core::serialize_iarchive>(buffer).has_value()));
+}
+
+struct RevisionFile
+{
+    std::array<uint8_t, 4> magic;
+    std::string name;
+    std::vector<std::string> names;
+
+    template <typename Archive>
+    auto operator()(Archive& archive)
+    {
+        archive.property(magic);
+        archive.revision(magic[3] == '0' ? core::archive_revision::v10 : core::archive_revision::latest);
+        archive.property(name);
+        archive.property(names);
+    }
+};
+
+TEST(Core, Serialize_Archive_Revision_Test)
+{
+    RevisionFile revisionFile{.magic = {'R', 'V', '1', '1'}, .name = "entry", .names = {"POSITION0", "", "TEXCOORD0"}};
+
+    auto buffer = core::to_bytes<RevisionFile, core::serialize_oarchive>(revisionFile).value();
+    ASSERT_EQ(buffer.size(), 4 + sizeof(size_t) + 5 + sizeof(size_t) + 3 * sizeof(size_t) + 9 + 0 + 9);
+
+    auto object = core::from_bytes<RevisionFile, core::serialize_iarchive>(buffer).value();
+    ASSERT_EQ(object.name, revisionFile.name);
+    ASSERT_EQ(object.names, revisionFile.names);
+
+    buffer.resize(buffer.size() - 1);
+    ASSERT_FALSE((core::from_bytes<RevisionFile, core::serialize_iarchive>(buffer).has_value()));
+
+    // Files with the previous magic keep their '\0'-terminated strings
+    revisionFile.magic = {'R', 'V', '1', '0'};
+    buffer = core::to_bytes<RevisionFile, core::serialize_oarchive>(revisionFile).value();
+    ASSERT_EQ(buffer.size(), 4 + 6 + sizeof(size_t) + 10 + 1 + 10);
+
+    object = core::from_bytes<RevisionFile, core::serialize_iarchive>(buffer).value();
+    ASSERT_EQ(object.name, revisionFile.name);
+    ASSERT_EQ(object.names, revisionFile.names);
+
+    buffer.resize(buffer.size() - 1);
+    ASSERT_FALSE((core::from_bytes<RevisionFile, core::serialize_iarchive>(buffer).has_value()));
+}
+
+struct MappedFile
+{
+    std::array<uint8_t, 4> magic;
+    std::string name;
+    InternalData internalData;
+    core::blob blob;
+
+    template <typename Archive>
+    auto operator()(Archive& archive)
+    {
+        archive.property(magic);
+        archive.property(name);
+        archive.template with<core::serialize_ojson, core::serialize_ijson>(internalData);
+        archive.property(blob);
+    }
+};
+
+TEST(Core, Serialize_Mapped_Test)
+{
+    std::vector<uint8_t> bytes(64 * 1024);
+    std::iota(bytes.begin(), bytes.end(), 0);
+
+    MappedFile mappedFile{.magic = {'T', 'E', 'S', 'T'},
+                          .name = "Hello world!",
+                          .internalData = {.name = "embedded", .materialIndex = 5},
+                          .blob = std::vector<uint8_t>(bytes)};
+    auto buffer = core::to_bytes<MappedFile, core::serialize_oarchive>(mappedFile).value();
+
+    auto const json = core::to_bytes<InternalData, core::serialize_ojson>(mappedFile.internalData).value();
+    size_t const jsonOffset = 4 + sizeof(size_t) + mappedFile.name.size();
+    ASSERT_EQ(*reinterpret_cast<size_t const*>(buffer.data() + jsonOffset), json.size());
+    ASSERT_TRUE(std::ranges::equal(std::span(buffer).subspan(jsonOffset + sizeof(size_t), json.size()), json));
+    auto const filePath = std::filesystem::temp_directory_path() / "ionengine_mapped_test.bin";
+    std::ofstream(filePath, std::ios::binary).write(reinterpret_cast<char const*>(buffer.data()), buffer.size());
+
+    auto resultAfter = core::from_file<MappedFile, core::serialize_imapped>(filePath);
+    auto object = std::move(resultAfter.value());
+
+    ASSERT_EQ(object.magic, mappedFile.magic);
+    ASSERT_EQ(object.name, mappedFile.name);
+    ASSERT_EQ(object.internalData.name, mappedFile.internalData.name);
+    ASSERT_EQ(object.internalData.materialIndex, mappedFile.internalData.materialIndex);
+    ASSERT_TRUE(object.blob.is_mapped());
+    ASSERT_EQ(object.blob, mappedFile.blob);
+
+    auto resultStream = core::from_bytes<MappedFile, core::serialize_iarchive>(buffer);
+    ASSERT_FALSE(resultStream.value().blob.is_mapped());
+    ASSERT_EQ(resultStream.value().internalData.name, mappedFile.internalData.name);
+    ASSERT_EQ(resultStream.value().blob, mappedFile.blob);
+
+    ASSERT_FALSE((core::from_file<MappedFile, core::serialize_imapped>("missing_test.bin").has_value()));
+
+    std::filesystem::remove(filePath);
+}
+
+TEST(Core, Serialize_File_Checksum_Test)
+{
+    std::vector<uint8_t> bytes(3 * 1024 * 1024 + 17);
+    std::iota(bytes.begin(), bytes.end(), 0);
+
+    MappedFile mappedFile{.magic = {'T', 'E', 'S', 'T'},
+                          .name = "checksum",
+                          .internalData = {.name = "embedded", .materialIndex = 1},
+                          .blob = std::vector<uint8_t>(bytes)};
+    auto const filePath = std::filesystem::temp_directory_path() / "ionengine_checksum_test.bin";
+    ASSERT_TRUE((core::to_file<MappedFile, core::serialize_oarchive>(mappedFile, filePath)));
+
+    auto buffer = core::to_bytes<MappedFile, core::serialize_oarchive>(mappedFile).value();
+    std::ifstream file(filePath, std::ios::binary);
+    std::vector<uint8_t> fileBytes(std::istreambuf_iterator<char>(file), {});
+    ASSERT_EQ(fileBytes, buffer);
+
+    auto object = core::from_bytes<MappedFile, core::serialize_iarchive>(fileBytes);
+    ASSERT_TRUE(object.has_value());
+    ASSERT_EQ(object->internalData.name, mappedFile.internalData.name);
+    ASSERT_EQ(object->blob, mappedFile.blob);
+
+    buffer[buffer.size() - 5] ^= 0x1;
+    ASSERT_FALSE((core::from_bytes<MappedFile, core::serialize_iarchive>(buffer).has_value()));
+
+    file.close();
+    std::filesystem::remove(filePath);
+}
+
+TEST(Core, Serialize_Enum_Test)
+{
+    ASSERT_EQ(core::enum_from_string<TestEnum>("second"), TestEnum::Second);
+    ASSERT_FALSE(core::enum_from_string<TestEnum>("fourth").has_value());
+    ASSERT_EQ(core::enum_to_string(TestEnum::Third), "third");
+
+    ASSERT_EQ((core::from_string<TestEnum, core::serialize_oenum>("first")), TestEnum::First);
+    ASSERT_FALSE((core::from_string<TestEnum, core::serialize_oenum>("First").has_value()));
+}
+
+TEST(Core, CRC32_Test)
+{
+    std::string_view const text = "The quick brown fox jumps over the lazy dog";
+    std::span<uint8_t const> const bytes(reinterpret_cast<uint8_t const*>(text.data()), text.size());
+
+    ASSERT_EQ(core::crc32(bytes), 0x414fa339);
+    ASSERT_EQ(core::crc32(bytes), core::crc32(text));
+    ASSERT_EQ(core::crc32(bytes.subspan(13), core::crc32(bytes.subspan(0, 13))), core::crc32(bytes));
+    ASSERT_EQ(core::crc32(std::span<uint8_t const>()), 0);
+}
+
+TEST(Core, CRC32_Paths)
+{
+    std::mt19937 random(11);
+    std::vector<uint8_t> bytes(2048);
+    for (auto& byte : bytes)
+    {
+        byte = static_cast<uint8_t>(random());
+    }
+
+    for (size_t const size : {0u, 1u, 15u, 16u, 63u, 64u, 65u, 127u, 128u, 200u, 1000u, 2048u})
+    {
+        std::span<uint8_t const> const source(bytes.data(), size);
+        uint32_t const expected = core::crc32(std::string_view(reinterpret_cast<char const*>(bytes.data()), size));
+
+        ASSERT_EQ(core::crc32(source), expected);
+        ASSERT_EQ(~core::internal::crc32_slicing(source.data(), source.size(), ~0u), expected);
+
+        if (size >= 64 && core::get_cpu_features().pclmul && core::get_cpu_features().sse41)
+        {
+            size_t const foldedSize = size & ~size_t(15);
+            uint32_t const state = core::internal::crc32_pclmul(source.data(), foldedSize, ~0u);
+            ASSERT_EQ(~core::internal::crc32_slicing(source.data() + foldedSize, size - foldedSize, state), expected);
+        }
+
+        for (size_t const split : {size / 3, size / 2})
+        {
+            ASSERT_EQ(core::crc32(source.subspan(split), core::crc32(source.subspan(0, split))), expected);
+        }
+    }
+}
+
 TEST(Core, Base64_Encode)
 {
     std::string test = "Hello world!";
@@ -207,6 +457,348 @@ TEST(Core, Base64_Decode)
     ASSERT_EQ(std::string(reinterpret_cast<char*>(buffer.data()), buffer.size()), "Hello world!");
 }
 
+TEST(Core, Base64_SIMD)
+{
+    std::mt19937 random(7);
+    for (size_t const size : std::views::iota(0u, 300u))
+    {
+        std::vector<uint8_t> bytes(size);
+        for (auto& byte : bytes)
+        {
+            byte = static_cast<uint8_t>(random());
+        }
+
+        std::string expected(core::base64::encoded_size(size), '\0');
+        core::internal::encode_scalar(bytes.data(), bytes.size(), expected.data());
+
+        std::string encodedString = core::base64::encode(bytes);
+        ASSERT_EQ(encodedString, expected);
+
+        if (core::get_cpu_features().ssse3)
+        {
+            std::string simdString(expected.size(), '\0');
+            size_t const encoded = core::internal::encode_ssse3(bytes.data(), bytes.size(), simdString.data());
+            core::internal::encode_scalar(bytes.data() + encoded, bytes.size() - encoded,
+                                          simdString.data() + encoded / 3 * 4);
+            ASSERT_EQ(simdString, expected);
+        }
+
+        if (core::get_cpu_features().avx2)
+        {
+            std::string simdString(expected.size(), '\0');
+            size_t const encoded = core::internal::encode_avx2(bytes.data(), bytes.size(), simdString.data());
+            core::internal::encode_scalar(bytes.data() + encoded, bytes.size() - encoded,
+                                          simdString.data() + encoded / 3 * 4);
+            ASSERT_EQ(simdString, expected);
+        }
+
+        std::vector<uint8_t> decodedBytes(size);
+        ASSERT_EQ(core::base64::decode(encodedString, decodedBytes), size);
+        ASSERT_EQ(decodedBytes, bytes);
+
+        // A character outside of the alphabet anywhere in the input has to be rejected by every path
+        if (size > 0)
+        {
+            std::string invalidString = encodedString;
+            invalidString[random() % (core::base64::encoded_size(size) - 2)] = '*';
+            ASSERT_FALSE(core::base64::decode(invalidString, decodedBytes).has_value());
+        }
+    }
+}
+
+TEST(Core, Base64_Invalid)
+{
+    std::array<uint8_t, 16> bytes;
+    ASSERT_FALSE(core::base64::decode("").has_value());
+    ASSERT_FALSE(core::base64::decode("S").has_value());
+    ASSERT_FALSE(core::base64::decode("SGVsb").has_value());
+    ASSERT_TRUE(core::base64::decode("SGV=").has_value());
+    ASSERT_FALSE(core::base64::decode("SG=A").has_value());
+    ASSERT_FALSE(core::base64::decode("S===").has_value());
+    ASSERT_FALSE(core::base64::decode("SGVsbG8gd29ybGQh\n").has_value());
+    ASSERT_FALSE(core::base64::decode("SGVsbG8gd29ybGQh", std::span<uint8_t>(bytes.data(), 11)).has_value());
+
+    ASSERT_EQ(core::base64::decode("SGVsbG8=", bytes), 5);
+    ASSERT_EQ(core::base64::decode("SGVsbA==", bytes), 4);
+    ASSERT_EQ(core::base64::decode("SGVsbA", bytes), 4);
+}
+
+template <typename Base>
+class CountedObject : public Base
+{
+  public:
+    CountedObject(uint32_t& destroyCount) : destroyCount(&destroyCount)
+    {
+    }
+
+    ~CountedObject()
+    {
+        ++(*destroyCount);
+    }
+
+  private:
+    uint32_t* destroyCount;
+};
+
+template <typename Type>
+struct CountingDeleter
+{
+    static inline uint32_t deleteCount = 0;
+
+    auto operator()(Type* ptr) -> void
+    {
+        ++deleteCount;
+        delete ptr;
+    }
+};
+
+template <typename Base>
+auto testRefPtrMove() -> void
+{
+    uint32_t destroyCount = 0;
+    {
+        auto object = core::make_ref<CountedObject<Base>>(destroyCount);
+        ASSERT_EQ(object->use_count(), 1);
+
+        core::ref_ptr<CountedObject<Base>> copied = object;
+        ASSERT_EQ(object->use_count(), 2);
+
+        core::ref_ptr<CountedObject<Base>> moved = std::move(copied);
+        ASSERT_FALSE(copied);
+        ASSERT_EQ(object->use_count(), 2);
+
+        core::ref_ptr<Base> base = std::move(moved);
+        ASSERT_FALSE(moved);
+        ASSERT_EQ(object->use_count(), 2);
+
+        // Moving onto a pointer to the same object drops one reference
+        core::ref_ptr<CountedObject<Base>> same = object;
+        object = std::move(same);
+        ASSERT_EQ(object->use_count(), 2);
+
+        base = nullptr;
+        ASSERT_EQ(object->use_count(), 1);
+        ASSERT_EQ(destroyCount, 0);
+    }
+    ASSERT_EQ(destroyCount, 1);
+}
+
+TEST(Core, RefPtr_Move)
+{
+    testRefPtrMove<core::ref_counted_object>();
+    testRefPtrMove<core::local_ref_counted_object>();
+}
+
+TEST(Core, WeakPtr)
+{
+    uint32_t destroyCount = 0;
+
+    core::weak_ptr<core::ref_counted_object> weakObject;
+    ASSERT_FALSE(weakObject.lock());
+    {
+        auto object = core::make_ref<CountedObject<core::ref_counted_object>>(destroyCount);
+        weakObject = object;
+        ASSERT_EQ(object->use_count(), 1);
+
+        core::weak_ptr<CountedObject<core::ref_counted_object>> weakCopy = object;
+        {
+            auto locked = weakCopy.lock();
+            ASSERT_TRUE(locked);
+            ASSERT_EQ(object->use_count(), 2);
+        }
+        ASSERT_EQ(object->use_count(), 1);
+        ASSERT_EQ(weakCopy.get(), object.get());
+    }
+    ASSERT_EQ(destroyCount, 1);
+    ASSERT_TRUE(weakObject.expired());
+    ASSERT_FALSE(weakObject.lock());
+
+    // Objects allocated without make_ref keep an inline counter
+    {
+        core::ref_ptr<CountedObject<core::local_ref_counted_object>> object =
+            new CountedObject<core::local_ref_counted_object>(destroyCount);
+        ASSERT_EQ(object->get_control_block(), nullptr);
+    }
+    ASSERT_EQ(destroyCount, 2);
+
+    // So do objects from make_ref with a custom deleter, which is the one that frees them
+    {
+        using Deleter = CountingDeleter<CountedObject<core::ref_counted_object>>;
+        auto object = core::make_ref<CountedObject<core::ref_counted_object>, Deleter>(destroyCount);
+        ASSERT_EQ(object->get_control_block(), nullptr);
+    }
+    ASSERT_EQ(destroyCount, 3);
+    ASSERT_EQ(CountingDeleter<CountedObject<core::ref_counted_object>>::deleteCount, 1);
+}
+
+TEST(Core, WeakPtr_Threads)
+{
+    for ([[maybe_unused]] uint32_t const i : std::views::iota(0u, 64u))
+    {
+        uint32_t destroyCount = 0;
+        auto object = core::make_ref<CountedObject<core::ref_counted_object>>(destroyCount);
+        core::weak_ptr<CountedObject<core::ref_counted_object>> weakObject = object;
+
+        std::atomic<uint32_t> lockCount = 0;
+        std::vector<std::thread> threads;
+        for ([[maybe_unused]] uint32_t const j : std::views::iota(0u, 4u))
+        {
+            threads.emplace_back([weakObject, &lockCount]() {
+                for ([[maybe_unused]] uint32_t const k : std::views::iota(0u, 1000u))
+                {
+                    if (auto locked = weakObject.lock())
+                    {
+                        lockCount.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            });
+        }
+        object = nullptr;
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        ASSERT_EQ(destroyCount, 1);
+        ASSERT_TRUE(weakObject.expired());
+    }
+}
+
+TEST(Core, RefPtr_Allocator)
+{
+    uint32_t destroyCount = 0;
+
+    core::pool_allocator pool(4);
+    std::vector<core::ref_ptr<CountedObject<core::ref_counted_object>>> objects;
+    for ([[maybe_unused]] uint32_t const i : std::views::iota(0u, 10u))
+    {
+        objects.emplace_back(core::make_ref<CountedObject<core::ref_counted_object>>(std::allocator_arg, pool,
+                                                                                     destroyCount));
+    }
+
+    // Freed blocks are handed out again
+    auto const* released = objects.back().get();
+    core::weak_ptr<CountedObject<core::ref_counted_object>> weakObject = objects.back();
+    objects.pop_back();
+    ASSERT_EQ(destroyCount, 1);
+    ASSERT_FALSE(weakObject.lock());
+    weakObject = nullptr;
+
+    objects.emplace_back(
+        core::make_ref<CountedObject<core::ref_counted_object>>(std::allocator_arg, pool, destroyCount));
+    ASSERT_EQ(objects.back().get(), released);
+    objects.clear();
+    ASSERT_EQ(destroyCount, 11);
+    ASSERT_THROW(pool.allocate(1024, 8), core::runtime_error);
+
+    core::frame_allocator arena(1024);
+    for ([[maybe_unused]] uint32_t const frame : std::views::iota(0u, 3u))
+    {
+        auto first = core::make_ref<CountedObject<core::local_ref_counted_object>>(std::allocator_arg, arena,
+                                                                                   destroyCount);
+        auto second = core::make_ref<CountedObject<core::local_ref_counted_object>>(std::allocator_arg, arena,
+                                                                                    destroyCount);
+        ASSERT_NE(first.get(), second.get());
+        first = nullptr;
+        second = nullptr;
+        arena.reset();
+    }
+    ASSERT_EQ(destroyCount, 17);
+    ASSERT_THROW(core::frame_allocator(16).allocate(32, 8), core::runtime_error);
+}
+
+TEST(Core, Hash)
+{
+    std::hash<math::Vec3f> const hasher;
+    ASSERT_NE(hasher(math::Vec3f(1.0f, 2.0f, 3.0f)), hasher(math::Vec3f(2.0f, 1.0f, 3.0f)));
+    ASSERT_NE(hasher(math::Vec3f(5.0f, 5.0f, 0.0f)), hasher(math::Vec3f(0.0f, 0.0f, 0.0f)));
+    ASSERT_EQ(hasher(math::Vec3f(-0.0f, 1.0f, 0.0f)), hasher(math::Vec3f(0.0f, 1.0f, -0.0f)));
+
+    // Positions of a grid, the low bits select the bucket of an open addressing table
+    std::unordered_set<size_t> buckets;
+    for (uint32_t const x : std::views::iota(0u, 64u))
+    {
+        for (uint32_t const y : std::views::iota(0u, 64u))
+        {
+            buckets.emplace(hasher(math::Vec3f(x * 0.5f, y * 0.5f, 0.0f)) & 0xffff);
+        }
+    }
+    ASSERT_GT(buckets.size(), 3900);
+}
+
+TEST(Core, FlatHashMap)
+{
+    core::flat_hash_map<math::Vec3f, uint32_t> map;
+    ASSERT_TRUE(map.empty());
+    ASSERT_EQ(map.find(math::Vec3f(1.0f, 0.0f, 0.0f)), nullptr);
+
+    for (uint32_t const i : std::views::iota(0u, 10000u))
+    {
+        auto const [value, isInserted] = map.try_emplace(math::Vec3f(float(i % 100), float(i / 100), 0.0f), i);
+        ASSERT_TRUE(isInserted);
+        ASSERT_EQ(value, i);
+    }
+    ASSERT_EQ(map.size(), 10000);
+
+    for (uint32_t const i : std::views::iota(0u, 10000u))
+    {
+        math::Vec3f const key(float(i % 100), float(i / 100), 0.0f);
+        auto const [value, isInserted] = map.try_emplace(key, 0);
+        ASSERT_FALSE(isInserted);
+        ASSERT_EQ(value, i);
+        ASSERT_EQ(*map.find(key), i);
+    }
+    ASSERT_EQ(map.find(math::Vec3f(0.0f, 0.0f, 1.0f)), nullptr);
+
+    map.clear();
+    ASSERT_EQ(map.size(), 0);
+    ASSERT_EQ(map.find(math::Vec3f(1.0f, 0.0f, 0.0f)), nullptr);
+    ASSERT_TRUE(map.try_emplace(math::Vec3f(1.0f, 0.0f, 0.0f), 7).second);
+}
+
+#ifndef _WIN32
+TEST(Core, Subprocess)
+{
+    core::subprocess_pool pool(2);
+
+    std::string streamed;
+    auto future = pool.execute({"sh", "-c", "echo out; echo err 1>&2; exit 3"},
+                               {.on_output = [&streamed](std::span<uint8_t const> const chunk) {
+                                   streamed.append(reinterpret_cast<char const*>(chunk.data()), chunk.size());
+                               }});
+    auto result = future.get();
+    ASSERT_EQ(result.exit_code, 3);
+    ASSERT_EQ(std::string(result.output.begin(), result.output.end()), "out\n");
+    ASSERT_EQ(std::string(result.errors.begin(), result.errors.end()), "err\n");
+    ASSERT_EQ(streamed, "out\n");
+    ASSERT_FALSE(result.is_timed_out);
+
+    auto timedOut = pool.execute({"sleep", "10"}, {.timeout = std::chrono::milliseconds(100)}).get();
+    ASSERT_TRUE(timedOut.is_timed_out);
+
+    ASSERT_THROW(pool.execute({"ionengine-missing-program"}).get(), core::runtime_error);
+
+    // Four children of 200 ms through two slots take two rounds
+    auto const start = std::chrono::steady_clock::now();
+    std::vector<std::future<core::subprocess_result>> futures;
+    for ([[maybe_unused]] uint32_t const i : std::views::iota(0u, 4u))
+    {
+        futures.emplace_back(pool.execute({"sleep", "0.2"}));
+    }
+    for (auto& e : futures)
+    {
+        ASSERT_EQ(e.get().exit_code, 0);
+    }
+    auto const elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_GE(elapsed, std::chrono::milliseconds(400));
+    ASSERT_LT(elapsed, std::chrono::milliseconds(800));
+
+    std::vector<std::string> const arguments = {"echo", "sync"};
+    auto const output = core::subprocessExecute(arguments);
+    ASSERT_EQ(std::string(output.value().begin(), output.value().end()), "sync\n");
+}
+#endif
+
 auto main(int32_t argc, char** argv) -> int32_t
 {
     testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,196 @@
+// Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
+
+#include "math/color.hpp"
+#include "math/matrix.hpp"
+#include "math/transform.hpp"
+#include "precompiled.h"
+#include "shadersys/compiler.hpp"
+#include <benchmark/benchmark.h>
+
+using namespace ionengine;
+
+// Per draw transform constants, as the renderer fills them for every object
+static void BM_TransformData(benchmark::State& state)
+{
+    auto const viewProj = math::Matf::translate(math::Vec3f(0.0f, -1.0f, -10.0f)) *
+                          math::Matf::perspectiveRH(1.2f, 16.0f / 9.0f, 0.1f, 1000.0f);
+
+    std::vector<math::Matf> models(state.range(0));
+    for (auto const i : std::views::iota(0u, models.size()))
+    {
+        models[i] = math::Matf::scale(math::Vec3f(1.0f, 2.0f, 1.0f)) *
+                    math::Matf::translate(math::Vec3f(float(i % 32), 0.0f, float(i / 32)));
+    }
+
+    std::vector<shadersys::common::TransformData> transforms(models.size());
+    for (auto _ : state)
+    {
+        for (auto const i : std::views::iota(0u, models.size()))
+        {
+            auto modelViewProj = models[i] * viewProj;
+            transforms[i].inverseModelViewProj = math::Matf(modelViewProj).inverse().transpose();
+            transforms[i].modelViewProj = modelViewProj.transpose();
+        }
+        benchmark::DoNotOptimize(transforms.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * models.size());
+}
+
+BENCHMARK(BM_TransformData)->Arg(1024);
+
+struct Objects
+{
+    std::vector<math::Vec3f> positions;
+    std::vector<math::Quatf> rotations;
+    std::vector<math::Vec3f> scales;
+};
+
+auto makeObjects(size_t const count) -> Objects
+{
+    std::mt19937 random(5);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+    Objects objects;
+    for ([[maybe_unused]] size_t const i : std::views::iota(0u, count))
+    {
+        objects.positions.emplace_back(distribution(random) * 100.0f, 0.0f, distribution(random) * 100.0f);
+        objects.rotations.emplace_back(
+            math::Quatf::fromAngleAxis(distribution(random) * 180.0f, math::Vec3f(0.0f, 1.0f, 0.0f)));
+        objects.scales.emplace_back(1.0f, 1.0f, 1.0f);
+    }
+    return objects;
+}
+
+// One object at a time, composed from Mat operations
+static void BM_TransformObjects(benchmark::State& state)
+{
+    auto const viewProj = math::Matf::translate(math::Vec3f(0.0f, -1.0f, -10.0f)) *
+                          math::Matf::perspectiveRH(1.2f, 16.0f / 9.0f, 0.1f, 1000.0f);
+    auto const objects = makeObjects(state.range(0));
+
+    std::vector<math::Matf> modelViewProjs(objects.positions.size());
+    std::vector<math::Matf> inverseModelViewProjs(objects.positions.size());
+    for (auto _ : state)
+    {
+        for (auto const i : std::views::iota(0u, objects.positions.size()))
+        {
+            modelViewProjs[i] = math::Matf::scale(objects.scales[i]) * objects.rotations[i].toMat() *
+                                math::Matf::translate(objects.positions[i]) * viewProj;
+            inverseModelViewProjs[i] = math::Matf(modelViewProjs[i]).inverse();
+        }
+        benchmark::DoNotOptimize(modelViewProjs.data());
+        benchmark::DoNotOptimize(inverseModelViewProjs.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * objects.positions.size());
+}
+
+BENCHMARK(BM_TransformObjects)->Arg(50000);
+
+static void BM_TransformBatch(benchmark::State& state)
+{
+    auto const viewProj = math::Matf::translate(math::Vec3f(0.0f, -1.0f, -10.0f)) *
+                          math::Matf::perspectiveRH(1.2f, 16.0f / 9.0f, 0.1f, 1000.0f);
+    auto const objects = makeObjects(state.range(0));
+    math::TransformBatch const batch{
+        .positions = objects.positions, .rotations = objects.rotations, .scales = objects.scales};
+
+    std::vector<math::Matf> modelViewProjs(batch.size());
+    std::vector<math::Matf> inverseModelViewProjs(batch.size());
+    for (auto _ : state)
+    {
+        math::computeTransforms(batch, viewProj, modelViewProjs, inverseModelViewProjs);
+        benchmark::DoNotOptimize(modelViewProjs.data());
+        benchmark::DoNotOptimize(inverseModelViewProjs.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * batch.size());
+}
+
+BENCHMARK(BM_TransformBatch)->Arg(50000);
+
+static void BM_Matrix_Multiply(benchmark::State& state)
+{
+    auto const lhs = math::Matf::translate(math::Vec3f(1.0f, 2.0f, 3.0f));
+    auto rhs = math::Matf::perspectiveRH(1.2f, 1.5f, 0.1f, 100.0f);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(rhs = lhs * rhs);
+    }
+}
+
+BENCHMARK(BM_Matrix_Multiply);
+
+static void BM_Matrix_Inverse(benchmark::State& state)
+{
+    auto mat = math::Matf::translate(math::Vec3f(1.0f, 2.0f, 3.0f)) *
+               math::Matf::perspectiveRH(1.2f, 1.5f, 0.1f, 100.0f);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(mat.inverse());
+    }
+}
+
+BENCHMARK(BM_Matrix_Inverse);
+
+auto makePixels(size_t const count) -> std::vector<float>
+{
+    std::mt19937 random(9);
+    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+    std::vector<float> pixels(count * 4);
+    for (auto& value : pixels)
+    {
+        value = distribution(random);
+    }
+    return pixels;
+}
+
+// Image converted to linear and back, so that the values do not drift into denormals between iterations
+static void BM_Color_Scalar(benchmark::State& state)
+{
+    auto pixels = makePixels(state.range(0));
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < pixels.size(); i += 4)
+        {
+            auto color = math::Color(pixels[i], pixels[i + 1], pixels[i + 2], pixels[i + 3]).rgb().srgb();
+            std::memcpy(pixels.data() + i, color.data(), sizeof(math::Color));
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_Color_Scalar)->Arg(1 << 20);
+
+static void BM_Color_Float(benchmark::State& state)
+{
+    auto pixels = makePixels(state.range(0));
+    for (auto _ : state)
+    {
+        math::srgbToLinear(pixels);
+        math::linearToSrgb(pixels);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_Color_Float)->Arg(1 << 20);
+
+static void BM_Color_RGBA8(benchmark::State& state)
+{
+    std::vector<uint8_t> pixels(state.range(0) * 4);
+    std::iota(pixels.begin(), pixels.end(), 0);
+    for (auto _ : state)
+    {
+        math::srgbToLinear(std::span<uint8_t>(pixels));
+        math::linearToSrgb(std::span<uint8_t>(pixels));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_Color_RGBA8)->Arg(1 << 20);
+
+BENCHMARK_MAIN();
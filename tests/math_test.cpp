@@ -0,0 +1,254 @@
+// Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
+
+#include "math/color.hpp"
+#include "math/matrix.hpp"
+#include "math/transform.hpp"
+#include "precompiled.h"
+#include <gtest/gtest.h>
+
+using namespace ionengine;
+
+// Values are representable in float, so both precisions start from the same matrix
+auto makeMatrix(std::mt19937& random) -> math::Matd
+{
+    std::uniform_real_distribution<float> distribution(-4.0f, 4.0f);
+    std::array<double, 16> values;
+    for (auto& value : values)
+    {
+        value = distribution(random);
+    }
+    return std::make_from_tuple<math::Matd>(values);
+}
+
+auto toFloat(math::Matd const& other) -> math::Matf
+{
+    std::array<float, 16> values;
+    for (auto const i : std::views::iota(0u, 16u))
+    {
+        values[i] = static_cast<float>(other.data()[i]);
+    }
+    return std::make_from_tuple<math::Matf>(values);
+}
+
+auto toDouble(math::Matf const& other) -> math::Matd
+{
+    std::array<double, 16> values;
+    for (auto const i : std::views::iota(0u, 16u))
+    {
+        values[i] = other.data()[i];
+    }
+    return std::make_from_tuple<math::Matd>(values);
+}
+
+// SIMD results of Matf against the scalar path of Matd
+auto expectNear(math::Matf const& result, math::Matd const& expected, double const tolerance) -> void
+{
+    for (auto const i : std::views::iota(0u, 16u))
+    {
+        EXPECT_NEAR(result.data()[i], expected.data()[i], tolerance * std::max(1.0, std::abs(expected.data()[i])));
+    }
+}
+
+TEST(Math, Matrix_SIMD)
+{
+    std::mt19937 random(7);
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        math::Matd const lhs = makeMatrix(random);
+        math::Matd const rhs = makeMatrix(random);
+
+        expectNear(toFloat(lhs) * toFloat(rhs), lhs * rhs, 1e-5);
+        expectNear(math::Matf(toFloat(lhs)).transpose(), math::Matd(lhs).transpose(), 0.0);
+
+        math::Vec4d const vec(rhs._00, rhs._11, rhs._22, rhs._33);
+        math::Vec4f const result = toFloat(lhs).transform(math::Vec4f(vec.x, vec.y, vec.z, vec.w));
+        math::Vec4d const expected = lhs.transform(vec);
+        for (auto const j : std::views::iota(0u, 4u))
+        {
+            EXPECT_NEAR(result.data()[j], expected.data()[j], 1e-4);
+        }
+
+        // Skip matrices close to singular, their inverse is not stable in single precision
+        math::Matd inverse = lhs;
+        inverse.inverse();
+        double maxValue = 0.0;
+        for (auto const value : std::span(inverse.data(), 16))
+        {
+            maxValue = std::max(maxValue, std::abs(value));
+        }
+        if (maxValue > 100.0)
+        {
+            continue;
+        }
+        expectNear(math::Matf(toFloat(lhs)).inverse(), inverse, 1e-3);
+    }
+}
+
+TEST(Math, Matrix_Inverse)
+{
+    auto const model = math::Matf::scale(math::Vec3f(2.0f, 3.0f, 4.0f)) *
+                       math::Matf::translate(math::Vec3f(1.0f, -2.0f, 5.0f));
+    auto const modelViewProj = model * math::Matf::perspectiveRH(1.2f, 1.5f, 0.1f, 100.0f);
+
+    auto const identity = modelViewProj * math::Matf(modelViewProj).inverse();
+    for (auto const i : std::views::iota(0u, 16u))
+    {
+        EXPECT_NEAR(identity.data()[i], math::Matf::identity().data()[i], 1e-5);
+    }
+}
+
+TEST(Math, Vector_SIMD)
+{
+    math::Vec4f const lhs(1.0f, -2.0f, 3.5f, 8.0f);
+    math::Vec4f const rhs(0.5f, 4.0f, -1.0f, 2.0f);
+
+    ASSERT_EQ(lhs + rhs, math::Vec4f(1.5f, 2.0f, 2.5f, 10.0f));
+    ASSERT_EQ(lhs - rhs, math::Vec4f(0.5f, -6.0f, 4.5f, 6.0f));
+    ASSERT_EQ(lhs * 2.0f, math::Vec4f(2.0f, -4.0f, 7.0f, 16.0f));
+    ASSERT_EQ(lhs / 2.0f, math::Vec4f(0.5f, -1.0f, 1.75f, 4.0f));
+    ASSERT_FALSE(lhs == math::Vec4f(1.0f, -2.0f, 3.5f, 0.0f));
+
+    auto const translate = math::Matf::translate(math::Vec3f(1.0f, 2.0f, 3.0f));
+    ASSERT_EQ(translate.transform(math::Vec4f(1.0f, 1.0f, 1.0f, 1.0f)), math::Vec4f(2.0f, 3.0f, 4.0f, 1.0f));
+}
+
+TEST(Math, Transform_Batch)
+{
+    std::mt19937 random(11);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+    // Not a multiple of the chunk or SIMD width, so that the remainder is covered
+    size_t const count = 2 * math::TransformChunkSize + 3;
+    std::vector<math::Vec3f> positions(count);
+    std::vector<math::Quatf> rotations(count);
+    std::vector<math::Vec3f> scales(count);
+    for (auto const i : std::views::iota(0u, count))
+    {
+        positions[i] = math::Vec3f(distribution(random), distribution(random), distribution(random)) * 50.0f;
+        rotations[i] =
+            math::Quatf(distribution(random), distribution(random), distribution(random), distribution(random))
+                .normalize();
+        scales[i] = math::Vec3f(distribution(random) + 2.0f, distribution(random) + 2.0f, distribution(random) + 2.0f);
+    }
+
+    auto const viewProj = math::Matf::translate(math::Vec3f(0.0f, -1.0f, -10.0f)) *
+                          math::Matf::perspectiveRH(1.2f, 16.0f / 9.0f, 0.1f, 1000.0f);
+
+    math::TransformBatch const batch{.positions = positions, .rotations = rotations, .scales = scales};
+    std::vector<math::Matf> modelViewProjs(count);
+    std::vector<math::Matf> inverseModelViewProjs(count);
+
+    std::vector<std::thread> threads;
+    for (size_t offset = 0; offset < count; offset += math::TransformChunkSize)
+    {
+        size_t const chunkSize = std::min(math::TransformChunkSize, count - offset);
+        threads.emplace_back([&, offset, chunkSize] {
+            math::computeTransforms(batch.chunk(offset, chunkSize), viewProj,
+                                    std::span(modelViewProjs).subspan(offset, chunkSize),
+                                    std::span(inverseModelViewProjs).subspan(offset, chunkSize));
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (auto const i : std::views::iota(0u, count))
+    {
+        auto const expected = math::Matf::scale(scales[i]) * rotations[i].toMat() *
+                              math::Matf::translate(positions[i]) * viewProj;
+        for (auto const j : std::views::iota(0u, 16u))
+        {
+            ASSERT_NEAR(modelViewProjs[i].data()[j], expected.data()[j],
+                        1e-4f * std::max(1.0f, std::abs(expected.data()[j])));
+        }
+
+        math::Matd inverse = toDouble(modelViewProjs[i]);
+        inverse.inverse();
+        for (auto const j : std::views::iota(0u, 16u))
+        {
+            ASSERT_NEAR(inverseModelViewProjs[i].data()[j], inverse.data()[j],
+                        1e-4 * std::max(1.0, std::abs(inverse.data()[j])));
+        }
+    }
+}
+
+TEST(Math, Quat_Rotation)
+{
+    auto const rotation = math::Quatf::fromAngleAxis(90.0f, math::Vec3f(0.0f, 0.0f, 1.0f));
+    auto const rotated = rotation * math::Vec3f(1.0f, 0.0f, 0.0f);
+    auto const transformed = rotation.toMat().transform(math::Vec4f(1.0f, 0.0f, 0.0f, 1.0f));
+
+    EXPECT_NEAR(rotated.y, 1.0f, 1e-6f);
+    EXPECT_NEAR(transformed.x, rotated.x, 1e-6f);
+    EXPECT_NEAR(transformed.y, rotated.y, 1e-6f);
+    EXPECT_NEAR(transformed.z, rotated.z, 1e-6f);
+}
+
+TEST(Math, Color_Conversion)
+{
+    auto color = math::Color(0.5f, 0.0f, 1.0f, 0.25f);
+    color.srgb();
+    EXPECT_NEAR(color.r, 0.735357f, 1e-5f);
+    EXPECT_EQ(color.g, 0.0f);
+    EXPECT_NEAR(color.b, 1.0f, 1e-5f);
+    EXPECT_EQ(color.a, 0.25f);
+    color.rgb();
+    EXPECT_NEAR(color.r, 0.5f, 1e-5f);
+
+    std::vector<float> pixels;
+    for (auto const i : std::views::iota(0u, 4096u))
+    {
+        pixels.emplace_back(i / 4095.0f);
+    }
+
+    auto linear = pixels;
+    math::srgbToLinear(linear);
+    auto srgb = pixels;
+    math::linearToSrgb(srgb);
+    for (auto const i : std::views::iota(0u, pixels.size()))
+    {
+        if (i % 4 == 3)
+        {
+            ASSERT_EQ(linear[i], pixels[i]);
+            ASSERT_EQ(srgb[i], pixels[i]);
+            continue;
+        }
+        ASSERT_NEAR(linear[i], math::Color(pixels[i], 0.0f, 0.0f, 1.0f).rgb().r, 2e-5f);
+        ASSERT_NEAR(srgb[i], math::Color(pixels[i], 0.0f, 0.0f, 1.0f).srgb().r, 2e-5f);
+    }
+
+    std::vector<uint8_t> bytes(1024);
+    for (auto const i : std::views::iota(0u, bytes.size()))
+    {
+        bytes[i] = static_cast<uint8_t>(i);
+    }
+
+    std::vector<float> decoded(bytes.size());
+    math::srgbToLinear(bytes, decoded);
+    auto linearBytes = bytes;
+    math::srgbToLinear(std::span<uint8_t>(linearBytes));
+    auto srgbBytes = bytes;
+    math::linearToSrgb(std::span<uint8_t>(srgbBytes));
+    for (auto const i : std::views::iota(0u, bytes.size()))
+    {
+        float const value = bytes[i] / 255.0f;
+        if (i % 4 == 3)
+        {
+            ASSERT_EQ(decoded[i], value);
+            ASSERT_EQ(linearBytes[i], bytes[i]);
+            ASSERT_EQ(srgbBytes[i], bytes[i]);
+            continue;
+        }
+        float const expected = math::Color(value, 0.0f, 0.0f, 1.0f).rgb().r;
+        ASSERT_NEAR(decoded[i], expected, 1e-6f);
+        ASSERT_EQ(linearBytes[i], std::lround(expected * 255.0f));
+        ASSERT_EQ(srgbBytes[i], std::lround(math::Color(value, 0.0f, 0.0f, 1.0f).srgb().r * 255.0f));
+    }
+}
+
+auto main(int32_t argc, char** argv) -> int32_t
+{
+    testing::InitGoogleTest(&argc, argv);
+    return ::RUN_ALL_TESTS();
+}
@@ -0,0 +1,307 @@
+// Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
+
+#include "core/flat_hash_map.hpp"
+#include "mdl/gltf/gltf.hpp"
+#include "mdl/obj/obj.hpp"
+#include "mdl/optimizer.hpp"
+#include "precompiled.h"
+#include <benchmark/benchmark.h>
+
+using namespace ionengine;
+
+// Grid of size x size quads split into triangles, vertices are shared between the faces. Rows of quads are split
+// evenly between the shapes.
+auto makeGridOBJ(uint32_t const size, uint32_t const shapeCount = 1) -> std::string
+{
+    std::string text;
+    std::array<char, 160> line;
+    for (uint32_t const y : std::views::iota(0u, size + 1))
+    {
+        for (uint32_t const x : std::views::iota(0u, size + 1))
+        {
+            auto const length =
+                std::snprintf(line.data(), line.size(), "v %g %g %g\nvt %g %g\n", x * 0.25f, (x * 7 + y * 3) % 5 * 0.1f,
+                              y * 0.25f, x / float(size), y / float(size));
+            text.append(line.data(), length);
+        }
+    }
+    text.append("vn 0 1 0\n");
+
+    uint32_t const stride = size + 1;
+    for (uint32_t const y : std::views::iota(0u, size))
+    {
+        if (y * shapeCount % size < shapeCount)
+        {
+            auto const length = std::snprintf(line.data(), line.size(), "o part%u\n", y * shapeCount / size);
+            text.append(line.data(), length);
+        }
+
+        for (uint32_t const x : std::views::iota(0u, size))
+        {
+            uint32_t const v0 = y * stride + x + 1, v1 = v0 + 1, v2 = v0 + stride, v3 = v2 + 1;
+            auto const length =
+                std::snprintf(line.data(), line.size(), "f %u/%u/1 %u/%u/1 %u/%u/1\nf %u/%u/1 %u/%u/1 %u/%u/1\n", v0,
+                              v0, v2, v2, v1, v1, v1, v1, v2, v2, v3, v3);
+            text.append(line.data(), length);
+        }
+    }
+    return text;
+}
+
+// 2.9 million triangles in one or several shapes, with full precision or quantized vertices
+static void BM_ImportOBJ(benchmark::State& state)
+{
+    std::string const text = makeGridOBJ(static_cast<uint32_t>(state.range(0)), static_cast<uint32_t>(state.range(1)));
+    auto importer = core::make_ref<asset::OBJImporter>(asset::MDLImportOptions{.isQuantized = state.range(2) != 0});
+    size_t blobSize = 0;
+    for (auto _ : state)
+    {
+        std::string errors;
+        auto modelFile = importer->loadFromBytes(
+            std::span<uint8_t const>(reinterpret_cast<uint8_t const*>(text.data()), text.size()), errors);
+        blobSize = modelFile->blob.size();
+        benchmark::DoNotOptimize(modelFile);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0) * 2);
+    state.counters["blob_bytes"] = static_cast<double>(blobSize);
+}
+
+BENCHMARK(BM_ImportOBJ)->ArgsProduct({{1200}, {1, 16}, {0, 1}})->Unit(benchmark::kMillisecond);
+
+// Same grid as a binary glTF file with 32-bit indices, vertices are either interleaved or one view per attribute
+auto makeGridGLB(uint32_t const size, bool const isInterleaved) -> std::vector<uint8_t>
+{
+    uint32_t const stride = size + 1;
+    uint32_t const vertexCount = stride * stride;
+    uint32_t const indexCount = size * size * 6;
+
+    std::vector<uint8_t> bin(indexCount * sizeof(uint32_t) + vertexCount * 32);
+    uint32_t* indices = reinterpret_cast<uint32_t*>(bin.data());
+    for (uint32_t const y : std::views::iota(0u, size))
+    {
+        for (uint32_t const x : std::views::iota(0u, size))
+        {
+            uint32_t const v0 = y * stride + x, v1 = v0 + 1, v2 = v0 + stride, v3 = v2 + 1;
+            for (uint32_t const index : {v0, v2, v1, v1, v2, v3})
+            {
+                *indices++ = index;
+            }
+        }
+    }
+
+    float* vertices = reinterpret_cast<float*>(indices);
+    for (uint32_t const i : std::views::iota(0u, vertexCount))
+    {
+        std::array<float, 8> const vertex{(i % stride) * 0.25f, 0.0f, (i / stride) * 0.25f, 0.0f, 1.0f, 0.0f,
+                                          (i % stride) / float(size), (i / stride) / float(size)};
+        if (isInterleaved)
+        {
+            std::memcpy(vertices + i * 8, vertex.data(), sizeof(vertex));
+        }
+        else
+        {
+            std::memcpy(vertices + i * 3, vertex.data(), 3 * sizeof(float));
+            std::memcpy(vertices + vertexCount * 3 + i * 3, vertex.data() + 3, 3 * sizeof(float));
+            std::memcpy(vertices + vertexCount * 6 + i * 2, vertex.data() + 6, 2 * sizeof(float));
+        }
+    }
+
+    size_t const indexSize = indexCount * sizeof(uint32_t);
+    std::array<size_t, 3> const attributeOffsets =
+        isInterleaved ? std::array<size_t, 3>{0, 12, 24}
+                      : std::array<size_t, 3>{0, vertexCount * size_t(12), vertexCount * size_t(24)};
+    std::array<char, 1024> text;
+    auto const length = std::snprintf(
+        text.data(), text.size(),
+        R"({"buffers":[{"byteLength":%zu}],"bufferViews":[{"buffer":0,"byteLength":%zu},)"
+        R"({"buffer":0,"byteOffset":%zu,"byteLength":%zu%s}],"accessors":[)"
+        R"({"bufferView":0,"componentType":5125,"count":%u,"type":"SCALAR"},)"
+        R"({"bufferView":1,"byteOffset":%zu,"componentType":5126,"count":%u,"type":"VEC3"},)"
+        R"({"bufferView":1,"byteOffset":%zu,"componentType":5126,"count":%u,"type":"VEC3"},)"
+        R"({"bufferView":1,"byteOffset":%zu,"componentType":5126,"count":%u,"type":"VEC2"}],)"
+        R"("meshes":[{"primitives":[{"attributes":{"POSITION":1,"NORMAL":2,"TEXCOORD_0":3},"indices":0}]}],)"
+        R"("nodes":[{"name":"grid","mesh":0}]})",
+        bin.size(), indexSize, indexSize, bin.size() - indexSize, isInterleaved ? R"(,"byteStride":32)" : "",
+        indexCount, attributeOffsets[0], vertexCount, attributeOffsets[1], vertexCount, attributeOffsets[2],
+        vertexCount);
+    std::string json(text.data(), length);
+    json.resize((json.size() + 3) & ~size_t(3), ' ');
+
+    std::vector<uint8_t> bytes;
+    auto const write = [&](void const* data, size_t const size) {
+        bytes.insert(bytes.end(), static_cast<uint8_t const*>(data), static_cast<uint8_t const*>(data) + size);
+    };
+    auto const writeUint32 = [&](uint32_t const value) { write(&value, sizeof(uint32_t)); };
+
+    write(asset::gltf::Magic.data(), asset::gltf::Magic.size());
+    writeUint32(asset::gltf::Version);
+    writeUint32(static_cast<uint32_t>(12 + 8 + json.size() + 8 + bin.size()));
+    writeUint32(static_cast<uint32_t>(json.size()));
+    writeUint32(asset::gltf::ChunkJSON);
+    write(json.data(), json.size());
+    writeUint32(static_cast<uint32_t>(bin.size()));
+    writeUint32(asset::gltf::ChunkBIN);
+    write(bin.data(), bin.size());
+    return bytes;
+}
+
+// Same 2.9 million triangles, the interleaved file is copied as it is unless the vertices are quantized
+static void BM_ImportGLB(benchmark::State& state)
+{
+    auto const bytes = makeGridGLB(static_cast<uint32_t>(state.range(0)), state.range(1));
+    auto importer = core::make_ref<asset::GLTFImporter>(asset::MDLImportOptions{.isQuantized = state.range(2) != 0});
+    size_t blobSize = 0;
+    for (auto _ : state)
+    {
+        std::string errors;
+        auto modelFile = importer->loadFromBytes(bytes, errors);
+        blobSize = modelFile->blob.size();
+        benchmark::DoNotOptimize(modelFile);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0) * 2);
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+    state.counters["blob_bytes"] = static_cast<double>(blobSize);
+}
+
+BENCHMARK(BM_ImportGLB)->ArgsProduct({{1200}, {0, 1}, {0, 1}})->Unit(benchmark::kMillisecond);
+
+// Optimization of the imported grid, the counters hold the ACMR and ATVR of the first surface before and after
+static void BM_OptimizeModel(benchmark::State& state)
+{
+    std::string const text = makeGridOBJ(static_cast<uint32_t>(state.range(0)), static_cast<uint32_t>(state.range(1)));
+    auto importer = core::make_ref<asset::OBJImporter>();
+    std::string errors;
+    auto const modelFile = importer->loadFromBytes(
+        std::span<uint8_t const>(reinterpret_cast<uint8_t const*>(text.data()), text.size()), errors);
+
+    std::optional<asset::MDLOptimizeReport> report;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        asset::ModelFile optimizedFile{.magic = modelFile->magic,
+                                       .modelData = modelFile->modelData,
+                                       .blob = std::vector<uint8_t>(modelFile->blob.begin(), modelFile->blob.end())};
+        state.ResumeTiming();
+
+        report = asset::optimizeModelFile(optimizedFile, {}, errors);
+        benchmark::DoNotOptimize(optimizedFile);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0) * 2);
+
+    state.counters["acmr_before"] = report->surfaces[0].before.acmr();
+    state.counters["acmr_after"] = report->surfaces[0].after.acmr();
+    state.counters["atvr_before"] = report->surfaces[0].before.atvr();
+    state.counters["atvr_after"] = report->surfaces[0].after.atvr();
+}
+
+BENCHMARK(BM_OptimizeModel)->ArgsProduct({{1200}, {16}})->Unit(benchmark::kMillisecond);
+
+// Meshlets of the optimized grid, the counter holds the average count of triangles per meshlet
+static void BM_BuildMeshlets(benchmark::State& state)
+{
+    std::string const text = makeGridOBJ(static_cast<uint32_t>(state.range(0)), static_cast<uint32_t>(state.range(1)));
+    auto importer = core::make_ref<asset::OBJImporter>();
+    std::string errors;
+    auto modelFile = importer->loadFromBytes(
+        std::span<uint8_t const>(reinterpret_cast<uint8_t const*>(text.data()), text.size()), errors);
+    asset::optimizeModelFile(modelFile.value(), {}, errors);
+
+    size_t meshletCount = 0;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        asset::ModelFile meshletFile{.magic = modelFile->magic,
+                                     .modelData = modelFile->modelData,
+                                     .blob = std::vector<uint8_t>(modelFile->blob.begin(), modelFile->blob.end())};
+        state.ResumeTiming();
+
+        asset::buildModelMeshlets(meshletFile, {}, errors);
+        meshletCount = 0;
+        for (auto const& buffer : std::span(meshletFile.modelData.buffers).subspan(modelFile->modelData.buffers.size()))
+        {
+            meshletCount += buffer.size / sizeof(asset::mdl::MeshletData);
+        }
+        benchmark::DoNotOptimize(meshletFile);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0) * 2);
+    state.counters["triangles_per_meshlet"] = static_cast<double>(state.range(0) * state.range(0) * 2) / meshletCount;
+}
+
+BENCHMARK(BM_BuildMeshlets)->ArgsProduct({{1200}, {16}})->Unit(benchmark::kMillisecond);
+
+struct Vertex
+{
+    math::Vec3f position;
+    math::Vec3f normal;
+    math::Vec2f uv;
+
+    auto operator==(Vertex const& other) const -> bool
+    {
+        return std::make_tuple(position, normal, uv) == std::make_tuple(other.position, other.normal, other.uv);
+    }
+};
+
+struct VertexHasher
+{
+    auto operator()(Vertex const& other) const -> size_t
+    {
+        // Copied out whole since the members are separate subobjects
+        auto const floats = std::bit_cast<std::array<float, 8>>(other);
+        return core::hash_floats(floats);
+    }
+};
+
+// Corner stream of the same grid, as the importer sees it
+auto makeGridCorners(uint32_t const size) -> std::vector<Vertex>
+{
+    std::vector<Vertex> corners;
+    for (uint32_t const y : std::views::iota(0u, size))
+    {
+        for (uint32_t const x : std::views::iota(0u, size))
+        {
+            for (auto const& [dx, dy] : {std::pair{0u, 0u}, {0u, 1u}, {1u, 0u}, {1u, 0u}, {0u, 1u}, {1u, 1u}})
+            {
+                corners.emplace_back(Vertex{.position = math::Vec3f((x + dx) * 0.25f, 0.0f, (y + dy) * 0.25f),
+                                            .normal = math::Vec3f(0.0f, 1.0f, 0.0f),
+                                            .uv = math::Vec2f((x + dx) / float(size), (y + dy) / float(size))});
+            }
+        }
+    }
+    return corners;
+}
+
+template <typename Map>
+static void BM_WeldVertices(benchmark::State& state)
+{
+    auto const corners = makeGridCorners(static_cast<uint32_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        Map uniqueVertices;
+        std::vector<uint32_t> indices;
+        indices.reserve(corners.size());
+        for (auto const& corner : corners)
+        {
+            auto const [vertexIndex, isInserted] =
+                uniqueVertices.try_emplace(corner, static_cast<uint32_t>(uniqueVertices.size()));
+            if constexpr (std::is_same_v<Map, core::flat_hash_map<Vertex, uint32_t, VertexHasher>>)
+            {
+                indices.emplace_back(vertexIndex);
+            }
+            else
+            {
+                indices.emplace_back(vertexIndex->second);
+            }
+        }
+        benchmark::DoNotOptimize(indices.data());
+    }
+    state.SetItemsProcessed(state.iterations() * corners.size());
+}
+
+BENCHMARK(BM_WeldVertices<std::unordered_map<Vertex, uint32_t, VertexHasher>>)
+    ->Arg(1200)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WeldVertices<core::flat_hash_map<Vertex, uint32_t, VertexHasher>>)
+    ->Arg(1200)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -1,6 +1,9 @@
 // Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
 
+#include "mdl/gltf/gltf.hpp"
 #include "mdl/obj/obj.hpp"
+#include "mdl/optimizer.hpp"
+#include "mdl/quantize.hpp"
 #include "precompiled.h"
 #include <gtest/gtest.h>
 
@@ -8,13 +11,685 @@ using namespace ionengine;
 
 TEST(MDL, LoadOBJ_Test)
 {
-    auto objImporter = core::make_ref<mdl::OBJImporter>();
+    auto objImporter = core::make_ref<asset::OBJImporter>();
 
     std::string errors;
     auto modelFile = objImporter->loadFromFile("box.obj", errors);
     std::cout << errors << std::endl;
 }
 
+TEST(MDL, LoadOBJ_Shapes)
+{
+    std::string const text = "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nvn 0 0 1\n"
+                             "o first\nf 1//1 2//1 3//1\n"
+                             "o second\nf 2//1 4//1 3//1\nf 3//1 2//1 4//1\n";
+
+    auto objImporter = core::make_ref<asset::OBJImporter>();
+    std::string errors;
+    auto modelFile = objImporter->loadFromBytes(
+        std::span<uint8_t const>(reinterpret_cast<uint8_t const*>(text.data()), text.size()), errors);
+    ASSERT_TRUE(modelFile.has_value()) << errors;
+
+    auto const& modelData = modelFile->modelData;
+    ASSERT_EQ(modelData.surfaces.size(), 2);
+    ASSERT_EQ(modelData.materialCount, 2);
+    ASSERT_EQ(modelData.objects->size(), 2);
+    ASSERT_EQ(modelData.objects.value()[1].name, "second");
+    ASSERT_EQ(modelData.objects.value()[1].surfaces, (std::vector<uint32_t>{1}));
+    ASSERT_EQ(modelData.surfaces[1].indexCount, 6);
+    ASSERT_EQ(modelData.surfaces[1].indexFormat, asset::mdl::IndexFormat::UINT16);
+
+    // Vertices shared by the shapes are stored once, the one only the second shape uses follows the first shape
+    ASSERT_EQ(modelData.surfaces[1].vertexOffset, 0);
+    ASSERT_EQ(modelData.vertexLayout.size, 32);
+    ASSERT_EQ(modelData.vertexLayout.elements[2].format, asset::mdl::VertexFormat::RG32_FLOAT);
+    ASSERT_EQ(modelData.buffers[modelData.buffer].size, 4 * 32);
+    std::array<uint16_t, 6> indices;
+    ASSERT_EQ(modelData.buffers[1].size, sizeof(indices));
+    std::memcpy(indices.data(), modelFile->blob.data() + modelData.buffers[1].offset, sizeof(indices));
+    ASSERT_EQ(indices, (std::array<uint16_t, 6>{1, 3, 2, 2, 1, 3}));
+
+    std::array<float, 8> vertex;
+    std::memcpy(vertex.data(), modelFile->blob.data() + modelData.buffers[modelData.buffer].offset + 3 * 32,
+                sizeof(vertex));
+    ASSERT_EQ(vertex, (std::array<float, 8>{1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f}));
+
+    // Quantized vertices keep the layout of the surfaces
+    auto quantizedImporter = core::make_ref<asset::OBJImporter>(asset::MDLImportOptions{.isQuantized = true});
+    auto quantizedFile = quantizedImporter->loadFromBytes(
+        std::span<uint8_t const>(reinterpret_cast<uint8_t const*>(text.data()), text.size()), errors);
+    ASSERT_TRUE(quantizedFile.has_value()) << errors;
+
+    auto const& quantizedData = quantizedFile->modelData;
+    ASSERT_EQ(quantizedData.vertexLayout.size, sizeof(asset::mdl::PackedVertex));
+    ASSERT_EQ(quantizedData.vertexLayout.elements[2].format, asset::mdl::VertexFormat::RG16_UNORM);
+    ASSERT_EQ(quantizedData.buffers[quantizedData.buffer].size, 4 * sizeof(asset::mdl::PackedVertex));
+
+    asset::mdl::PackedVertex packedVertex;
+    std::memcpy(&packedVertex,
+                quantizedFile->blob.data() + quantizedData.buffers[quantizedData.buffer].offset +
+                    3 * sizeof(asset::mdl::PackedVertex),
+                sizeof(packedVertex));
+    ASSERT_EQ(packedVertex.position, (std::array<float, 3>{1.0f, 1.0f, 0.0f}));
+    ASSERT_EQ(packedVertex.normal, (std::array<int16_t, 2>{0, 0}));
+}
+
+// Binary glTF file with the given JSON and binary chunks
+auto makeGLB(std::string json, std::vector<uint8_t> bin) -> std::vector<uint8_t>
+{
+    json.resize((json.size() + 3) & ~size_t(3), ' ');
+    bin.resize((bin.size() + 3) & ~size_t(3), 0);
+
+    std::vector<uint8_t> bytes;
+    auto const write = [&](void const* data, size_t const size) {
+        bytes.insert(bytes.end(), static_cast<uint8_t const*>(data), static_cast<uint8_t const*>(data) + size);
+    };
+    auto const writeUint32 = [&](uint32_t const value) { write(&value, sizeof(uint32_t)); };
+
+    write(asset::gltf::Magic.data(), asset::gltf::Magic.size());
+    writeUint32(asset::gltf::Version);
+    writeUint32(static_cast<uint32_t>(12 + 8 + json.size() + 8 + bin.size()));
+    writeUint32(static_cast<uint32_t>(json.size()));
+    writeUint32(asset::gltf::ChunkJSON);
+    write(json.data(), json.size());
+    writeUint32(static_cast<uint32_t>(bin.size()));
+    writeUint32(asset::gltf::ChunkBIN);
+    write(bin.data(), bin.size());
+    return bytes;
+}
+
+template <typename Type>
+auto appendValues(std::vector<uint8_t>& bytes, std::initializer_list<Type> const values) -> void
+{
+    for (Type const value : values)
+    {
+        bytes.insert(bytes.end(), reinterpret_cast<uint8_t const*>(&value),
+                     reinterpret_cast<uint8_t const*>(&value) + sizeof(Type));
+    }
+}
+
+TEST(MDL, LoadGLB_Separate)
+{
+    // Triangle with separate attribute views and 16-bit indices, drawn by two primitives of one mesh
+    std::vector<uint8_t> bin;
+    appendValues<float>(bin, {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f});
+    appendValues<float>(bin, {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f});
+    appendValues<float>(bin, {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f});
+    appendValues<uint16_t>(bin, {0, 1, 2, 0});
+
+    std::string const json = R"({
+        "asset": {"version": "2.0"},
+        "buffers": [{"byteLength": 104}],
+        "bufferViews": [
+            {"buffer": 0, "byteOffset": 0, "byteLength": 36},
+            {"buffer": 0, "byteOffset": 36, "byteLength": 36},
+            {"buffer": 0, "byteOffset": 72, "byteLength": 24},
+            {"buffer": 0, "byteOffset": 96, "byteLength": 6, "target": 34963}
+        ],
+        "accessors": [
+            {"bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3", "min": [0, 0, 0], "max": [1, 1, 0]},
+            {"bufferView": 1, "componentType": 5126, "count": 3, "type": "VEC3"},
+            {"bufferView": 2, "componentType": 5126, "count": 3, "type": "VEC2"},
+            {"bufferView": 3, "componentType": 5123, "count": 3, "type": "SCALAR"},
+            {"bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3"}
+        ],
+        "materials": [{"name": "paint"}],
+        "meshes": [{"name": "triangle", "primitives": [
+            {"attributes": {"POSITION": 0, "NORMAL": 1, "TEXCOORD_0": 2}, "indices": 3, "material": 0},
+            {"attributes": {"POSITION": 4}, "indices": 3}
+        ]}],
+        "nodes": [{"name": "root", "children": [1]}, {"mesh": 0, "translation": [1, 0, 0]}],
+        "scenes": [{"nodes": [0]}],
+        "scene": 0
+    })";
+
+    auto const bytes = makeGLB(json, bin);
+
+    auto gltfImporter = core::make_ref<asset::GLTFImporter>(asset::MDLImportOptions{.isQuantized = true});
+    std::string errors;
+    auto modelFile = gltfImporter->loadFromBytes(bytes, errors);
+    ASSERT_TRUE(modelFile.has_value()) << errors;
+
+    auto const& modelData = modelFile->modelData;
+    ASSERT_EQ(modelData.surfaces.size(), 2);
+    ASSERT_EQ(modelData.buffers.size(), 3);
+    ASSERT_EQ(modelData.buffer, 2);
+    ASSERT_EQ(modelData.materialCount, 2);
+    ASSERT_EQ(modelData.surfaces[0].material, 0);
+    ASSERT_EQ(modelData.surfaces[1].material, 1);
+    ASSERT_EQ(modelData.surfaces[1].indexCount, 3);
+    ASSERT_EQ(modelData.vertexLayout.size, sizeof(asset::mdl::PackedVertex));
+
+    ASSERT_EQ(modelData.objects->size(), 1);
+    ASSERT_EQ(modelData.objects.value()[0].name, "triangle");
+    ASSERT_EQ(modelData.objects.value()[0].surfaces, (std::vector<uint32_t>{0, 1}));
+
+    // The second primitive has its own vertices, which follow the ones of the first primitive
+    ASSERT_EQ(modelData.surfaces[1].vertexOffset, 3);
+    ASSERT_EQ(modelData.surfaces[1].indexFormat, asset::mdl::IndexFormat::UINT16);
+    std::array<uint16_t, 3> indices;
+    std::memcpy(indices.data(), modelFile->blob.data() + modelData.buffers[1].offset, sizeof(indices));
+    ASSERT_EQ(indices, (std::array<uint16_t, 3>{0, 1, 2}));
+
+    auto const& vertexBuffer = modelData.buffers[modelData.buffer];
+    ASSERT_EQ(vertexBuffer.size, 6 * sizeof(asset::mdl::PackedVertex));
+    asset::mdl::PackedVertex vertex;
+    std::memcpy(&vertex, modelFile->blob.data() + vertexBuffer.offset + sizeof(vertex), sizeof(vertex));
+    ASSERT_EQ(vertex.position, (std::array<float, 3>{1.0f, 0.0f, 0.0f}));
+    ASSERT_EQ(vertex.normal, (std::array<int16_t, 2>{0, 0}));
+    ASSERT_EQ(vertex.uv, (std::array<uint16_t, 2>{65535, 0}));
+    std::memcpy(&vertex, modelFile->blob.data() + vertexBuffer.offset + 4 * sizeof(vertex), sizeof(vertex));
+    ASSERT_EQ(vertex.position, (std::array<float, 3>{1.0f, 0.0f, 0.0f}));
+    ASSERT_EQ(vertex.uv, (std::array<uint16_t, 2>{0, 0}));
+
+    // Without quantization the separate attributes are interleaved at full precision
+    auto floatFile = core::make_ref<asset::GLTFImporter>()->loadFromBytes(bytes, errors);
+    ASSERT_TRUE(floatFile.has_value()) << errors;
+    auto const& floatData = floatFile->modelData;
+    ASSERT_EQ(floatData.vertexLayout.size, 32);
+    ASSERT_EQ(floatData.buffers[floatData.buffer].size, 6 * 32);
+    std::array<float, 8> floatVertex;
+    std::memcpy(floatVertex.data(), floatFile->blob.data() + floatData.buffers[floatData.buffer].offset + 32,
+                sizeof(floatVertex));
+    ASSERT_EQ(floatVertex, (std::array<float, 8>{1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f}));
+}
+
+TEST(MDL, LoadGLB_Mapped)
+{
+    // Interleaved full precision vertices and 16-bit indices match the model file, so the blob views the mapped file
+    std::vector<uint8_t> bin;
+    for (uint32_t const i : std::views::iota(0u, 3u))
+    {
+        appendValues<float>(bin, {float(i), 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, float(i) * 0.5f, 0.0f});
+    }
+    appendValues<uint16_t>(bin, {0, 1, 2});
+
+    std::string const json = R"({
+        "asset": {"version": "2.0"},
+        "buffers": [{"byteLength": 102}],
+        "bufferViews": [
+            {"buffer": 0, "byteOffset": 96, "byteLength": 6},
+            {"buffer": 0, "byteOffset": 0, "byteLength": 96, "byteStride": 32}
+        ],
+        "accessors": [
+            {"bufferView": 0, "componentType": 5123, "count": 3, "type": "SCALAR"},
+            {"bufferView": 1, "byteOffset": 0, "componentType": 5126, "count": 3, "type": "VEC3"},
+            {"bufferView": 1, "byteOffset": 12, "componentType": 5126, "count": 3, "type": "VEC3"},
+            {"bufferView": 1, "byteOffset": 24, "componentType": 5126, "count": 3, "type": "VEC2"}
+        ],
+        "meshes": [{"primitives": [{"attributes": {"TEXCOORD_0": 3, "NORMAL": 2, "POSITION": 1}, "indices": 0}]}],
+        "nodes": [{"name": "a", "mesh": 0}, {"name": "b", "mesh": 0}]
+    })";
+
+    auto const bytes = makeGLB(json, bin);
+    auto const filePath = std::filesystem::temp_directory_path() / "ionengine_mdl_test.glb";
+    {
+        std::ofstream stream(filePath, std::ios::binary);
+        stream.write(reinterpret_cast<char const*>(bytes.data()), bytes.size());
+    }
+
+    auto gltfImporter = core::make_ref<asset::GLTFImporter>();
+    std::string errors;
+    auto mappedFile = gltfImporter->loadFromFile(filePath, errors);
+    ASSERT_TRUE(mappedFile.has_value()) << errors;
+    ASSERT_TRUE(mappedFile->blob.is_mapped());
+
+    auto copiedFile = gltfImporter->loadFromBytes(bytes, errors);
+    ASSERT_TRUE(copiedFile.has_value()) << errors;
+    ASSERT_FALSE(copiedFile->blob.is_mapped());
+    ASSERT_EQ(mappedFile->blob, core::blob(std::vector<uint8_t>(bin)));
+
+    // The copy packs the buffers in order, their contents are the same
+    ASSERT_EQ(mappedFile->modelData.buffers.size(), copiedFile->modelData.buffers.size());
+    for (size_t const i : std::views::iota(0u, mappedFile->modelData.buffers.size()))
+    {
+        auto const& mappedBuffer = mappedFile->modelData.buffers[i];
+        auto const& copiedBuffer = copiedFile->modelData.buffers[i];
+        ASSERT_EQ(mappedBuffer.size, copiedBuffer.size);
+        ASSERT_EQ(std::memcmp(mappedFile->blob.data() + mappedBuffer.offset,
+                              copiedFile->blob.data() + copiedBuffer.offset, mappedBuffer.size),
+                  0);
+    }
+
+    ASSERT_EQ(mappedFile->modelData.vertexLayout.size, 32);
+    ASSERT_EQ(mappedFile->modelData.surfaces[0].indexFormat, asset::mdl::IndexFormat::UINT16);
+    ASSERT_EQ(mappedFile->modelData.materialCount, 1);
+    ASSERT_EQ(mappedFile->modelData.objects->size(), 2);
+    ASSERT_EQ(mappedFile->modelData.objects.value()[1].name, "b");
+    ASSERT_EQ(mappedFile->modelData.objects.value()[1].surfaces, (std::vector<uint32_t>{0}));
+
+    mappedFile.reset();
+    std::filesystem::remove(filePath);
+}
+
+TEST(MDL, LoadGLB_Invalid)
+{
+    std::vector<uint8_t> bin;
+    appendValues<float>(bin, {0.0f, 0.0f, 0.0f});
+    appendValues<uint16_t>(bin, {0, 1, 2});
+
+    std::string const json = R"({
+        "buffers": [{"byteLength": 18}],
+        "bufferViews": [{"buffer": 0, "byteLength": 12}, {"buffer": 0, "byteOffset": 12, "byteLength": 6}],
+        "accessors": [
+            {"bufferView": 0, "componentType": 5126, "count": 1, "type": "VEC3"},
+            {"bufferView": 1, "componentType": 5123, "count": 3, "type": "SCALAR"}
+        ],
+        "meshes": [{"primitives": [{"attributes": {"POSITION": 0}, "indices": 1}]}]
+    })";
+
+    auto gltfImporter = core::make_ref<asset::GLTFImporter>();
+    std::string errors;
+    ASSERT_FALSE(gltfImporter->loadFromBytes(makeGLB(json, bin), errors).has_value());
+    ASSERT_FALSE(errors.empty());
+
+    errors.clear();
+    std::vector<uint8_t> const bytes{'g', 'l', 'T', 'F', 1, 0, 0, 0};
+    ASSERT_FALSE(gltfImporter->loadFromBytes(bytes, errors).has_value());
+    ASSERT_FALSE(errors.empty());
+}
+
+// Model as written by the first revision, before surfaces were grouped and could use 16-bit indices
+struct LegacySurfaceData
+{
+    uint32_t buffer;
+    uint32_t material;
+    uint32_t indexCount;
+
+    template <typename Archive>
+    auto operator()(Archive& archive)
+    {
+        archive.property(buffer, "buffer");
+        archive.property(material, "material");
+        archive.property(indexCount, "indexCount");
+    }
+};
+
+struct LegacyModelData
+{
+    uint32_t materialCount;
+    uint32_t buffer;
+    asset::mdl::VertexLayoutData vertexLayout;
+    std::vector<LegacySurfaceData> surfaces;
+    std::vector<asset::mdl::BufferData> buffers;
+
+    template <typename Archive>
+    auto operator()(Archive& archive)
+    {
+        archive.property(materialCount, "materialCount");
+        archive.property(buffer, "buffer");
+        archive.property(vertexLayout, "vertexLayout");
+        archive.property(surfaces, "surfaces");
+        archive.property(buffers, "buffers");
+    }
+};
+
+struct LegacyModelFile
+{
+    std::array<uint8_t, 4> magic;
+    LegacyModelData modelData;
+    core::blob blob;
+
+    template <typename Archive>
+    auto operator()(Archive& archive)
+    {
+        archive.property(magic);
+        archive.revision(core::archive_revision::v10);
+        archive.template with<core::serialize_ojson, core::serialize_ijson>(modelData);
+        archive.property(blob);
+    }
+};
+
+TEST(MDL, LoadMDL_Legacy)
+{
+    std::vector<uint8_t> blob;
+    appendValues<uint32_t>(blob, {0, 1, 2});
+    appendValues<float>(blob, {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f});
+
+    LegacyModelFile const legacyFile{
+        .magic = asset::mdl::MagicV10,
+        .modelData = {.materialCount = 1,
+                      .buffer = 1,
+                      .vertexLayout = {.elements = {{.format = asset::mdl::VertexFormat::RGB32_FLOAT,
+                                                     .semantic = "POSITION"}},
+                                       .size = 12},
+                      .surfaces = {{.buffer = 0, .material = 0, .indexCount = 3}},
+                      .buffers = {{.offset = 0, .size = 12}, {.offset = 12, .size = 36}}},
+        .blob = std::move(blob)};
+    auto const bytes = core::to_bytes<LegacyModelFile, core::serialize_oarchive>(legacyFile);
+    ASSERT_TRUE(bytes.has_value());
+
+    // Fields added since then are absent and read with their defaults
+    auto modelFile = core::from_bytes<asset::ModelFile, core::serialize_iarchive>(bytes.value());
+    ASSERT_TRUE(modelFile.has_value());
+    auto const& modelData = modelFile->modelData;
+    ASSERT_FALSE(modelData.objects.has_value());
+    ASSERT_EQ(modelData.surfaces.size(), 1);
+    ASSERT_FALSE(modelData.surfaces[0].indexFormat.has_value());
+    ASSERT_FALSE(modelData.surfaces[0].vertexOffset.has_value());
+
+    std::string errors;
+    ASSERT_TRUE(asset::buildModelMeshlets(*modelFile, {}, errors)) << errors;
+    ASSERT_EQ(modelData.surfaces[0].meshletBuffer, 2);
+}
+
+TEST(MDL, Quantize_Half)
+{
+    ASSERT_EQ(asset::mdl::floatToHalf(1.0f), 0x3C00);
+    ASSERT_EQ(asset::mdl::floatToHalf(-2.0f), 0xC000);
+    ASSERT_EQ(asset::mdl::floatToHalf(65504.0f), 0x7BFF);
+    ASSERT_EQ(asset::mdl::floatToHalf(65520.0f), 0x7C00);
+    ASSERT_EQ(asset::mdl::floatToHalf(std::numeric_limits<float>::infinity()), 0x7C00);
+    ASSERT_TRUE(std::isnan(asset::mdl::halfToFloat(asset::mdl::floatToHalf(std::numeric_limits<float>::quiet_NaN()))));
+
+    // Ties round to the even mantissa, subnormals keep steps of 2^-24
+    ASSERT_EQ(asset::mdl::floatToHalf(1.0f + 1.0f / 2048.0f), 0x3C00);
+    ASSERT_EQ(asset::mdl::floatToHalf(1.0f + 3.0f / 2048.0f), 0x3C02);
+    ASSERT_EQ(asset::mdl::floatToHalf(1e-7f), 2);
+    ASSERT_EQ(asset::mdl::halfToFloat(2), 2.0f / 16777216.0f);
+
+    for (float const value : {0.0f, 0.333f, -7.25f, 1000.5f, 0.0001f})
+    {
+        float const roundtrip = asset::mdl::halfToFloat(asset::mdl::floatToHalf(value));
+        ASSERT_LE(std::abs(roundtrip - value), std::max(std::abs(value) / 2048.0f, 1.0f / 16777216.0f));
+    }
+}
+
+TEST(MDL, Quantize_Octahedral)
+{
+    std::mt19937 random(11);
+    std::normal_distribution<float> distribution;
+    float maxError = 0.0f;
+    for (uint32_t const i : std::views::iota(0u, 10000u))
+    {
+        math::Vec3f normal(distribution(random), distribution(random), distribution(random));
+        if (i < 6)
+        {
+            normal = math::Vec3f(i == 0 ? 1.0f : i == 1 ? -1.0f : 0.0f, i == 2 ? 1.0f : i == 3 ? -1.0f : 0.0f,
+                                 i == 4 ? 1.0f : i == 5 ? -1.0f : 0.0f);
+        }
+        normal.normalize();
+
+        asset::mdl::PackedVertex const vertex =
+            asset::mdl::packVertex(math::Vec3f(), normal, math::Vec2f(), asset::mdl::VertexFormat::RG16_UNORM);
+        math::Vec3f const decoded = asset::mdl::decodeOctahedral(
+            math::Vec2f(vertex.normal[0] / 32767.0f, vertex.normal[1] / 32767.0f));
+        maxError = std::max(maxError, (decoded - normal).length());
+    }
+    ASSERT_LT(maxError, 1e-4f);
+}
+
+// Grid of size x size quads with the triangles in random order
+auto makeShuffledGrid(uint32_t const size, std::vector<math::Vec3f>& positions) -> std::vector<uint32_t>
+{
+    uint32_t const stride = size + 1;
+    for (uint32_t const i : std::views::iota(0u, stride * stride))
+    {
+        positions.emplace_back(math::Vec3f(float(i % stride), 0.0f, float(i / stride)));
+    }
+
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (uint32_t const y : std::views::iota(0u, size))
+    {
+        for (uint32_t const x : std::views::iota(0u, size))
+        {
+            uint32_t const v0 = y * stride + x, v1 = v0 + 1, v2 = v0 + stride, v3 = v2 + 1;
+            triangles.emplace_back(std::array<uint32_t, 3>{v0, v2, v1});
+            triangles.emplace_back(std::array<uint32_t, 3>{v1, v2, v3});
+        }
+    }
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937(7));
+
+    std::vector<uint32_t> indices;
+    for (auto const& triangle : triangles)
+    {
+        indices.insert(indices.end(), triangle.begin(), triangle.end());
+    }
+    return indices;
+}
+
+// Triangles rotated to start at their smallest index and sorted, to compare meshes regardless of the order
+auto sortedTriangles(std::span<uint32_t const> const indices) -> std::vector<std::array<uint32_t, 3>>
+{
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        std::array<uint32_t, 3> triangle{indices[i], indices[i + 1], indices[i + 2]};
+        while (triangle[0] > triangle[1] || triangle[0] > triangle[2])
+        {
+            triangle = {triangle[1], triangle[2], triangle[0]};
+        }
+        triangles.emplace_back(triangle);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+TEST(MDL, Optimize_VertexCache)
+{
+    std::vector<math::Vec3f> positions;
+    std::vector<uint32_t> const source = makeShuffledGrid(64, positions);
+    uint32_t const vertexCount = static_cast<uint32_t>(positions.size());
+
+    auto const before = asset::analyzeVertexCache(source, vertexCount, 16);
+    ASSERT_EQ(before.triangleCount, 64 * 64 * 2);
+    ASSERT_EQ(before.vertexCount, vertexCount);
+    ASSERT_GT(before.acmr(), 2.5f);
+
+    std::vector<uint32_t> indices = source;
+    asset::optimizeVertexCache(indices, vertexCount, 16);
+    auto const optimized = asset::analyzeVertexCache(indices, vertexCount, 16);
+    ASSERT_LT(optimized.acmr(), 0.8f);
+    ASSERT_LT(optimized.atvr(), 1.6f);
+    ASSERT_EQ(sortedTriangles(indices), sortedTriangles(source));
+
+    asset::optimizeOverdraw(indices, positions, 16, 1.05f);
+    auto const sorted = asset::analyzeVertexCache(indices, vertexCount, 16);
+    ASSERT_LE(sorted.acmr(), optimized.acmr() * 1.1f);
+    ASSERT_EQ(sortedTriangles(indices), sortedTriangles(source));
+}
+
+TEST(MDL, Optimize_ModelFile)
+{
+    std::vector<math::Vec3f> positions;
+    std::vector<uint32_t> const indices = makeShuffledGrid(32, positions);
+
+    // Two surfaces share the 16-bit index buffer. The vertex before the grid belongs to no surface and the vertex
+    // after the grid is never used.
+    uint32_t const indexCount = static_cast<uint32_t>(indices.size());
+    uint32_t const vertexCount = static_cast<uint32_t>(positions.size()) + 2;
+    std::vector<uint8_t> blob(indexCount * sizeof(uint16_t) + vertexCount * 32);
+    for (uint32_t const i : std::views::iota(0u, indexCount))
+    {
+        uint16_t const index = static_cast<uint16_t>(indices[i]);
+        std::memcpy(blob.data() + i * sizeof(uint16_t), &index, sizeof(uint16_t));
+    }
+    uint8_t* vertices = blob.data() + indexCount * sizeof(uint16_t);
+    for (uint32_t const i : std::views::iota(0u, vertexCount))
+    {
+        math::Vec3f const position = i == 0                 ? math::Vec3f(-1.0f, -1.0f, -1.0f)
+                                     : i == vertexCount - 1 ? math::Vec3f(-2.0f, -2.0f, -2.0f)
+                                                            : positions[i - 1];
+        std::array<float, 8> const data{position.x, position.y, position.z, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f};
+        std::memcpy(vertices + i * 32, data.data(), sizeof(data));
+    }
+
+    asset::mdl::SurfaceData const surfaceData{.buffer = 0,
+                                              .material = 0,
+                                              .indexCount = indexCount,
+                                              .indexFormat = asset::mdl::IndexFormat::UINT16,
+                                              .vertexOffset = 1,
+                                              .meshletBuffer = std::nullopt};
+    asset::ModelFile modelFile{
+        .magic = asset::mdl::Magic,
+        .modelData = {.materialCount = 2,
+                      .buffer = 1,
+                      .vertexLayout = {.elements = {{.format = asset::mdl::VertexFormat::RGB32_FLOAT,
+                                                     .semantic = "POSITION"},
+                                                    {.format = asset::mdl::VertexFormat::RGB32_FLOAT,
+                                                     .semantic = "NORMAL"},
+                                                    {.format = asset::mdl::VertexFormat::RG32_FLOAT,
+                                                     .semantic = "TEXCOORD0"}},
+                                       .size = 32},
+                      .objects = std::vector<asset::mdl::ObjectData>{{.name = "grid", .surfaces = {0, 1}}},
+                      .surfaces = {surfaceData, surfaceData},
+                      .buffers = {{.offset = 0, .size = indexCount * sizeof(uint16_t)},
+                                  {.offset = indexCount * sizeof(uint16_t), .size = vertexCount * 32}}},
+        .blob = std::move(blob)};
+    modelFile.modelData.surfaces[1].material = 1;
+
+    std::string errors;
+    auto const report = asset::optimizeModelFile(modelFile, {}, errors);
+    ASSERT_TRUE(report.has_value()) << errors;
+    ASSERT_EQ(report->surfaces.size(), 2);
+    ASSERT_LT(report->surfaces[0].after.acmr(), report->surfaces[0].before.acmr() / 2);
+
+    // The vertices of the surface follow the first use of the triangles, the other ones keep their places
+    auto const& modelData = modelFile.modelData;
+    ASSERT_EQ(modelData.buffers[0].size, indexCount * sizeof(uint16_t));
+    ASSERT_EQ(modelData.buffers[1].size, vertexCount * 32);
+    uint8_t const* optimizedVertices = modelFile.blob.data() + modelData.buffers[1].offset;
+    std::array<float, 3> position;
+    std::memcpy(position.data(), optimizedVertices, sizeof(position));
+    ASSERT_EQ(position, (std::array<float, 3>{-1.0f, -1.0f, -1.0f}));
+    std::memcpy(position.data(), optimizedVertices + (vertexCount - 1) * 32, sizeof(position));
+    ASSERT_EQ(position, (std::array<float, 3>{-2.0f, -2.0f, -2.0f}));
+
+    std::vector<uint32_t> optimized(indexCount);
+    uint32_t nextVertex = 0;
+    for (uint32_t const i : std::views::iota(0u, indexCount))
+    {
+        uint16_t index;
+        std::memcpy(&index, modelFile.blob.data() + modelData.buffers[0].offset + i * sizeof(uint16_t), sizeof(index));
+        ASSERT_LE(index, nextVertex);
+        nextVertex = std::max<uint32_t>(nextVertex, index + 1);
+        optimized[i] = index;
+    }
+
+    // Every triangle still covers the same positions
+    std::vector<std::array<float, 9>> sourceTriangles;
+    std::vector<std::array<float, 9>> optimizedTriangles;
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        std::array<float, 9> triangle;
+        for (uint32_t const j : std::views::iota(0u, 3u))
+        {
+            std::memcpy(triangle.data() + j * 3, positions[indices[i + j]].data(), 3 * sizeof(float));
+        }
+        sourceTriangles.emplace_back(triangle);
+
+        for (uint32_t const j : std::views::iota(0u, 3u))
+        {
+            std::memcpy(triangle.data() + j * 3, optimizedVertices + (1 + optimized[i + j]) * 32, 3 * sizeof(float));
+        }
+        optimizedTriangles.emplace_back(triangle);
+    }
+    for (auto* triangles : {&sourceTriangles, &optimizedTriangles})
+    {
+        for (auto& triangle : *triangles)
+        {
+            while (std::make_tuple(triangle[0], triangle[2]) > std::make_tuple(triangle[3], triangle[5]) ||
+                   std::make_tuple(triangle[0], triangle[2]) > std::make_tuple(triangle[6], triangle[8]))
+            {
+                std::rotate(triangle.begin(), triangle.begin() + 3, triangle.end());
+            }
+        }
+        std::sort(triangles->begin(), triangles->end());
+    }
+    ASSERT_EQ(sourceTriangles, optimizedTriangles);
+}
+
+// Whether the normal cone of the meshlet culls it for a camera at the position
+auto isConeCulled(asset::mdl::MeshletData const& meshlet, math::Vec3f const& camera) -> bool
+{
+    math::Vec3f direction =
+        math::Vec3f(meshlet.coneApex[0], meshlet.coneApex[1], meshlet.coneApex[2]) - camera;
+    direction.normalize();
+    return direction.dot(math::Vec3f(meshlet.coneAxis[0], meshlet.coneAxis[1], meshlet.coneAxis[2])) >
+           meshlet.coneCutoff;
+}
+
+TEST(MDL, Meshlet_Build)
+{
+    std::vector<math::Vec3f> positions;
+    std::vector<uint32_t> indices = makeShuffledGrid(32, positions);
+    asset::optimizeVertexCache(indices, static_cast<uint32_t>(positions.size()), 16);
+
+    auto const meshlets = asset::buildMeshlets(indices, positions, 64, 124);
+    ASSERT_GT(meshlets.size(), 1);
+
+    // Meshlets cover the triangles one after another within the limits
+    uint32_t indexOffset = 0;
+    for (auto const& meshlet : meshlets)
+    {
+        ASSERT_EQ(meshlet.indexOffset, indexOffset);
+        ASSERT_GT(meshlet.triangleCount, 0);
+        ASSERT_LE(meshlet.triangleCount, 124);
+        indexOffset += meshlet.triangleCount * 3;
+
+        std::set<uint32_t> vertices(indices.begin() + meshlet.indexOffset, indices.begin() + indexOffset);
+        ASSERT_LE(vertices.size(), 64);
+
+        math::Vec3f const center(meshlet.center[0], meshlet.center[1], meshlet.center[2]);
+        for (uint32_t const vertex : vertices)
+        {
+            ASSERT_LE((positions[vertex] - center).length(), meshlet.radius * 1.0001f);
+        }
+
+        // The grid faces up, so it is only seen from above
+        ASSERT_NEAR(meshlet.coneAxis[1], 1.0f, 1e-5f);
+        ASSERT_TRUE(isConeCulled(meshlet, center + math::Vec3f(0.0f, -10.0f, 0.0f)));
+        ASSERT_FALSE(isConeCulled(meshlet, center + math::Vec3f(0.0f, 10.0f, 0.0f)));
+    }
+    ASSERT_EQ(indexOffset, indices.size());
+
+    // Triangles facing every way form a cone that culls nothing
+    std::vector<math::Vec3f> const box{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    std::vector<uint32_t> const boxIndices{0, 2, 1, 0, 1, 3, 0, 3, 2, 1, 2, 3};
+    auto const boxMeshlets = asset::buildMeshlets(boxIndices, box, 64, 124);
+    ASSERT_EQ(boxMeshlets.size(), 1);
+    ASSERT_EQ(boxMeshlets[0].coneCutoff, 1.0f);
+    ASSERT_FALSE(isConeCulled(boxMeshlets[0], math::Vec3f(5.0f, 5.0f, 5.0f)));
+}
+
+TEST(MDL, Meshlet_ModelFile)
+{
+    std::string const text = "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nvn 0 0 1\n"
+                             "o first\nf 1//1 2//1 3//1\n"
+                             "o second\nf 2//1 4//1 3//1\nf 3//1 2//1 4//1\n";
+
+    auto objImporter = core::make_ref<asset::OBJImporter>();
+    std::string errors;
+    auto modelFile = objImporter->loadFromBytes(
+        std::span<uint8_t const>(reinterpret_cast<uint8_t const*>(text.data()), text.size()), errors);
+    ASSERT_TRUE(modelFile.has_value()) << errors;
+
+    ASSERT_TRUE(asset::buildModelMeshlets(*modelFile, {.maxVertices = 64, .maxTriangles = 1}, errors)) << errors;
+    auto const& modelData = modelFile->modelData;
+    ASSERT_EQ(modelData.buffers.size(), 5);
+
+    // The second surface is split into a meshlet per triangle
+    ASSERT_EQ(modelData.surfaces[1].meshletBuffer, 4);
+    auto const& meshletBuffer = modelData.buffers[4];
+    ASSERT_EQ(meshletBuffer.size, 2 * sizeof(asset::mdl::MeshletData));
+    std::array<asset::mdl::MeshletData, 2> meshlets;
+    std::memcpy(meshlets.data(), modelFile->blob.data() + meshletBuffer.offset, sizeof(meshlets));
+    ASSERT_EQ(meshlets[1].indexOffset, 3);
+    ASSERT_EQ(meshlets[1].triangleCount, 1);
+    ASSERT_EQ(meshlets[1].center, (std::array<float, 3>{0.5f, 0.5f, 0.0f}));
+
+    // Meshlets are stored with the model and have to be built after the optimization
+    auto const bytes = core::to_bytes<asset::ModelFile, core::serialize_oarchive>(*modelFile);
+    ASSERT_TRUE(bytes.has_value());
+    auto const loadedFile = core::from_bytes<asset::ModelFile, core::serialize_iarchive>(bytes.value());
+    ASSERT_TRUE(loadedFile.has_value());
+    ASSERT_EQ(loadedFile->modelData.surfaces[0].meshletBuffer, 3);
+    ASSERT_EQ(loadedFile->blob, modelFile->blob);
+
+    ASSERT_FALSE(asset::optimizeModelFile(*modelFile, {}, errors).has_value());
+    ASSERT_FALSE(asset::buildModelMeshlets(*modelFile, {}, errors));
+}
+
 auto main(int32_t argc, char** argv) -> int32_t
 {
     testing::InitGoogleTest(&argc, argv);
@@ -33,7 +33,7 @@ class TestAppContext : public platform::AppContext
 
         auto backBuffer = device->requestBackBuffer();
 
-        std::vector<rhi::RenderPassColorInfo> colors{rhi::RenderPassColorInfo{.texture = backBuffer,
+        std::vector<rhi::RenderPassColorInfo> colors{rhi::RenderPassColorInfo{.texture = backBuffer.get(),
                                                                               .loadOp = rhi::RenderPassLoadOp::Clear,
                                                                               .storeOp = rhi::RenderPassStoreOp::Store,
                                                                               .clearColor = {0.5f, 0.6f, 0.7f, 1.0f}}};
@@ -41,10 +41,10 @@ class TestAppContext : public platform::AppContext
         graphicsContext->setViewport(0, 0, width, height);
         graphicsContext->setScissor(0, 0, width, height);
 
-        graphicsContext->barrier(backBuffer, rhi::ResourceState::Common, rhi::ResourceState::RenderTarget);
+        graphicsContext->barrier(backBuffer.get(), rhi::ResourceState::Common, rhi::ResourceState::RenderTarget);
         graphicsContext->beginRenderPass(colors, std::nullopt);
         graphicsContext->endRenderPass();
-        graphicsContext->barrier(backBuffer, rhi::ResourceState::RenderTarget, rhi::ResourceState::Common);
+        graphicsContext->barrier(backBuffer.get(), rhi::ResourceState::RenderTarget, rhi::ResourceState::Common);
 
         auto result = graphicsContext->execute();
 
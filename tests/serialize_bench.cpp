@@ -0,0 +1,330 @@
+// Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
+
+#include "core/serialize.hpp"
+#include "mdl/mdl.hpp"
+#include "precompiled.h"
+#include "shadersys/fx.hpp"
+#include "tests/serialize_data.hpp"
+#include <benchmark/benchmark.h>
+
+using namespace ionengine;
+
+std::atomic<uint64_t> allocationCount = 0;
+
+auto operator new(size_t const size) -> void*
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size > 0 ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+auto operator delete(void* ptr) noexcept -> void
+{
+    std::free(ptr);
+}
+
+auto operator delete(void* ptr, size_t const) noexcept -> void
+{
+    std::free(ptr);
+}
+
+struct NestedData
+{
+    uint32_t depth;
+    std::string name;
+    std::vector<NestedData> children;
+
+    template <typename Archive>
+    auto operator()(Archive& archive)
+    {
+        archive.property(depth, "depth");
+        archive.property(name, "name");
+        archive.property(children, "children");
+    }
+};
+
+auto makeNestedData(uint32_t const depth) -> NestedData
+{
+    NestedData root{.depth = 0, .name = "node_0", .children = {}};
+    NestedData* current = &root;
+    for (uint32_t const i : std::views::iota(1u, depth))
+    {
+        current->children.emplace_back(NestedData{.depth = i, .name = "node_" + std::to_string(i), .children = {}});
+        current = &current->children.back();
+    }
+    return root;
+}
+
+template <typename Type>
+auto makePayload(uint32_t const count) -> Type;
+
+template <>
+auto makePayload<ShaderData>(uint32_t const count) -> ShaderData
+{
+    ShaderData shaderData{.shaderInt = count,
+                          .shaderFloat = 1.5f,
+                          .name = "shader",
+                          .names = {},
+                          .mapNames = {},
+                          .shaderBool = true,
+                          .internalData = {"internal", 1},
+                          .testEnum = TestEnum::Third,
+                          .internalData2 = std::make_unique<InternalData>("internal2", 2),
+                          .positions = {10, 20},
+                          .enumNames = {{TestEnum::First, "first"}, {TestEnum::Second, "second"}},
+                          .valueNames = {},
+                          .optionalInt = count,
+                          .optionalFloat = std::nullopt};
+
+    for (uint32_t const i : std::views::iota(0u, count))
+    {
+        shaderData.names.emplace_back("name_" + std::to_string(i));
+        shaderData.mapNames.emplace("key_" + std::to_string(i), "value_" + std::to_string(i));
+        shaderData.valueNames.emplace(i, "value_" + std::to_string(i));
+    }
+    return shaderData;
+}
+
+template <>
+auto makePayload<asset::mdl::ModelData>(uint32_t const count) -> asset::mdl::ModelData
+{
+    asset::mdl::ModelData modelData{
+        .materialCount = count,
+        .buffer = 0,
+        .vertexLayout = {.elements = {{asset::mdl::VertexFormat::RGB32_FLOAT, "POSITION"},
+                                      {asset::mdl::VertexFormat::RGB32_FLOAT, "NORMAL"},
+                                      {asset::mdl::VertexFormat::RG32_FLOAT, "TEXCOORD"}},
+                         .size = 32},
+        .objects = std::nullopt,
+        .surfaces = {},
+        .buffers = {}};
+
+    uint64_t offset = 0;
+    for (uint32_t const i : std::views::iota(0u, count))
+    {
+        modelData.surfaces.emplace_back(asset::mdl::SurfaceData{.buffer = i + 1,
+                                                                .material = i,
+                                                                .indexCount = 768,
+                                                                .indexFormat = asset::mdl::IndexFormat::UINT32,
+                                                                .vertexOffset = 0,
+                                                                .meshletBuffer = std::nullopt});
+        modelData.buffers.emplace_back(asset::mdl::BufferData{.offset = offset, .size = 768 * sizeof(uint32_t)});
+        offset += 768 * sizeof(uint32_t);
+    }
+    modelData.buffers.emplace_back(asset::mdl::BufferData{.offset = offset, .size = 1024});
+    return modelData;
+}
+
+template <>
+auto makePayload<asset::fx::ShaderData>(uint32_t const count) -> asset::fx::ShaderData
+{
+    asset::fx::ShaderData shaderData{
+        .headerData = {.name = "Surface", .description = "Benchmark surface", .domain = "Surface", .blend = "Opaque"},
+        .permutations = {},
+        .shaders = {},
+        .outputData = {.depthWrite = true, .stencilWrite = false, .cullSide = asset::fx::CullSide::Back},
+        .buffers = {}};
+
+    for (uint32_t const i : std::views::iota(0u, count))
+    {
+        shaderData.permutations.emplace("FEATURE_" + std::to_string(i), 1 << (i % 32));
+
+        asset::fx::ShaderVariantData variantData{
+            .stages = {},
+            .constants = {{"transformBuffer", asset::fx::ElementType::Uint},
+                          {"materialBuffer", asset::fx::ElementType::Uint}},
+            .structures = {{.name = "TransformData",
+                            .elements = {{"modelViewProj", asset::fx::ElementType::Float4x4},
+                                         {"model", asset::fx::ElementType::Float4x4},
+                                         {"color", asset::fx::ElementType::Float4}},
+                            .size = 144}}};
+
+        for (auto const stageType : {asset::fx::StageType::Vertex, asset::fx::StageType::Pixel})
+        {
+            asset::fx::StageData stageData{
+                .buffer = static_cast<uint32_t>(shaderData.buffers.size()),
+                .entryPoint = "main",
+                .vertexLayout = {.elements = {{asset::fx::VertexFormat::RGB32_FLOAT, "POSITION0"},
+                                              {asset::fx::VertexFormat::RG32_FLOAT, "TEXCOORD0"}},
+                                 .size = 20}};
+            variantData.stages.emplace(stageType, std::move(stageData));
+            shaderData.buffers.emplace_back(
+                asset::fx::BufferData{.offset = shaderData.buffers.size() * 2048, .size = 2048});
+        }
+        shaderData.shaders.emplace(i, std::move(variantData));
+    }
+    return shaderData;
+}
+
+template <>
+auto makePayload<asset::ModelFile>(uint32_t const count) -> asset::ModelFile
+{
+    auto modelData = makePayload<asset::mdl::ModelData>(count);
+    std::vector<uint8_t> blob(modelData.buffers.back().offset + modelData.buffers.back().size);
+    std::iota(blob.begin(), blob.end(), 0);
+    return asset::ModelFile{.magic = asset::mdl::Magic, .modelData = std::move(modelData), .blob = std::move(blob)};
+}
+
+template <>
+auto makePayload<asset::ShaderFile>(uint32_t const count) -> asset::ShaderFile
+{
+    auto shaderData = makePayload<asset::fx::ShaderData>(count);
+    std::vector<uint8_t> blob(shaderData.buffers.size() * 2048);
+    std::iota(blob.begin(), blob.end(), 0);
+    return asset::ShaderFile{.magic = asset::fx::Magic,
+                             .apiType = asset::fx::APIType::DXIL,
+                             .shaderData = std::move(shaderData),
+                             .blob = std::move(blob)};
+}
+
+auto setAllocationCounter(benchmark::State& state, uint64_t const allocationsBefore) -> void
+{
+    state.counters["allocs_per_op"] =
+        benchmark::Counter(static_cast<double>(allocationCount.load(std::memory_order_relaxed) - allocationsBefore),
+                           benchmark::Counter::kAvgIterations);
+}
+
+template <typename Type, typename Archive>
+static void BM_Output(benchmark::State& state)
+{
+    Type const object = makePayload<Type>(static_cast<uint32_t>(state.range(0)));
+
+    size_t bytes = 0;
+    uint64_t const allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+    for (auto _ : state)
+    {
+        std::basic_stringstream<uint8_t> stream;
+        bytes = core::serialize<Type, Archive>(object, stream);
+        benchmark::DoNotOptimize(stream);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+    setAllocationCounter(state, allocationsBefore);
+}
+
+template <typename Type, typename Archive, typename OutputArchive>
+static void BM_Input(benchmark::State& state)
+{
+    auto const buffer =
+        core::to_bytes<Type, OutputArchive>(makePayload<Type>(static_cast<uint32_t>(state.range(0)))).value();
+
+    uint64_t const allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+    for (auto _ : state)
+    {
+        auto object = core::from_bytes<Type, Archive>(buffer);
+        benchmark::DoNotOptimize(object);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buffer.size()));
+    setAllocationCounter(state, allocationsBefore);
+}
+
+BENCHMARK(BM_Output<ShaderData, core::serialize_ojson>)
+    ->Name("BM_JSON_Output/ShaderData")
+    ->RangeMultiplier(4)
+    ->Range(8, 2048);
+BENCHMARK(BM_Input<ShaderData, core::serialize_ijson, core::serialize_ojson>)
+    ->Name("BM_JSON_Input/ShaderData")
+    ->RangeMultiplier(4)
+    ->Range(8, 2048);
+BENCHMARK(BM_Output<asset::mdl::ModelData, core::serialize_ojson>)
+    ->Name("BM_JSON_Output/ModelData")
+    ->RangeMultiplier(4)
+    ->Range(8, 2048);
+BENCHMARK(BM_Input<asset::mdl::ModelData, core::serialize_ijson, core::serialize_ojson>)
+    ->Name("BM_JSON_Input/ModelData")
+    ->RangeMultiplier(4)
+    ->Range(8, 2048);
+BENCHMARK(BM_Output<asset::fx::ShaderData, core::serialize_ojson>)
+    ->Name("BM_JSON_Output/FXShaderData")
+    ->RangeMultiplier(4)
+    ->Range(8, 512);
+BENCHMARK(BM_Input<asset::fx::ShaderData, core::serialize_ijson, core::serialize_ojson>)
+    ->Name("BM_JSON_Input/FXShaderData")
+    ->RangeMultiplier(4)
+    ->Range(8, 512);
+BENCHMARK(BM_Output<asset::ModelFile, core::serialize_oarchive>)
+    ->Name("BM_Binary_Output/ModelFile")
+    ->RangeMultiplier(4)
+    ->Range(8, 2048);
+BENCHMARK(BM_Input<asset::ModelFile, core::serialize_iarchive, core::serialize_oarchive>)
+    ->Name("BM_Binary_Input/ModelFile")
+    ->RangeMultiplier(4)
+    ->Range(8, 2048);
+BENCHMARK(BM_Output<asset::ShaderFile, core::serialize_oarchive>)
+    ->Name("BM_Binary_Output/ShaderFile")
+    ->RangeMultiplier(4)
+    ->Range(8, 512);
+BENCHMARK(BM_Input<asset::ShaderFile, core::serialize_iarchive, core::serialize_oarchive>)
+    ->Name("BM_Binary_Input/ShaderFile")
+    ->RangeMultiplier(4)
+    ->Range(8, 512);
+
+// Decode time should grow linearly with depth (and so with document size)
+static void BM_JSON_Input_Nested(benchmark::State& state)
+{
+    auto const buffer =
+        core::to_bytes<NestedData, core::serialize_ojson>(makeNestedData(static_cast<uint32_t>(state.range(0))))
+            .value();
+
+    for (auto _ : state)
+    {
+        auto object = core::from_bytes<NestedData, core::serialize_ijson>(buffer);
+        benchmark::DoNotOptimize(object);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buffer.size()));
+    state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BM_JSON_Input_Nested)->RangeMultiplier(2)->Range(8, 256)->Complexity(benchmark::oN);
+
+// Encode time should grow linearly with depth as nested objects are written into one buffer
+static void BM_JSON_Output_Nested(benchmark::State& state)
+{
+    NestedData const object = makeNestedData(static_cast<uint32_t>(state.range(0)));
+
+    size_t bytes = 0;
+    for (auto _ : state)
+    {
+        std::basic_stringstream<uint8_t> stream;
+        bytes = core::serialize<NestedData, core::serialize_ojson>(object, stream);
+        benchmark::DoNotOptimize(stream);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+    state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BM_JSON_Output_Nested)->RangeMultiplier(2)->Range(8, 256)->Complexity(benchmark::oN);
+
+// Results are also written to serialize_bench.json unless another output file is given, so runs of different
+// releases can be compared with google benchmark's tools/compare.py
+auto main(int32_t argc, char** argv) -> int32_t
+{
+    std::vector<char*> arguments(argv, argv + argc);
+
+    std::string outputArgument = "--benchmark_out=serialize_bench.json";
+    std::string formatArgument = "--benchmark_out_format=json";
+    if (std::ranges::none_of(arguments, [](std::string_view const argument) {
+            return argument.starts_with("--benchmark_out=");
+        }))
+    {
+        arguments.emplace_back(outputArgument.data());
+        arguments.emplace_back(formatArgument.data());
+    }
+
+    int32_t argumentCount = static_cast<int32_t>(arguments.size());
+    benchmark::Initialize(&argumentCount, arguments.data());
+    if (benchmark::ReportUnrecognizedArguments(argumentCount, arguments.data()))
+    {
+        return 1;
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
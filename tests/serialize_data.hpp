@@ -0,0 +1,75 @@
+// Copyright © 2020-2024 Dmitriy Lukovenko. All rights reserved.
+
+#pragma once
+
+#include "core/serialize.hpp"
+
+// Test structures shared by core_test and serialize_bench
+enum class TestEnum
+{
+    First,
+    Second,
+    Third
+};
+
+template <>
+struct ionengine::core::serializable_enum<TestEnum>
+{
+    template <typename Archive>
+    auto operator()(Archive& archive)
+    {
+        archive.field(TestEnum::First, "first");
+        archive.field(TestEnum::Second, "second");
+        archive.field(TestEnum::Third, "third");
+    }
+};
+
+struct InternalData
+{
+    std::string name;
+    uint32_t materialIndex;
+
+    template <typename Archive>
+    auto operator()(Archive& archive)
+    {
+        archive.property(name, "name");
+        archive.property(materialIndex, "materialIndex");
+    }
+};
+
+struct ShaderData
+{
+    uint32_t shaderInt;
+    float shaderFloat;
+    std::string name;
+    std::vector<std::string> names;
+    std::unordered_map<std::string, std::string> mapNames;
+    bool shaderBool;
+    InternalData internalData;
+    TestEnum testEnum;
+    std::unique_ptr<InternalData> internalData2;
+    std::array<int32_t, 2> positions;
+    std::unordered_map<TestEnum, std::string> enumNames;
+    std::unordered_map<uint32_t, std::string> valueNames;
+    std::optional<uint32_t> optionalInt;
+    std::optional<float> optionalFloat;
+
+    template <typename Archive>
+    auto operator()(Archive& archive)
+    {
+        archive.property(shaderInt, "shaderInt");
+        archive.property(shaderFloat, "shaderFloat");
+        archive.property(name, "name");
+        archive.property(names, "names");
+        archive.property(mapNames, "mapNames");
+        archive.property(shaderBool, "shaderBool");
+        archive.property(internalData, "internal");
+        archive.property(testEnum, "testEnum");
+        archive.property(internalData2, "internal2");
+        archive.property(positions, "positions");
+        archive.property(enumNames, "enumNames");
+        archive.property(valueNames, "enumNames");
+        archive.property(optionalInt, "optionalInt");
+        archive.property(optionalFloat, "optionalFloat");
+    }
+};